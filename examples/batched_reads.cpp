@@ -1,3 +1,4 @@
+#include <sio/arena_resource.hpp>
 #include <sio/io_uring/file_handle.hpp>
 #include <sio/read_batched.hpp>
 #include <sio/sequence/reduce.hpp>
@@ -37,33 +38,6 @@ inline constexpr std::size_t hardware_destructive_interference_size = 2 * sizeof
 #endif
 
 
-struct monotonic_buffer_resource : sio::memory_resource {
-  monotonic_buffer_resource(void* buffer, std::size_t size) noexcept
-    : memory_resource()
-    , buffer_{buffer}
-    , size_{size} {
-  }
-
-  void* buffer_;
-  std::size_t size_;
-
-  bool do_is_equal(const sio::memory_resource& other) const noexcept override {
-    return this == &other;
-  }
-
-  void* do_allocate(std::size_t bytes, std::size_t alignment) noexcept override {
-    void* ptr = std::align(alignment, bytes, buffer_, size_);
-    if (ptr && bytes <= size_) {
-      size_ -= bytes;
-      buffer_ = static_cast<char*>(buffer_) + bytes;
-    }
-    return ptr;
-  }
-
-  void do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) noexcept override {
-  }
-};
-
 void throw_errno_if(bool condition, const std::string& msg) {
   if (condition) {
     throw std::system_error{errno, std::system_category(), msg};
@@ -308,7 +282,10 @@ struct thread_state {
     std::mt19937_64& rng)
     : context{iodepth}
     , buffer(2 * iodepth * (1 << 10))
-    , upstream{(void*) buffer.data(), buffer.size()} {
+    , upstream{
+        (void*) buffer.data(),
+        buffer.size() * sizeof(sio::mutable_buffer),
+        sio::null_memory_resource()} {
     read_n_bytes /= files.size();
     read_n_bytes += (block_size - read_n_bytes % block_size);
     for (const file_options& fopts: files) {
@@ -319,7 +296,7 @@ struct thread_state {
   exec::io_uring_context context{};
   std::vector<file_state> files{};
   std::vector<sio::mutable_buffer> buffer{};
-  monotonic_buffer_resource upstream;
+  sio::monotonic_buffer_resource upstream;
   sio::memory_pool pool{&upstream};
 };
 
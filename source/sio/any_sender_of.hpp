@@ -0,0 +1,404 @@
+/*
+ * Copyright (c) 2024 Maikel Nadolski
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "./arena_resource.hpp"
+#include "./assert.hpp"
+#include "./async_allocator.hpp"
+#include "./concepts.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include <exec/env.hpp>
+#include <stdexec/execution.hpp>
+
+namespace sio {
+  namespace any_ {
+    // Adapts a stateless allocator that allocates without suspending to a memory resource.
+    template <class Alloc>
+    class allocator_resource : public memory_resource {
+      using unit_t = std::max_align_t;
+      using alloc_t = typename std::allocator_traits<Alloc>::template rebind_alloc<unit_t>;
+
+      static std::size_t units(std::size_t bytes) noexcept {
+        return (bytes + sizeof(unit_t) - 1) / sizeof(unit_t);
+      }
+
+      void* do_allocate(std::size_t bytes, std::size_t alignment) noexcept override {
+        if (alignment > alignof(unit_t)) {
+          return nullptr;
+        }
+        try {
+          return async::sync_allocate(alloc_t{}, units(bytes));
+        } catch (...) {
+          return nullptr;
+        }
+      }
+
+      void do_deallocate(void* ptr, std::size_t bytes, std::size_t) noexcept override {
+        async::sync_deallocate(alloc_t{}, static_cast<unit_t*>(ptr), units(bytes));
+      }
+
+      bool do_is_equal(const memory_resource& other) const noexcept override {
+        return &other == this;
+      }
+    };
+
+    // Type-erased objects are allocated from the memory resource of a resource_allocator, or
+    // through any other stateless allocator that allocates without suspending. Allocators
+    // that can only allocate asynchronously, such as memory_pool_allocator, are rejected.
+    template <class T>
+    memory_resource* resource_of(const resource_allocator<T>& alloc) noexcept {
+      return alloc.resource_;
+    }
+
+    template <class Alloc>
+    memory_resource* resource_of(const Alloc&) noexcept {
+      using alloc_t =
+        typename std::allocator_traits<Alloc>::template rebind_alloc<std::max_align_t>;
+      static_assert(
+        std::is_empty_v<Alloc> && async::sync_array_allocator<alloc_t>,
+        "type-erased senders need an allocator that allocates without suspending");
+      static allocator_resource<Alloc> resource{};
+      return &resource;
+    }
+
+    // Holds one type-erased object. Objects that fit are placed into the inline buffer and
+    // larger ones are allocated from a memory resource.
+    template <std::size_t InlineSize>
+    class storage {
+     public:
+      storage() = default;
+      storage(const storage&) = delete;
+      storage& operator=(const storage&) = delete;
+
+      ~storage() {
+        reset();
+      }
+
+      template <class T>
+      static constexpr bool fits_inline =
+        sizeof(T) <= InlineSize && alignof(T) <= alignof(std::max_align_t)
+        && (std::is_nothrow_move_constructible_v<T> || !std::is_move_constructible_v<T>);
+
+      template <class T, class Fn>
+      T* emplace_from(memory_resource* resource, Fn&& fn) {
+        SIO_ASSERT(object_ == nullptr);
+        if constexpr (fits_inline<T>) {
+          T* object = ::new (static_cast<void*>(buffer_)) T(static_cast<Fn&&>(fn)());
+          object_ = object;
+          vtable_ = &inline_vtable<T>;
+          return object;
+        } else {
+          void* ptr = resource->allocate(sizeof(heap_box<T>), alignof(heap_box<T>));
+          if (!ptr) {
+            throw std::bad_alloc();
+          }
+          try {
+            auto* box = ::new (ptr) heap_box<T>{resource, static_cast<Fn&&>(fn)()};
+            object_ = &box->value_;
+            box_ = box;
+            vtable_ = &heap_vtable<T>;
+            return &box->value_;
+          } catch (...) {
+            resource->deallocate(ptr, sizeof(heap_box<T>), alignof(heap_box<T>));
+            throw;
+          }
+        }
+      }
+
+      // Takes over the object of other, which is left empty.
+      void move_from(storage& other) noexcept {
+        SIO_ASSERT(object_ == nullptr);
+        if (other.object_) {
+          other.vtable_->move_(*this, other);
+        }
+      }
+
+      void reset() noexcept {
+        if (object_) {
+          vtable_->destroy_(*this);
+          object_ = nullptr;
+          box_ = nullptr;
+        }
+      }
+
+      void* get() const noexcept {
+        return object_;
+      }
+
+     private:
+      template <class T>
+      struct heap_box {
+        memory_resource* resource_;
+        T value_;
+      };
+
+      struct vtable {
+        void (*destroy_)(storage&) noexcept;
+        void (*move_)(storage& to, storage& from) noexcept;
+      };
+
+      template <class T>
+      static constexpr vtable inline_vtable{
+        [](storage& self) noexcept { std::destroy_at(static_cast<T*>(self.object_)); },
+        [](storage& to, storage& from) noexcept {
+          if constexpr (std::is_move_constructible_v<T>) {
+            T* object = static_cast<T*>(from.object_);
+            to.object_ = ::new (static_cast<void*>(to.buffer_)) T(static_cast<T&&>(*object));
+            to.vtable_ = from.vtable_;
+            from.reset();
+          } else {
+            // Only senders are moved and they are move constructible.
+            SIO_ASSERT(false);
+          }
+        }};
+
+      template <class T>
+      static constexpr vtable heap_vtable{
+        [](storage& self) noexcept {
+          auto* box = static_cast<heap_box<T>*>(self.box_);
+          memory_resource* resource = box->resource_;
+          std::destroy_at(box);
+          resource->deallocate(box, sizeof(heap_box<T>), alignof(heap_box<T>));
+        },
+        [](storage& to, storage& from) noexcept {
+          to.object_ = std::exchange(from.object_, nullptr);
+          to.box_ = std::exchange(from.box_, nullptr);
+          to.vtable_ = from.vtable_;
+        }};
+
+      alignas(std::max_align_t) std::byte buffer_[InlineSize];
+      void* object_{};
+      void* box_{};
+      const vtable* vtable_{};
+    };
+
+    template <class Sig>
+    struct completion_entry;
+
+    template <class Tag, class... Args>
+    struct completion_entry<Tag(Args...)> {
+      void (*complete_)(void*, Args&&...) noexcept;
+
+      void operator()(void* op, Tag, Args... args) const noexcept {
+        complete_(op, static_cast<Args&&>(args)...);
+      }
+
+      template <class Op>
+      static constexpr auto make() noexcept -> completion_entry {
+        return {[](void* op, Args&&... args) noexcept {
+          static_cast<Op*>(op)->complete(Tag{}, static_cast<Args&&>(args)...);
+        }};
+      }
+    };
+
+    template <class Sigs>
+    struct completion_vtable;
+
+    template <class... Sigs>
+    struct completion_vtable<stdexec::completion_signatures<Sigs...>> : completion_entry<Sigs>... {
+      using completion_entry<Sigs>::operator()...;
+    };
+
+    template <class Op, class... Sigs>
+    constexpr auto make_completion_vtable(stdexec::completion_signatures<Sigs...>*) noexcept
+      -> completion_vtable<stdexec::completion_signatures<Sigs...>> {
+      return {completion_entry<Sigs>::template make<Op>()...};
+    }
+
+    template <class Sigs, class Op>
+    inline constexpr completion_vtable<Sigs> completion_vtable_for =
+      make_completion_vtable<Op>(static_cast<Sigs*>(nullptr));
+
+    // The receiver that erased senders are connected to. Its environment provides a stop token
+    // and the allocator of the receiver, erased to a resource_allocator.
+    template <class Sigs>
+    struct receiver_ref {
+      using receiver_concept = stdexec::receiver_t;
+      using vtable_t = completion_vtable<Sigs>;
+
+      const vtable_t* vtable_;
+      void* op_;
+      stdexec::inplace_stop_token token_;
+      memory_resource* resource_;
+
+      template <class... Args>
+        requires callable<const vtable_t&, void*, stdexec::set_value_t, Args...>
+      void set_value(Args&&... args) && noexcept {
+        (*vtable_)(op_, stdexec::set_value_t{}, static_cast<Args&&>(args)...);
+      }
+
+      template <class Error>
+        requires callable<const vtable_t&, void*, stdexec::set_error_t, Error>
+      void set_error(Error&& error) && noexcept {
+        (*vtable_)(op_, stdexec::set_error_t{}, static_cast<Error&&>(error));
+      }
+
+      void set_stopped() && noexcept
+        requires callable<const vtable_t&, void*, stdexec::set_stopped_t>
+      {
+        (*vtable_)(op_, stdexec::set_stopped_t{});
+      }
+
+      auto get_env() const noexcept {
+        return exec::make_env(
+          exec::with(stdexec::get_stop_token, token_),
+          exec::with(async::get_allocator, resource_allocator<char>{resource_}));
+      }
+    };
+
+    // Forwards stop requests of the receiver to the erased operation and completes the
+    // receiver.
+    template <class Receiver>
+    struct operation_base {
+      struct on_stop_requested {
+        stdexec::inplace_stop_source& source_;
+
+        void operator()() const noexcept {
+          source_.request_stop();
+        }
+      };
+
+      using stop_token_t = stdexec::stop_token_of_t<stdexec::env_of_t<Receiver>>;
+      using stop_callback_t = typename stop_token_t::template callback_type<on_stop_requested>;
+
+      [[no_unique_address]] Receiver rcvr_;
+      stdexec::inplace_stop_source stop_source_{};
+      std::optional<stop_callback_t> stop_callback_{};
+
+      memory_resource* resource() const noexcept {
+        return resource_of(sio::async::get_allocator(stdexec::get_env(rcvr_)));
+      }
+
+      void forward_stop_requests() noexcept {
+        stop_callback_.emplace(
+          stdexec::get_stop_token(stdexec::get_env(rcvr_)), on_stop_requested{stop_source_});
+      }
+
+      template <class Tag, class... Args>
+      void complete(Tag, Args&&... args) noexcept {
+        stop_callback_.reset();
+        Tag{}(static_cast<Receiver&&>(rcvr_), static_cast<Args&&>(args)...);
+      }
+    };
+
+    template <class Sigs, std::size_t InlineSize>
+    struct sender_vtable {
+      void (*connect_)(void* sndr, storage<InlineSize>& op, receiver_ref<Sigs> rcvr, memory_resource*);
+      void (*start_)(void* op) noexcept;
+    };
+
+    template <class Sender, class Sigs, std::size_t InlineSize>
+    inline constexpr sender_vtable<Sigs, InlineSize> sender_vtable_for{
+      [](void* sndr, storage<InlineSize>& op, receiver_ref<Sigs> rcvr, memory_resource* resource) {
+        using op_t = stdexec::connect_result_t<Sender, receiver_ref<Sigs>>;
+        op.template emplace_from<op_t>(resource, [&] {
+          return stdexec::connect(static_cast<Sender&&>(*static_cast<Sender*>(sndr)), rcvr);
+        });
+      },
+      [](void* op) noexcept {
+        using op_t = stdexec::connect_result_t<Sender, receiver_ref<Sigs>>;
+        stdexec::start(*static_cast<op_t*>(op));
+      }};
+
+    template <class Sigs, std::size_t InlineSize, class Receiver>
+    struct operation : operation_base<Receiver> {
+      storage<InlineSize> op_{};
+      void (*start_)(void*) noexcept;
+
+      operation(void* sndr, const sender_vtable<Sigs, InlineSize>* vtable, Receiver rcvr)
+        : operation_base<Receiver>{static_cast<Receiver&&>(rcvr)}
+        , start_{vtable->start_} {
+        vtable->connect_(
+          sndr,
+          op_,
+          receiver_ref<Sigs>{
+            &completion_vtable_for<Sigs, operation>,
+            this,
+            this->stop_source_.get_token(),
+            this->resource()},
+          this->resource());
+      }
+
+      void start() noexcept {
+        this->forward_stop_requests();
+        start_(op_.get());
+      }
+    };
+  }
+
+  // A move-only sender that erases the type of a sender with the given completion signatures.
+  // Senders and operation states of up to InlineSize bytes are stored inline. Larger operation
+  // states are allocated from the allocator in the environment of the receiver and larger
+  // senders from the allocator that is passed with std::allocator_arg, or from the default
+  // resource.
+  template <class Sigs, std::size_t InlineSize = 8 * sizeof(void*)>
+  class any_sender_of {
+   public:
+    using sender_concept = stdexec::sender_t;
+    using completion_signatures = Sigs;
+
+    template <class Sender>
+      requires(!decays_to<Sender, any_sender_of>)
+           && stdexec::sender_to<decay_t<Sender>, any_::receiver_ref<Sigs>>
+    any_sender_of(Sender&& sndr)
+      : vtable_{&any_::sender_vtable_for<decay_t<Sender>, Sigs, InlineSize>} {
+      sender_.template emplace_from<decay_t<Sender>>(get_default_resource(), [&] {
+        return decay_t<Sender>(static_cast<Sender&&>(sndr));
+      });
+    }
+
+    template <class Alloc, class Sender>
+      requires(!decays_to<Sender, any_sender_of>)
+           && stdexec::sender_to<decay_t<Sender>, any_::receiver_ref<Sigs>>
+    any_sender_of(std::allocator_arg_t, const Alloc& alloc, Sender&& sndr)
+      : vtable_{&any_::sender_vtable_for<decay_t<Sender>, Sigs, InlineSize>} {
+      sender_.template emplace_from<decay_t<Sender>>(any_::resource_of(alloc), [&] {
+        return decay_t<Sender>(static_cast<Sender&&>(sndr));
+      });
+    }
+
+    any_sender_of(any_sender_of&& other) noexcept
+      : vtable_{other.vtable_} {
+      sender_.move_from(other.sender_);
+    }
+
+    any_sender_of& operator=(any_sender_of&& other) noexcept {
+      if (this != &other) {
+        sender_.reset();
+        sender_.move_from(other.sender_);
+        vtable_ = other.vtable_;
+      }
+      return *this;
+    }
+
+    template <stdexec::receiver_of<Sigs> Receiver>
+    auto connect(Receiver rcvr) && -> any_::operation<Sigs, InlineSize, Receiver> {
+      SIO_ASSERT(sender_.get());
+      return {sender_.get(), vtable_, static_cast<Receiver&&>(rcvr)};
+    }
+
+   private:
+    any_::storage<InlineSize> sender_{};
+    const any_::sender_vtable<Sigs, InlineSize>* vtable_;
+  };
+}
@@ -0,0 +1,105 @@
+#include "./arena_resource.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+
+namespace sio {
+  namespace {
+    // Returns the first address in [begin, begin + size) that is suitably aligned for an
+    // allocation of the given number of bytes, or null if it does not fit.
+    char* align(char* begin, std::size_t size, std::size_t bytes, std::size_t alignment) noexcept {
+      void* ptr = begin;
+      return static_cast<char*>(std::align(alignment, bytes, ptr, size));
+    }
+  }
+
+  monotonic_buffer_resource::monotonic_buffer_resource(memory_resource* upstream) noexcept
+    : upstream_{upstream ? upstream : get_default_resource()} {
+  }
+
+  monotonic_buffer_resource::monotonic_buffer_resource(
+    void* buffer,
+    std::size_t size,
+    memory_resource* upstream) noexcept
+    : upstream_{upstream ? upstream : get_default_resource()}
+    , initial_buffer_{buffer}
+    , initial_size_{size}
+    , current_{static_cast<char*>(buffer)}
+    , available_{size}
+    , next_chunk_size_{std::max(size, next_chunk_size_)} {
+  }
+
+  monotonic_buffer_resource::~monotonic_buffer_resource() {
+    release();
+  }
+
+  void monotonic_buffer_resource::reset() noexcept {
+    current_chunk_ = nullptr;
+    current_ = static_cast<char*>(initial_buffer_);
+    available_ = initial_size_;
+  }
+
+  void monotonic_buffer_resource::release() noexcept {
+    while (chunks_) {
+      chunk* next = chunks_->next;
+      upstream_->deallocate(chunks_, chunks_->size, alignof(std::max_align_t));
+      chunks_ = next;
+    }
+    reset();
+  }
+
+  // Moves on to the next chunk that is large enough, reusing chunks that are kept after a reset
+  // before allocating a new one from upstream.
+  bool monotonic_buffer_resource::next_chunk(std::size_t bytes, std::size_t alignment) noexcept {
+    const std::size_t required = sizeof(chunk) + bytes + alignment;
+    chunk* candidate = current_chunk_ ? current_chunk_->next : chunks_;
+    chunk* last = current_chunk_;
+    while (candidate && candidate->size < required) {
+      last = candidate;
+      candidate = candidate->next;
+    }
+    if (!candidate) {
+      while (next_chunk_size_ < required) {
+        next_chunk_size_ *= 2;
+      }
+      void* buffer = upstream_->allocate(next_chunk_size_, alignof(std::max_align_t));
+      if (!buffer) {
+        return false;
+      }
+      candidate = ::new (buffer) chunk{nullptr, next_chunk_size_};
+      next_chunk_size_ *= 2;
+      // The search above stopped at the last chunk, so new chunks are appended and the order of
+      // reuse after a reset stays the same.
+      if (last) {
+        last->next = candidate;
+      } else {
+        chunks_ = candidate;
+      }
+    }
+    current_chunk_ = candidate;
+    current_ = reinterpret_cast<char*>(candidate + 1);
+    available_ = candidate->size - sizeof(chunk);
+    return true;
+  }
+
+  void* monotonic_buffer_resource::do_allocate(std::size_t bytes, std::size_t alignment) noexcept {
+    char* ptr = current_ ? align(current_, available_, bytes, alignment) : nullptr;
+    if (!ptr) {
+      if (!next_chunk(bytes, alignment)) {
+        return nullptr;
+      }
+      ptr = align(current_, available_, bytes, alignment);
+    }
+    available_ -= static_cast<std::size_t>(ptr - current_) + bytes;
+    current_ = ptr + bytes;
+    return ptr;
+  }
+
+  void monotonic_buffer_resource::do_deallocate(void*, std::size_t, std::size_t) noexcept {
+  }
+
+  bool monotonic_buffer_resource::do_is_equal(const memory_resource& other) const noexcept {
+    return this == &other;
+  }
+}
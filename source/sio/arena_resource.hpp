@@ -0,0 +1,243 @@
+/*
+ * Copyright (c) 2024 Maikel Nadolski
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "./async_allocator.hpp"
+#include "./memory_pool.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <new>
+
+#include <exec/env.hpp>
+#include <stdexec/execution.hpp>
+
+namespace sio {
+  // Hands out memory by bumping a pointer and ignores deallocations. Memory is taken from an
+  // optional initial buffer and then from chunks of the upstream resource that grow
+  // geometrically. This resource is not thread-safe.
+  class monotonic_buffer_resource : public memory_resource {
+   public:
+    explicit monotonic_buffer_resource(memory_resource* upstream = get_default_resource()) noexcept;
+
+    monotonic_buffer_resource(
+      void* buffer,
+      std::size_t size,
+      memory_resource* upstream = get_default_resource()) noexcept;
+
+    monotonic_buffer_resource(const monotonic_buffer_resource&) = delete;
+    monotonic_buffer_resource& operator=(const monotonic_buffer_resource&) = delete;
+    ~monotonic_buffer_resource() override;
+
+    // Makes all memory available again but keeps the chunks for the next allocations.
+    // This does not depend on the number of allocations that were made.
+    void reset() noexcept;
+
+    // Like reset, but also returns all chunks to the upstream resource.
+    void release() noexcept;
+
+    memory_resource* upstream_resource() const noexcept {
+      return upstream_;
+    }
+
+   private:
+    struct chunk {
+      chunk* next;
+      std::size_t size;
+    };
+
+    memory_resource* upstream_;
+    void* initial_buffer_{};
+    std::size_t initial_size_{};
+    chunk* chunks_{};
+    // The chunk that is currently used, or null while the initial buffer is used.
+    chunk* current_chunk_{};
+    char* current_{};
+    std::size_t available_{};
+    std::size_t next_chunk_size_{1024};
+
+    bool next_chunk(std::size_t bytes, std::size_t alignment) noexcept;
+
+    void* do_allocate(std::size_t bytes, std::size_t alignment) noexcept override;
+
+    void do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) noexcept override;
+
+    bool do_is_equal(const memory_resource& other) const noexcept override;
+  };
+
+  // An async allocator that takes its memory synchronously from a memory_resource.
+  template <class T>
+  struct resource_allocator {
+    using value_type = T;
+
+    memory_resource* resource_;
+
+    explicit resource_allocator(memory_resource* resource) noexcept
+      : resource_(resource) {
+    }
+
+    template <class S>
+    constexpr explicit resource_allocator(const resource_allocator<S>& other) noexcept
+      : resource_(other.resource_) {
+    }
+
+    template <class... Args>
+    auto async_new(Args&&... args) const {
+      return stdexec::then(
+        stdexec::just(static_cast<Args&&>(args)...),
+        [alloc = *this]<class... As>(As&&... args) {
+          return alloc.sync_new(static_cast<As&&>(args)...);
+        });
+    }
+
+    auto async_new_array(std::size_t size) const {
+      return stdexec::then(stdexec::just(size), [resource = resource_](std::size_t size) {
+        void* ptr = resource->allocate(sizeof(T) * size, alignof(T));
+        if (!ptr) {
+          throw std::bad_alloc();
+        }
+        return new (ptr) T[size];
+      });
+    }
+
+    auto async_delete(T* ptr) const {
+      return stdexec::then(stdexec::just(), [alloc = *this, ptr]() noexcept {
+        alloc.sync_delete(ptr);
+      });
+    }
+
+    template <class... Args>
+    T* sync_new(Args&&... args) const {
+      void* ptr = resource_->allocate(sizeof(T), alignof(T));
+      if (!ptr) {
+        throw std::bad_alloc();
+      }
+      try {
+        return new (ptr) T(static_cast<Args&&>(args)...);
+      } catch (...) {
+        resource_->deallocate(ptr, sizeof(T), alignof(T));
+        throw;
+      }
+    }
+
+    void sync_delete(T* ptr) const noexcept {
+      std::destroy_at(ptr);
+      resource_->deallocate(ptr, sizeof(T), alignof(T));
+    }
+
+    T* sync_allocate(std::size_t size) const {
+      void* ptr = resource_->allocate(sizeof(T) * size, alignof(T));
+      if (!ptr) {
+        throw std::bad_alloc();
+      }
+      return static_cast<T*>(ptr);
+    }
+
+    void sync_deallocate(T* ptr, std::size_t size) const noexcept {
+      resource_->deallocate(ptr, sizeof(T) * size, alignof(T));
+    }
+
+    friend bool operator==(const resource_allocator&, const resource_allocator&) = default;
+  };
+
+  namespace with_arena_ {
+    template <class Receiver>
+    auto make_env(const Receiver& rcvr, monotonic_buffer_resource& arena) noexcept {
+      return exec::make_env(
+        stdexec::get_env(rcvr),
+        exec::with(sio::async::get_allocator, resource_allocator<char>{&arena}));
+    }
+
+    template <class Receiver>
+    struct operation_base {
+      Receiver receiver_;
+      monotonic_buffer_resource arena_;
+    };
+
+    template <class Receiver>
+    struct receiver {
+      using receiver_concept = stdexec::receiver_t;
+
+      operation_base<Receiver>* op_;
+
+      auto get_env() const noexcept -> decltype(with_arena_::make_env(
+        std::declval<const Receiver&>(),
+        std::declval<monotonic_buffer_resource&>())) {
+        return with_arena_::make_env(op_->receiver_, op_->arena_);
+      }
+
+      template <class... Args>
+      void set_value(Args&&... args) && noexcept {
+        stdexec::set_value(static_cast<Receiver&&>(op_->receiver_), static_cast<Args&&>(args)...);
+      }
+
+      template <class Error>
+      void set_error(Error&& error) && noexcept {
+        stdexec::set_error(static_cast<Receiver&&>(op_->receiver_), static_cast<Error&&>(error));
+      }
+
+      void set_stopped() && noexcept {
+        stdexec::set_stopped(static_cast<Receiver&&>(op_->receiver_));
+      }
+    };
+
+    template <class Sender, class Receiver>
+    struct operation : operation_base<Receiver> {
+      stdexec::connect_result_t<Sender, receiver<Receiver>> op_;
+
+      operation(Sender&& sender, Receiver rcvr, memory_resource* upstream)
+        : operation_base<Receiver>{static_cast<Receiver&&>(rcvr), monotonic_buffer_resource{upstream}}
+        , op_{stdexec::connect(static_cast<Sender&&>(sender), receiver<Receiver>{this})} {
+      }
+
+      void start() noexcept {
+        stdexec::start(op_);
+      }
+    };
+
+    template <class Sender>
+    struct sender {
+      using sender_concept = stdexec::sender_t;
+
+      Sender sender_;
+      memory_resource* upstream_;
+
+      template <class Env>
+      auto get_completion_signatures(Env&&) const noexcept
+        -> stdexec::completion_signatures_of_t<Sender, Env>;
+
+      template <class Receiver>
+        requires stdexec::sender_to<Sender, receiver<Receiver>>
+      auto connect(Receiver rcvr) -> operation<Sender, Receiver> {
+        return {static_cast<Sender&&>(sender_), static_cast<Receiver&&>(rcvr), upstream_};
+      }
+    };
+
+    struct with_arena_t {
+      template <class Sender>
+      auto operator()(Sender sender, memory_resource* upstream = get_default_resource()) const
+        -> with_arena_::sender<Sender> {
+        return {static_cast<Sender&&>(sender), upstream};
+      }
+    };
+  }
+
+  // Runs sender with a monotonic_buffer_resource as the allocator of its environment. All
+  // memory that the operation allocates through get_allocator is freed at once when the
+  // operation state is destroyed.
+  using with_arena_::with_arena_t;
+  inline constexpr with_arena_t with_arena{};
+}
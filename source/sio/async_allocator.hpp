@@ -17,6 +17,9 @@
 
 #include "./concepts.hpp"
 
+#include <cstddef>
+#include <memory>
+
 namespace sio::async {
 
   namespace allocate_ {
@@ -115,6 +118,102 @@ namespace sio::async {
   using async_delete_::async_delete_t;
   inline constexpr async_delete_t async_delete{};
 
+  namespace sync_new_ {
+    template <class Alloc, class... Args>
+    concept has_member_cust = requires(Alloc alloc, Args&&... args) {
+      { alloc.sync_new(static_cast<Args&&>(args)...) };
+    };
+
+    template <class Alloc, class... Args>
+    concept nothrow_member_cust = requires(Alloc alloc, Args&&... args) {
+      { alloc.sync_new(static_cast<Args&&>(args)...) } noexcept;
+    };
+
+    struct sync_new_t {
+      template <class Alloc, class... Args>
+        requires has_member_cust<Alloc, Args...>
+      constexpr auto operator()(Alloc alloc, Args&&... args) const
+        noexcept(nothrow_member_cust<Alloc, Args...>) {
+        return alloc.sync_new(static_cast<Args&&>(args)...);
+      }
+    };
+  }
+
+  using sync_new_::sync_new_t;
+  inline constexpr sync_new_t sync_new{};
+
+  namespace sync_delete_ {
+    template <class Alloc, class... Args>
+    concept has_member_cust = requires(Alloc alloc, Args&&... args) {
+      { alloc.sync_delete(static_cast<Args&&>(args)...) };
+    };
+
+    template <class Alloc, class... Args>
+    concept nothrow_member_cust = requires(Alloc alloc, Args&&... args) {
+      { alloc.sync_delete(static_cast<Args&&>(args)...) } noexcept;
+    };
+
+    struct sync_delete_t {
+      template <class Alloc, class... Args>
+        requires has_member_cust<Alloc, Args...>
+      constexpr auto operator()(Alloc alloc, Args&&... args) const
+        noexcept(nothrow_member_cust<Alloc, Args...>) {
+        return alloc.sync_delete(static_cast<Args&&>(args)...);
+      }
+    };
+  }
+
+  using sync_delete_::sync_delete_t;
+  inline constexpr sync_delete_t sync_delete{};
+
+  namespace sync_allocate_ {
+    template <class Alloc, class... Args>
+    concept has_member_cust = requires(Alloc alloc, Args&&... args) {
+      { alloc.sync_allocate(static_cast<Args&&>(args)...) };
+    };
+
+    template <class Alloc, class... Args>
+    concept nothrow_member_cust = requires(Alloc alloc, Args&&... args) {
+      { alloc.sync_allocate(static_cast<Args&&>(args)...) } noexcept;
+    };
+
+    struct sync_allocate_t {
+      template <class Alloc, class... Args>
+        requires has_member_cust<Alloc, Args...>
+      constexpr auto operator()(Alloc alloc, Args&&... args) const
+        noexcept(nothrow_member_cust<Alloc, Args...>) {
+        return alloc.sync_allocate(static_cast<Args&&>(args)...);
+      }
+    };
+  }
+
+  using sync_allocate_::sync_allocate_t;
+  inline constexpr sync_allocate_t sync_allocate{};
+
+  namespace sync_deallocate_ {
+    template <class Alloc, class... Args>
+    concept has_member_cust = requires(Alloc alloc, Args&&... args) {
+      { alloc.sync_deallocate(static_cast<Args&&>(args)...) };
+    };
+
+    template <class Alloc, class... Args>
+    concept nothrow_member_cust = requires(Alloc alloc, Args&&... args) {
+      { alloc.sync_deallocate(static_cast<Args&&>(args)...) } noexcept;
+    };
+
+    struct sync_deallocate_t {
+      template <class Alloc, class... Args>
+        requires has_member_cust<Alloc, Args...>
+      constexpr auto operator()(Alloc alloc, Args&&... args) const
+        noexcept(nothrow_member_cust<Alloc, Args...>) {
+        return alloc.sync_deallocate(static_cast<Args&&>(args)...);
+      }
+    };
+  }
+
+  using sync_deallocate_::sync_deallocate_t;
+  inline constexpr sync_deallocate_t sync_deallocate{};
+
   template <class Alloc, class T, class... Args>
   concept allocator = //
     requires(Alloc alloc, T* ptr, Args&&... args) {
@@ -129,6 +228,59 @@ namespace sio::async {
       { async_delete(alloc, ptr) };
     };
 
+  // An allocator that never suspends. Consumers can construct and destroy objects directly
+  // instead of connecting and starting the senders of async_new and async_delete.
+  template <class Alloc, class T = typename Alloc::value_type, class... Args>
+  concept sync_allocator = //
+    requires(Alloc alloc, T* ptr, Args&&... args) {
+      { sync_new(alloc, static_cast<Args&&>(args)...) } -> std::same_as<T*>;
+      { sync_delete(alloc, ptr) } noexcept;
+    };
+
+  // An allocator that hands out uninitialized storage for n objects without suspending.
+  template <class Alloc, class T = typename Alloc::value_type>
+  concept sync_array_allocator = //
+    requires(Alloc alloc, std::size_t size, T* ptr) {
+      { sync_allocate(alloc, size) } -> std::same_as<T*>;
+      { sync_deallocate(alloc, ptr, size) } noexcept;
+    };
+
+  // Adapts a sync_array_allocator to the allocator requirements of the standard library, so
+  // that containers can take their storage from the allocator of an environment.
+  template <class T, class Alloc>
+  struct std_allocator {
+    using value_type = T;
+    using inner_allocator_type = typename std::allocator_traits<Alloc>::template rebind_alloc<T>;
+
+    static_assert(
+      sync_array_allocator<inner_allocator_type>,
+      "std_allocator needs an allocator that allocates without suspending");
+
+    Alloc alloc_;
+
+    explicit std_allocator(const Alloc& alloc) noexcept
+      : alloc_(alloc) {
+    }
+
+    template <class S>
+    std_allocator(const std_allocator<S, Alloc>& other) noexcept
+      : alloc_(other.alloc_) {
+    }
+
+    T* allocate(std::size_t size) const {
+      return sync_allocate(inner_allocator_type{alloc_}, size);
+    }
+
+    void deallocate(T* ptr, std::size_t size) const noexcept {
+      sync_deallocate(inner_allocator_type{alloc_}, ptr, size);
+    }
+
+    template <class S>
+    friend bool operator==(const std_allocator& lhs, const std_allocator<S, Alloc>& rhs) noexcept {
+      return lhs.alloc_ == rhs.alloc_;
+    }
+  };
+
   template <class T, class Receiver>
   struct delete_operation {
     Receiver rcvr_;
@@ -182,15 +334,8 @@ namespace sio::async {
     auto async_new(Args&&... args) const {
       return stdexec::then(
         stdexec::just(static_cast<Args&&>(args)...), //
-        []<class... As>(As&&... args) {
-          std::allocator<T> alloc{};
-          T* ptr = alloc.allocate(1);
-          try {
-            return new (ptr) T(static_cast<As&&>(args)...);
-          } catch (...) {
-            alloc.deallocate(ptr, 1);
-            throw;
-          }
+        [alloc = *this]<class... As>(As&&... args) {
+          return alloc.sync_new(static_cast<As&&>(args)...);
         });
     }
 
@@ -201,6 +346,33 @@ namespace sio::async {
     auto async_delete(T* ptr) const -> delete_sender<T> {
       return {ptr};
     }
+
+    template <class... Args>
+    T* sync_new(Args&&... args) const {
+      std::allocator<T> alloc{};
+      T* ptr = alloc.allocate(1);
+      try {
+        return new (ptr) T(static_cast<Args&&>(args)...);
+      } catch (...) {
+        alloc.deallocate(ptr, 1);
+        throw;
+      }
+    }
+
+    void sync_delete(T* ptr) const noexcept {
+      std::destroy_at(ptr);
+      std::allocator<T>().deallocate(ptr, 1);
+    }
+
+    T* sync_allocate(std::size_t size) const {
+      return std::allocator<T>().allocate(size);
+    }
+
+    void sync_deallocate(T* ptr, std::size_t size) const noexcept {
+      std::allocator<T>().deallocate(ptr, size);
+    }
+
+    friend bool operator==(const new_delete_allocator&, const new_delete_allocator&) = default;
   };
 
   struct get_allocator_t {
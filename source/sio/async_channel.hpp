@@ -15,6 +15,7 @@
  */
 #pragma once
 
+#include "./async_allocator.hpp"
 #include "./async_mutex.hpp"
 #include "./async_resource.hpp"
 #include "./deferred.hpp"
@@ -22,9 +23,14 @@
 #include "./intrusive_list.hpp"
 #include "./sequence/any_sequence_of.hpp"
 #include "./sequence/ignore_all.hpp"
+#include "./sequence/transform_each.hpp"
 
 #include <exec/async_scope.hpp>
 
+#include <atomic>
+#include <memory>
+#include <optional>
+
 namespace sio {
   namespace channel_ {
     template <class Completions>
@@ -42,6 +48,54 @@ namespace sio {
       exec::async_scope scope_{};
     };
 
+    // Owns the operation state of a sender that was started by spawn. The operation state is
+    // allocated from the allocator that is passed to spawn and destroyed when it completes.
+    template <class Sender, class Alloc>
+    struct spawn_operation {
+      using allocator_type =
+        typename std::allocator_traits<Alloc>::template rebind_alloc<spawn_operation>;
+
+      struct receiver {
+        using receiver_concept = stdexec::receiver_t;
+        spawn_operation* op_;
+
+        void set_value() && noexcept {
+          op_->destroy();
+        }
+
+        void set_stopped() && noexcept {
+          op_->destroy();
+        }
+      };
+
+      allocator_type alloc_;
+      stdexec::connect_result_t<Sender, receiver> op_;
+
+      spawn_operation(Sender&& sndr, const Alloc& alloc)
+        : alloc_(alloc)
+        , op_{stdexec::connect(static_cast<Sender&&>(sndr), receiver{this})} {
+      }
+
+      void destroy() noexcept {
+        allocator_type alloc = alloc_;
+        async::sync_delete(alloc, this);
+      }
+    };
+
+    template <class Sender, class Alloc>
+    void spawn(Sender&& sndr, const Alloc& alloc) {
+      using operation_t = spawn_operation<decay_t<Sender>, Alloc>;
+      using allocator_t = typename operation_t::allocator_type;
+      static_assert(
+        async::sync_allocator<allocator_t>,
+        "async_channel needs an allocator that allocates without suspending");
+      static_assert(
+        stdexec::sender_to<decay_t<Sender>, typename operation_t::receiver>,
+        "async_channel can only spawn senders that do not complete with an error");
+      operation_t* op = async::sync_new(allocator_t(alloc), static_cast<Sender&&>(sndr), alloc);
+      stdexec::start(op->op_);
+    }
+
     template <class Completions>
     struct handle_base {
       context<Completions>* resource;
@@ -49,15 +103,18 @@ namespace sio {
       template <class Item>
       auto notify_all(Item item) const {
         return stdexec::let_value(
-          stdexec::when_all(stdexec::just(std::move(item)), resource->mutex_.lock()),
-          [resource = resource](const Item& item) {
+          stdexec::when_all(
+            stdexec::just(std::move(item)), async::get_allocator(), resource->mutex_.lock()),
+          [resource = resource]<class Alloc>(const Item& item, const Alloc& alloc) {
             for (observer<Completions>& o: resource->observers_) {
-              resource->scope_.spawn(
-                exec::set_next(o.receiver, item) //
-                | stdexec::upon_stopped([resource, &o] {
-                    resource->observers_.erase(&o);
-                    stdexec::set_value(std::move(o.receiver));
-                  }));
+              channel_::spawn(
+                resource->scope_.nest(
+                  exec::set_next(o.receiver, item) //
+                  | stdexec::upon_stopped([resource, &o]() noexcept {
+                      resource->observers_.erase(&o);
+                      stdexec::set_value(std::move(o.receiver));
+                    })),
+                alloc);
             }
             return resource->scope_.on_empty();
           });
@@ -99,35 +156,32 @@ namespace sio {
 
     template <class Completions, class Receiver>
     struct wrap_receiver {
-      using is_receiver = void;
+      using receiver_concept = stdexec::receiver_t;
       subscribe_operation<Completions, Receiver>* op_;
-      stdexec::env_of_t<Receiver> get_env(stdexec::get_env_t) const noexcept;
 
-      template <class Sender>
-      exec::next_sender_of_t<Receiver, Sender> set_next(exec::set_next_t, Sender&& sndr);
-      void set_value(stdexec::set_value_t) && noexcept;
+      template <class Item>
+      friend auto tag_invoke(exec::set_next_t, wrap_receiver& self, Item&& item)
+        -> exec::next_sender_of_t<Receiver, Item> {
+        return exec::set_next(self.op_->rcvr_, static_cast<Item&&>(item));
+      }
+
+      void set_value() && noexcept;
+
+      auto get_env() const noexcept -> stdexec::env_of_t<Receiver>;
     };
 
     template <class Completions, class Receiver>
     struct stop_receiver {
-      using is_receiver = void;
+      using receiver_concept = stdexec::receiver_t;
       subscribe_operation<Completions, Receiver>* op_;
 
-      stdexec::empty_env get_env(stdexec::get_env_t) const noexcept {
-        return {};
-      }
-
-      void set_value(stdexec::set_value_t) && noexcept;
+      void set_value() && noexcept;
     };
 
     struct nop_receiver {
-      using is_receiver = void;
+      using receiver_concept = stdexec::receiver_t;
 
-      stdexec::empty_env get_env(stdexec::get_env_t) const noexcept {
-        return {};
-      }
-
-      void set_value(stdexec::set_value_t) const noexcept {
+      void set_value() && noexcept {
       }
     };
 
@@ -141,36 +195,38 @@ namespace sio {
 
     template <class Completions, class Receiver>
     struct subscribe_operation {
+      using stop_token_t = stdexec::stop_token_of_t<stdexec::env_of_t<Receiver>>;
+      using callback_t =
+        typename stop_token_t::template callback_type<on_stop_requested<Completions, Receiver>>;
+
       Receiver rcvr_;
       wrap_receiver<Completions, Receiver> wrapped_receiver_;
       observer<Completions> observer_;
       handle_base<Completions> channel_;
-      stdexec::connect_result_t<subscribe_sender_t<Completions>, nop_receiver> subscribe_operation_;
+      stdexec::connect_result_t<subscribe_sender_t<Completions>, nop_receiver> subscribe_op_;
       stdexec::connect_result_t<stop_sender_t<Completions>, stop_receiver<Completions, Receiver>>
-        stop_operation_;
-      using stop_token = stdexec::stop_token_of_t<stdexec::env_of_t<Receiver>>;
-      using callback_type =
-        typename stop_token::template callback_type<on_stop_requested<Completions, Receiver>>;
+        stop_op_;
       std::atomic<int> n_ops_{0};
-      std::optional<callback_type> callback_{};
+      std::optional<callback_t> callback_{};
 
       subscribe_operation(Receiver&& rcvr, handle_base<Completions> channel)
-        : rcvr_(std::move(rcvr))
+        : rcvr_(static_cast<Receiver&&>(rcvr))
         , wrapped_receiver_{this}
         , observer_{wrapped_receiver_}
         , channel_{channel}
-        , subscribe_operation_{stdexec::connect(channel_.subscribe(&observer_), nop_receiver{})}
-        , stop_operation_{stdexec::connect(
+        , subscribe_op_{stdexec::connect(channel_.subscribe(&observer_), nop_receiver{})}
+        , stop_op_{stdexec::connect(
             channel_.unsubscribe(&observer_),
             stop_receiver<Completions, Receiver>{this})} {
       }
 
-      void start(stdexec::start_t) noexcept {
+      void start() noexcept {
         callback_.emplace(
-          stdexec::get_stop_token(stdexec::get_env(rcvr_)), on_stop_requested{this});
+          stdexec::get_stop_token(stdexec::get_env(rcvr_)),
+          on_stop_requested<Completions, Receiver>{this});
         int expected = 0;
         if (n_ops_.compare_exchange_strong(expected, 1, std::memory_order_relaxed)) {
-          stdexec::start(subscribe_operation_);
+          stdexec::start(subscribe_op_);
         }
       }
     };
@@ -179,53 +235,54 @@ namespace sio {
     void on_stop_requested<Completions, Receiver>::operator()() const noexcept {
       int before = op_->n_ops_.exchange(2, std::memory_order_relaxed);
       if (before == 1) {
-        stdexec::start(op_->stop_operation_);
+        stdexec::start(op_->stop_op_);
       } else if (before == 0) {
         op_->callback_.reset();
-        stdexec::set_value(std::move(op_->rcvr_));
+        stdexec::set_value(static_cast<Receiver&&>(op_->rcvr_));
       }
     }
 
     template <class Completions, class Receiver>
-    stdexec::env_of_t<Receiver>
-      wrap_receiver<Completions, Receiver>::get_env(stdexec::get_env_t) const noexcept {
+    auto wrap_receiver<Completions, Receiver>::get_env() const noexcept
+      -> stdexec::env_of_t<Receiver> {
       return stdexec::get_env(op_->rcvr_);
     }
 
     template <class Completions, class Receiver>
-    template <class Sender>
-    exec::next_sender_of_t<Receiver, Sender>
-      wrap_receiver<Completions, Receiver>::set_next(exec::set_next_t, Sender&& sndr) {
-      return exec::set_next(op_->rcvr_, std::forward<Sender>(sndr));
-    }
-
-    template <class Completions, class Receiver>
-    void wrap_receiver<Completions, Receiver>::set_value(stdexec::set_value_t) && noexcept {
+    void wrap_receiver<Completions, Receiver>::set_value() && noexcept {
       int before = op_->n_ops_.exchange(3, std::memory_order_relaxed);
       if (before == 1) {
         op_->callback_.reset();
-        stdexec::set_value(std::move(op_->rcvr_));
+        stdexec::set_value(static_cast<Receiver&&>(op_->rcvr_));
       }
     }
 
     template <class Completions, class Receiver>
-    void stop_receiver<Completions, Receiver>::set_value(stdexec::set_value_t) && noexcept {
+    void stop_receiver<Completions, Receiver>::set_value() && noexcept {
       op_->callback_.reset();
-      stdexec::set_value(std::move(op_->rcvr_));
+      stdexec::set_value(static_cast<Receiver&&>(op_->rcvr_));
     }
 
     template <class Completions>
     struct subscribe_sequence {
-      using is_sender = exec::sequence_tag;
+      using sender_concept = exec::sequence_sender_t;
       using completion_signatures = stdexec::completion_signatures<stdexec::set_value_t()>;
+      using item_sender =
+        typename any_sequence_receiver_ref<Completions>::template any_sender<>::item_sender;
+
+      handle_base<Completions> channel_;
 
-      template <class Receiver>
-      auto subscribe(exec::subscribe_t, Receiver rcvr) const noexcept
-        -> subscribe_operation<Completions, Receiver> {
-        return {std::move(rcvr), channel_};
+      template <decays_to<subscribe_sequence> Self, stdexec::receiver Receiver>
+      friend auto tag_invoke(exec::subscribe_t, Self&& self, Receiver rcvr) noexcept(
+        nothrow_decay_copyable<Receiver>) -> subscribe_operation<Completions, Receiver> {
+        return {static_cast<Receiver&&>(rcvr), self.channel_};
       }
 
-      handle_base<Completions> channel_;
+      template <decays_to<subscribe_sequence> Self, class Env>
+      friend auto tag_invoke(exec::get_item_types_t, Self&&, Env&&) noexcept
+        -> exec::item_types<item_sender> {
+        return {};
+      }
     };
 
     template <class Completions>
@@ -256,12 +313,9 @@ namespace sio {
       auto notify_all(Sequence&& seq) const {
         return sio::transform_each(
                  std::forward<Sequence>(seq),
-                 stdexec::__binder_back{
-                   {},
-                   [base = base_]<class Item>(Item&& item) {
-                     return base.notify_all(std::forward<Item>(item));
-                   },
-                   {}})
+                 [base = base_]<class Item>(Item&& item) {
+                   return base.notify_all(std::forward<Item>(item));
+                 })
              | sio::ignore_all();
       }
 
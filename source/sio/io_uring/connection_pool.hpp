@@ -0,0 +1,469 @@
+/*
+ * Copyright (c) 2024 Maikel Nadolski
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "./socket_handle.hpp"
+#include "../intrusive_list.hpp"
+#include "../ip/tcp.hpp"
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <system_error>
+#include <vector>
+
+#include <exec/linux/io_uring_context.hpp>
+
+namespace sio::io_uring {
+  struct connection_pool_options {
+    // Connections beyond this number are closed when they are returned to the pool.
+    std::size_t max_idle_per_endpoint{8};
+    // The number of open connections, idle or in use. Checkouts wait while the limit is reached.
+    std::size_t max_total{64};
+    // Idle connections that were not used for this long are closed on the next checkout.
+    std::chrono::milliseconds idle_timeout{std::chrono::seconds(30)};
+  };
+
+  class connection_pool;
+
+  namespace connection_pool_ {
+    struct waiter_base {
+      // Completes a checkout either with an idle connection or, if fd is -1, with the
+      // permission to open a new one.
+      void (*complete_)(waiter_base*, int fd) noexcept {};
+      bool (*stop_requested_)(waiter_base*) noexcept {};
+      ip::endpoint endpoint_{};
+      waiter_base* next_{};
+      waiter_base* prev_{};
+      bool waiting_{false};
+    };
+
+    using waiter_list = intrusive_list<&waiter_base::next_, &waiter_base::prev_>;
+
+    // A connection that is returned to its pool when it is closed.
+    struct pooled_socket : socket_handle<ip::tcp> {
+      pooled_socket(
+        exec::io_uring_context& context,
+        int fd,
+        connection_pool* pool,
+        ip::endpoint endpoint) noexcept
+        : socket_handle<ip::tcp>{context, fd, endpoint.is_v4() ? ip::tcp::v4() : ip::tcp::v6()}
+        , pool_{pool}
+        , endpoint_{endpoint} {
+      }
+
+      connection_pool* pool_;
+      ip::endpoint endpoint_;
+
+      auto close() const noexcept;
+    };
+
+    template <class Receiver>
+    struct operation;
+
+    template <class Receiver>
+    struct connect_receiver {
+      using receiver_concept = stdexec::receiver_t;
+      operation<Receiver>* op_;
+
+      void set_value() && noexcept {
+        op_->on_connected();
+      }
+
+      void set_error(std::error_code ec) && noexcept {
+        op_->on_connect_failed(ec);
+      }
+
+      void set_stopped() && noexcept {
+        op_->on_connect_failed(std::nullopt);
+      }
+
+      auto get_env() const noexcept -> stdexec::env_of_t<Receiver> {
+        return stdexec::get_env(op_->receiver_);
+      }
+    };
+  }
+
+  // Keeps idle TCP connections per endpoint so that requests to the same peer can reuse them.
+  //
+  // connection(endpoint) returns a resource for async::use_resources. Closing the token
+  // returns the connection to the pool. Connections are checked for liveness before they
+  // are handed out again and are closed if the peer hung up or sent unexpected data.
+  class connection_pool {
+   public:
+    explicit connection_pool(
+      exec::io_uring_context& context,
+      connection_pool_options options = {}) noexcept
+      : context_{&context}
+      , options_{options} {
+    }
+
+    connection_pool(const connection_pool&) = delete;
+    connection_pool& operator=(const connection_pool&) = delete;
+
+    ~connection_pool() {
+      for (auto& [endpoint, connections]: idle_) {
+        for (const idle_connection& conn: connections) {
+          ::close(conn.fd_);
+        }
+      }
+    }
+
+    exec::io_uring_context& context() const noexcept {
+      return *context_;
+    }
+
+    const connection_pool_options& options() const noexcept {
+      return options_;
+    }
+
+    auto connection(ip::endpoint endpoint) noexcept;
+
+    std::size_t idle_count() const {
+      std::scoped_lock lock{mutex_};
+      return n_idle_;
+    }
+
+    std::size_t total_count() const {
+      std::scoped_lock lock{mutex_};
+      return n_total_;
+    }
+
+    // Closes all idle connections that exceeded the idle timeout.
+    void evict_idle() {
+      std::scoped_lock lock{mutex_};
+      const clock::time_point now = clock::now();
+      for (auto iter = idle_.begin(); iter != idle_.end();) {
+        evict_expired(iter->second, now);
+        if (iter->second.empty()) {
+          iter = idle_.erase(iter);
+        } else {
+          ++iter;
+        }
+      }
+    }
+
+   private:
+    template <class Receiver>
+    friend struct connection_pool_::operation;
+    friend struct connection_pool_::pooled_socket;
+
+    using clock = std::chrono::steady_clock;
+    using waiter_base = connection_pool_::waiter_base;
+
+    struct idle_connection {
+      int fd_;
+      clock::time_point since_;
+    };
+
+    // A connection is alive if the peer has neither closed it nor sent data nobody asked for.
+    static bool is_alive(int fd) noexcept {
+      char byte{};
+      ::ssize_t n = ::recv(fd, &byte, 1, MSG_PEEK | MSG_DONTWAIT);
+      return n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK);
+    }
+
+    void drop(int fd) noexcept {
+      ::close(fd);
+      n_total_ -= 1;
+    }
+
+    // Connections are ordered from the oldest to the most recently returned one.
+    void evict_expired(std::vector<idle_connection>& connections, clock::time_point now) noexcept {
+      auto iter = connections.begin();
+      while (iter != connections.end() && now - iter->since_ >= options_.idle_timeout) {
+        drop(iter->fd_);
+        n_idle_ -= 1;
+        ++iter;
+      }
+      connections.erase(connections.begin(), iter);
+    }
+
+    int take_idle(const ip::endpoint& endpoint) noexcept {
+      auto iter = idle_.find(endpoint);
+      if (iter == idle_.end()) {
+        return -1;
+      }
+      std::vector<idle_connection>& connections = iter->second;
+      evict_expired(connections, clock::now());
+      while (!connections.empty()) {
+        int fd = connections.back().fd_;
+        connections.pop_back();
+        n_idle_ -= 1;
+        if (is_alive(fd)) {
+          return fd;
+        }
+        drop(fd);
+      }
+      return -1;
+    }
+
+    // Makes room for a connection to another endpoint by closing the oldest idle connection.
+    bool evict_one() noexcept {
+      auto oldest = idle_.end();
+      for (auto iter = idle_.begin(); iter != idle_.end(); ++iter) {
+        if (
+          !iter->second.empty()
+          && (oldest == idle_.end() || iter->second.front().since_ < oldest->second.front().since_)) {
+          oldest = iter;
+        }
+      }
+      if (oldest == idle_.end()) {
+        return false;
+      }
+      drop(oldest->second.front().fd_);
+      oldest->second.erase(oldest->second.begin());
+      n_idle_ -= 1;
+      return true;
+    }
+
+    // Returns false without completing the waiter if a stop was requested. The check is made
+    // under the lock, so a stop request that comes later finds the waiter in the queue.
+    bool checkout(waiter_base* waiter) noexcept {
+      std::unique_lock lock{mutex_};
+      if (waiter->stop_requested_(waiter)) {
+        return false;
+      }
+      int fd = take_idle(waiter->endpoint_);
+      if (fd == -1 && n_total_ >= options_.max_total) {
+        evict_one();
+      }
+      if (fd == -1 && n_total_ < options_.max_total) {
+        n_total_ += 1;
+      } else if (fd == -1) {
+        waiter->waiting_ = true;
+        waiters_.push_back(waiter);
+        return true;
+      }
+      lock.unlock();
+      waiter->complete_(waiter, fd);
+      return true;
+    }
+
+    bool cancel(waiter_base* waiter) noexcept {
+      std::scoped_lock lock{mutex_};
+      if (!waiter->waiting_) {
+        return false;
+      }
+      waiters_.erase(waiter);
+      waiter->waiting_ = false;
+      return true;
+    }
+
+    // Hands a returned connection to a waiter for the same endpoint, or its slot to the first
+    // waiter, or keeps it as an idle connection.
+    void release(const ip::endpoint& endpoint, int fd) noexcept {
+      std::unique_lock lock{mutex_};
+      if (!is_alive(fd)) {
+        drop(fd);
+        release_slot(lock);
+        return;
+      }
+      if (!waiters_.empty()) {
+        waiter_base* waiter = waiters_.front();
+        for (waiter_base& w: waiters_) {
+          if (w.endpoint_ == endpoint) {
+            waiter = &w;
+            break;
+          }
+        }
+        waiters_.erase(waiter);
+        waiter->waiting_ = false;
+        if (waiter->endpoint_ != endpoint) {
+          ::close(fd);
+          fd = -1;
+        }
+        lock.unlock();
+        waiter->complete_(waiter, fd);
+        return;
+      }
+      try {
+        std::vector<idle_connection>& connections = idle_[endpoint];
+        if (connections.size() < options_.max_idle_per_endpoint) {
+          connections.push_back(idle_connection{fd, clock::now()});
+          n_idle_ += 1;
+          return;
+        }
+      } catch (...) {
+      }
+      drop(fd);
+    }
+
+    // Called for connections that were closed or could not be established.
+    void release_slot(std::unique_lock<std::mutex>& lock) noexcept {
+      if (waiters_.empty()) {
+        return;
+      }
+      waiter_base* waiter = waiters_.pop_front();
+      waiter->waiting_ = false;
+      n_total_ += 1;
+      lock.unlock();
+      waiter->complete_(waiter, -1);
+    }
+
+    void release_slot() noexcept {
+      std::unique_lock lock{mutex_};
+      n_total_ -= 1;
+      release_slot(lock);
+    }
+
+    exec::io_uring_context* context_;
+    connection_pool_options options_;
+    mutable std::mutex mutex_{};
+    std::map<ip::endpoint, std::vector<idle_connection>> idle_{};
+    std::size_t n_idle_{};
+    std::size_t n_total_{};
+    connection_pool_::waiter_list waiters_{};
+  };
+
+  namespace connection_pool_ {
+    inline auto pooled_socket::close() const noexcept {
+      return stdexec::then(
+        stdexec::just(), [pool = pool_, fd = fd_, endpoint = endpoint_]() noexcept {
+          pool->release(endpoint, fd);
+        });
+    }
+
+    template <class Receiver>
+    struct operation : waiter_base {
+      struct on_receiver_stop {
+        operation* op_;
+
+        void operator()() const noexcept {
+          op_->request_stop();
+        }
+      };
+
+      using stop_token_t = stdexec::stop_token_of_t<stdexec::env_of_t<Receiver>>;
+      using stop_callback_t = typename stop_token_t::template callback_type<on_receiver_stop>;
+      using connect_op_t =
+        stdexec::connect_result_t<connect_::sender<ip::tcp>, connect_receiver<Receiver>>;
+
+      connection_pool* pool_;
+      [[no_unique_address]] Receiver receiver_;
+      int fd_{-1};
+      std::optional<stop_callback_t> stop_callback_{};
+      std::optional<connect_op_t> connect_op_{};
+
+      explicit operation(connection_pool* pool, ip::endpoint endpoint, Receiver&& receiver)
+        : waiter_base{&operation::complete, &operation::stop_requested}
+        , pool_{pool}
+        , receiver_{static_cast<Receiver&&>(receiver)} {
+        this->endpoint_ = endpoint;
+      }
+
+      static bool stop_requested(waiter_base* self) noexcept {
+        operation& op = *static_cast<operation*>(self);
+        return stdexec::get_stop_token(stdexec::get_env(op.receiver_)).stop_requested();
+      }
+
+      static void complete(waiter_base* self, int fd) noexcept {
+        operation& op = *static_cast<operation*>(self);
+        op.stop_callback_.reset();
+        if (fd != -1) {
+          op.fd_ = fd;
+          op.on_connected();
+        } else {
+          op.connect();
+        }
+      }
+
+      void connect() noexcept {
+        const int family = this->endpoint_.is_v4() ? AF_INET : AF_INET6;
+        fd_ = ::socket(family, SOCK_STREAM | SOCK_CLOEXEC, IPPROTO_TCP);
+        if (fd_ == -1) {
+          std::error_code ec(errno, std::system_category());
+          pool_->release_slot();
+          stdexec::set_error(static_cast<Receiver&&>(receiver_), ec);
+          return;
+        }
+        auto& op = connect_op_.emplace(stdexec::__emplace_from{[&] {
+          return stdexec::connect(
+            connect_::sender<ip::tcp>{&pool_->context(), this->endpoint_, fd_},
+            connect_receiver<Receiver>{this});
+        }});
+        stdexec::start(op);
+      }
+
+      void on_connected() noexcept {
+        stdexec::set_value(
+          static_cast<Receiver&&>(receiver_),
+          pooled_socket{pool_->context(), fd_, pool_, this->endpoint_});
+      }
+
+      void on_connect_failed(std::optional<std::error_code> ec) noexcept {
+        ::close(fd_);
+        pool_->release_slot();
+        if (ec) {
+          stdexec::set_error(static_cast<Receiver&&>(receiver_), *ec);
+        } else {
+          stdexec::set_stopped(static_cast<Receiver&&>(receiver_));
+        }
+      }
+
+      void request_stop() noexcept {
+        if (pool_->cancel(this)) {
+          stdexec::set_stopped(static_cast<Receiver&&>(receiver_));
+        }
+      }
+
+      void start() noexcept {
+        stop_callback_.emplace(
+          stdexec::get_stop_token(stdexec::get_env(receiver_)), on_receiver_stop{this});
+        if (!pool_->checkout(this)) {
+          stop_callback_.reset();
+          stdexec::set_stopped(static_cast<Receiver&&>(receiver_));
+        }
+      }
+    };
+
+    struct sender {
+      using sender_concept = stdexec::sender_t;
+
+      using completion_signatures = stdexec::completion_signatures<
+        stdexec::set_value_t(pooled_socket),
+        stdexec::set_error_t(std::error_code),
+        stdexec::set_stopped_t()>;
+
+      connection_pool* pool_;
+      ip::endpoint endpoint_;
+
+      template <stdexec::receiver_of<completion_signatures> Receiver>
+      auto connect(Receiver rcvr) const noexcept(nothrow_move_constructible<Receiver>)
+        -> operation<Receiver> {
+        return operation<Receiver>{pool_, endpoint_, static_cast<Receiver&&>(rcvr)};
+      }
+    };
+
+    struct resource {
+      connection_pool* pool_;
+      ip::endpoint endpoint_;
+
+      sender open() const noexcept {
+        return {pool_, endpoint_};
+      }
+    };
+  }
+
+  inline auto connection_pool::connection(ip::endpoint endpoint) noexcept {
+    return connection_pool_::resource{this, endpoint};
+  }
+}
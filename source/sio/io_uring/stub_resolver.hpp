@@ -0,0 +1,376 @@
+/*
+ * Copyright (c) 2024 Maikel Nadolski
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "./socket_handle.hpp"
+#include "../async_resource.hpp"
+#include "../const_buffer.hpp"
+#include "../mutable_buffer.hpp"
+#include "../ip/dns.hpp"
+#include "../ip/resolve.hpp"
+#include "../ip/udp.hpp"
+
+#include <array>
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <exec/linux/io_uring_context.hpp>
+#include <exec/sequence_senders.hpp>
+#include <exec/timed_scheduler.hpp>
+#include <exec/when_any.hpp>
+
+namespace sio::io_uring {
+  class stub_resolver;
+
+  namespace stub_resolver_ {
+    // Sends a single query to a name server and waits for the response or the timeout.
+    // The exchange always starts with a hop onto the ring and hence never completes inline.
+    inline auto make_exchange(
+      exec::io_uring_context& context,
+      ip::endpoint server,
+      const_buffer request,
+      mutable_buffer response,
+      std::chrono::milliseconds timeout) {
+      socket<ip::udp> resource{context, server.is_v4() ? ip::udp::v4() : ip::udp::v6()};
+      auto exchange = [&context, server, request, response, timeout](
+                        socket_handle<ip::udp> handle) {
+        return stdexec::let_value(
+          handle.connect(server), [&context, handle, request, response, timeout] {
+            return stdexec::let_value(
+              handle.write_some(request), [&context, handle, response, timeout](std::size_t) {
+                return exec::when_any(
+                  handle.read_some(response),
+                  stdexec::let_value(exec::schedule_after(context.get_scheduler(), timeout), [] {
+                    return stdexec::just_error(std::make_error_code(std::errc::timed_out));
+                  }));
+              });
+          });
+      };
+      return stdexec::let_value(
+        stdexec::schedule(context.get_scheduler()), [resource, exchange]() mutable {
+          return async::use_resources(exchange, resource);
+        });
+    }
+
+    using exchange_sender = decltype(make_exchange(
+      std::declval<exec::io_uring_context&>(),
+      std::declval<ip::endpoint>(),
+      std::declval<const_buffer>(),
+      std::declval<mutable_buffer>(),
+      std::declval<std::chrono::milliseconds>()));
+
+    template <class Receiver>
+    struct operation;
+
+    template <class Receiver>
+    struct exchange_receiver {
+      using receiver_concept = stdexec::receiver_t;
+
+      operation<Receiver>* op_;
+
+      void set_value(std::size_t size) && noexcept {
+        op_->on_response(size);
+      }
+
+      template <class Error>
+      void set_error(Error&& error) && noexcept {
+        if constexpr (std::same_as<std::decay_t<Error>, std::error_code>) {
+          op_->on_failure(error);
+        } else if constexpr (std::same_as<std::decay_t<Error>, std::exception_ptr>) {
+          op_->fail(static_cast<Error&&>(error));
+        } else {
+          op_->fail(std::make_exception_ptr(static_cast<Error&&>(error)));
+        }
+      }
+
+      void set_stopped() && noexcept {
+        stdexec::set_stopped(static_cast<Receiver&&>(op_->receiver_));
+      }
+
+      auto get_env() const noexcept -> stdexec::env_of_t<Receiver> {
+        return stdexec::get_env(op_->receiver_);
+      }
+    };
+
+    template <class Receiver>
+    struct operation : async::resolve_::results_operation_base<Receiver> {
+      using exchange_op_t = stdexec::connect_result_t<exchange_sender, exchange_receiver<Receiver>>;
+
+      const stub_resolver* resolver_;
+      ip::resolver_query query_;
+      ip::port_type port_{};
+      std::vector<std::string> names_{};
+      std::size_t name_index_{};
+      std::array<ip::dns::record_type, 2> types_{};
+      std::size_t n_types_{};
+      std::size_t type_index_{};
+      std::size_t server_index_{};
+      int attempt_{};
+      std::vector<ip::address> addresses_{};
+      std::error_code last_error_{};
+      std::uint16_t id_{};
+      std::size_t request_size_{};
+      std::array<std::byte, ip::dns::max_udp_message_size> request_{};
+      std::array<std::byte, ip::dns::max_udp_message_size> response_{};
+      // A new exchange is started from the completion of the previous one.
+      // Alternating between two slots keeps the completing operation alive until it returns.
+      std::array<std::optional<exchange_op_t>, 2> exchange_ops_{};
+      std::size_t current_{};
+
+      explicit operation(const stub_resolver* resolver, ip::resolver_query query, Receiver&& rcvr)
+        : async::resolve_::results_operation_base<Receiver>{static_cast<Receiver&&>(rcvr)}
+        , resolver_{resolver}
+        , query_{static_cast<ip::resolver_query&&>(query)} {
+      }
+
+      template <class Error>
+      void fail(Error&& error) noexcept {
+        stdexec::set_error(static_cast<Receiver&&>(this->receiver_), static_cast<Error&&>(error));
+      }
+
+      void finish() noexcept try {
+        auto results = std::make_shared<async::resolve_::results_type>();
+        results->reserve(addresses_.size());
+        for (const ip::address& addr: addresses_) {
+          results->emplace_back(
+            ip::endpoint{addr, port_}, query_.host_name(), query_.service_name());
+        }
+        this->emit(static_cast<std::shared_ptr<async::resolve_::results_type>&&>(results));
+      } catch (...) {
+        fail(std::current_exception());
+      }
+
+      void start_exchange() noexcept;
+
+      void on_response(std::size_t size) noexcept;
+
+      void on_failure(std::error_code ec) noexcept;
+
+      void next_type() noexcept;
+
+      void next_name(std::error_code ec) noexcept;
+
+      void start() noexcept;
+    };
+
+    struct sender {
+      using sender_concept = exec::sequence_sender_t;
+
+      using completion_signatures = stdexec::completion_signatures<
+        stdexec::set_value_t(),
+        stdexec::set_error_t(std::error_code),
+        stdexec::set_error_t(std::exception_ptr),
+        stdexec::set_stopped_t()>;
+
+      using item_types =
+        exec::item_types<decltype(stdexec::just(std::declval<ip::resolver_result>()))>;
+
+      const stub_resolver* resolver_;
+      ip::resolver_query query_;
+
+      template <decays_to<sender> Self, class Receiver>
+      friend operation<Receiver> tag_invoke(exec::subscribe_t, Self&& self, Receiver receiver) {
+        return operation<Receiver>{
+          self.resolver_, static_cast<Self&&>(self).query_, static_cast<Receiver&&>(receiver)};
+      }
+    };
+  }
+
+  // A resolver that answers queries from the hosts file or by sending DNS queries over UDP
+  // to the configured name servers. All I/O is submitted to the io_uring context and no
+  // threads are spawned.
+  //
+  // Only A and AAAA records are supported and truncated answers are not retried over TCP.
+  class stub_resolver {
+   public:
+    explicit stub_resolver(exec::io_uring_context& context)
+      : stub_resolver{context, ip::dns::resolv_conf::load(), ip::dns::hosts_file::load()} {
+    }
+
+    explicit stub_resolver(
+      exec::io_uring_context& context,
+      ip::dns::resolv_conf config,
+      ip::dns::hosts_file hosts = {}) noexcept
+      : context_{&context}
+      , config_{static_cast<ip::dns::resolv_conf&&>(config)}
+      , hosts_{static_cast<ip::dns::hosts_file&&>(hosts)} {
+    }
+
+    exec::io_uring_context& context() const noexcept {
+      return *context_;
+    }
+
+    const ip::dns::resolv_conf& config() const noexcept {
+      return config_;
+    }
+
+    const ip::dns::hosts_file& hosts() const noexcept {
+      return hosts_;
+    }
+
+    friend auto tag_invoke(
+      async::resolve_t,
+      const stub_resolver& self,
+      const ip::resolver_query& query) -> stub_resolver_::sender {
+      return stub_resolver_::sender{&self, query};
+    }
+
+   private:
+    exec::io_uring_context* context_;
+    ip::dns::resolv_conf config_;
+    ip::dns::hosts_file hosts_;
+  };
+
+  namespace stub_resolver_ {
+    inline std::uint16_t next_query_id() {
+      thread_local std::minstd_rand engine{std::random_device{}()};
+      return static_cast<std::uint16_t>(engine());
+    }
+
+    template <class Receiver>
+    void operation<Receiver>::start_exchange() noexcept try {
+      const ip::dns::resolv_conf& config = resolver_->config();
+      id_ = next_query_id();
+      request_size_ = ip::dns::encode_query(request_, id_, names_[name_index_], types_[type_index_]);
+      current_ ^= 1;
+      auto& op = exchange_ops_[current_].emplace(stdexec::__emplace_from{[&] {
+        return stdexec::connect(
+          make_exchange(
+            resolver_->context(),
+            config.nameservers[server_index_],
+            const_buffer{request_.data(), request_size_},
+            mutable_buffer{response_.data(), response_.size()},
+            config.timeout),
+          exchange_receiver<Receiver>{this});
+      }});
+      stdexec::start(op);
+    } catch (...) {
+      fail(std::current_exception());
+    }
+
+    template <class Receiver>
+    void operation<Receiver>::on_response(std::size_t size) noexcept {
+      std::error_code ec = ip::dns::decode_response(
+        std::span<const std::byte>{response_.data(), size}, id_, addresses_);
+      if (!ec || ec == ip::gaierrc::no_address) {
+        next_type();
+      } else if (ec == ip::gaierrc::unknown_name) {
+        next_name(ec);
+      } else {
+        on_failure(ec);
+      }
+    }
+
+    // Tries the next name server, or all name servers again, as described in resolv.conf(5).
+    template <class Receiver>
+    void operation<Receiver>::on_failure(std::error_code ec) noexcept {
+      const ip::dns::resolv_conf& config = resolver_->config();
+      last_error_ = ec;
+      server_index_ += 1;
+      if (server_index_ == config.nameservers.size()) {
+        server_index_ = 0;
+        attempt_ += 1;
+      }
+      if (attempt_ < config.attempts) {
+        start_exchange();
+      } else {
+        fail(ec);
+      }
+    }
+
+    template <class Receiver>
+    void operation<Receiver>::next_type() noexcept {
+      type_index_ += 1;
+      if (type_index_ < n_types_) {
+        start_exchange();
+      } else if (!addresses_.empty()) {
+        finish();
+      } else {
+        next_name(ip::make_error_code(ip::gaierrc::no_address));
+      }
+    }
+
+    template <class Receiver>
+    void operation<Receiver>::next_name(std::error_code ec) noexcept {
+      if (!addresses_.empty()) {
+        finish();
+        return;
+      }
+      name_index_ += 1;
+      type_index_ = 0;
+      if (name_index_ < names_.size()) {
+        start_exchange();
+      } else {
+        fail(ec);
+      }
+    }
+
+    template <class Receiver>
+    void operation<Receiver>::start() noexcept try {
+      const ip::addrinfo_type& hints = query_.hints();
+      std::error_code ec{};
+      port_ = ip::dns::service_port(query_.service_name(), hints.ai_socktype, ec);
+      if (ec) {
+        fail(ec);
+        return;
+      }
+      const std::string& host_name = query_.host_name();
+      if (host_name.empty()) {
+        const bool passive = hints.ai_flags & AI_PASSIVE;
+        if (hints.ai_family != AF_INET6) {
+          addresses_.push_back(passive ? ip::address_v4::any() : ip::address_v4::loopback());
+        }
+        if (hints.ai_family != AF_INET) {
+          addresses_.push_back(passive ? ip::address_v6::any() : ip::address_v6::loopback());
+        }
+        finish();
+        return;
+      }
+      ip::address numeric = ip::make_address(host_name, ec);
+      if (!ec) {
+        const bool matches = hints.ai_family == AF_UNSPEC
+                          || (hints.ai_family == AF_INET && numeric.is_v4())
+                          || (hints.ai_family == AF_INET6 && numeric.is_v6());
+        if (!matches) {
+          fail(ip::make_error_code(ip::gaierrc::address_family_not_supported));
+          return;
+        }
+        addresses_.push_back(numeric);
+        finish();
+        return;
+      }
+      resolver_->hosts().lookup(host_name, hints.ai_family, addresses_);
+      if (!addresses_.empty()) {
+        finish();
+        return;
+      }
+      if (hints.ai_family != AF_INET6) {
+        types_[n_types_++] = ip::dns::record_type::a;
+      }
+      if (hints.ai_family != AF_INET) {
+        types_[n_types_++] = ip::dns::record_type::aaaa;
+      }
+      names_ = resolver_->config().candidate_names(host_name);
+      start_exchange();
+    } catch (...) {
+      fail(std::current_exception());
+    }
+  }
+}
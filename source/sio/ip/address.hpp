@@ -25,8 +25,10 @@
 #include <cstddef>
 #include <cstdint>
 #include <string>
+#include <string_view>
 #include <cstring>
 #include <memory>
+#include <system_error>
 #include <variant>
 
 namespace sio::ip {
@@ -362,9 +364,21 @@ namespace sio::ip {
   }
 
   // Create an IPv4 address from an IP address string in dotted decimal form.
-  inline address_v4 make_address_v4(const char* addr) noexcept {
+  // Sets ec to std::errc::invalid_argument if the string is not a valid address.
+  inline address_v4 make_address_v4(const char* addr, std::error_code& ec) noexcept {
     address_v4::bytes_type bytes;
-    return ::inet_pton(AF_INET, addr, &bytes[0]) > 0 ? address_v4(bytes) : address_v4{};
+    if (::inet_pton(AF_INET, addr, &bytes[0]) > 0) {
+      ec.clear();
+      return address_v4(bytes);
+    }
+    ec = std::make_error_code(std::errc::invalid_argument);
+    return address_v4{};
+  }
+
+  // Create an IPv4 address from an IP address string in dotted decimal form.
+  inline address_v4 make_address_v4(const char* addr) noexcept {
+    std::error_code ec{};
+    return make_address_v4(addr, ec);
   }
 
   // Create an IPv4 address from an IP address string in dotted decimal form.
@@ -384,10 +398,12 @@ namespace sio::ip {
   }
 
   // Create an IPv6 address from an IP address string.
-  inline address_v6 make_address_v6(const char* str) noexcept {
+  // Sets ec to std::errc::invalid_argument if the string is not a valid address.
+  inline address_v6 make_address_v6(const char* str, std::error_code& ec) noexcept {
     const char* if_name = ::strchr(str, '%');
     const char* p = str;
     char addr_buf[INET6_ADDRSTRLEN + 1]{};
+    ec = std::make_error_code(std::errc::invalid_argument);
 
     if (if_name) {
       if (if_name - str > INET6_ADDRSTRLEN) {
@@ -413,11 +429,18 @@ namespace sio::ip {
           scope_id = ::atoi(if_name + 1);
         }
       }
+      ec.clear();
       return address_v6{std::bit_cast<address_v6::bytes_type>(addr), scope_id};
     }
     return address_v6{};
   }
 
+  // Create an IPv6 address from an IP address string.
+  inline address_v6 make_address_v6(const char* str) noexcept {
+    std::error_code ec{};
+    return make_address_v6(str, ec);
+  }
+
   // Create IPv6 address from an IP address string.
   inline address_v6 make_address_v6(const std::string& str) noexcept {
     return make_address_v6(str.c_str());
@@ -428,6 +451,36 @@ namespace sio::ip {
     return make_address_v6(static_cast<std::string>(str));
   }
 
+  // Create an IPv4 or IPv6 address from an IP address string.
+  // Sets ec to std::errc::invalid_argument if the string is neither.
+  inline address make_address(const char* str, std::error_code& ec) noexcept {
+    address_v4 v4 = make_address_v4(str, ec);
+    if (!ec) {
+      return v4;
+    }
+    address_v6 v6 = make_address_v6(str, ec);
+    if (!ec) {
+      return v6;
+    }
+    return address{};
+  }
+
+  // Create an IPv4 or IPv6 address from an IP address string without allocating memory.
+  inline address make_address(std::string_view str, std::error_code& ec) noexcept {
+    char buffer[INET6_ADDRSTRLEN + IF_NAMESIZE + 1]{};
+    if (str.size() >= sizeof(buffer) || str.find('\0') != std::string_view::npos) {
+      ec = std::make_error_code(std::errc::invalid_argument);
+      return address{};
+    }
+    std::memcpy(buffer, str.data(), str.size());
+    return make_address(static_cast<const char*>(buffer), ec);
+  }
+
+  // Create an IPv4 or IPv6 address from an IP address string.
+  inline address make_address(const std::string& str, std::error_code& ec) noexcept {
+    return make_address(str.c_str(), ec);
+  }
+
   // Tag type used for distinguishing overloads that deal in IPv4-mapped IPv6
   // addresses.
   enum class v4_mapped_t {
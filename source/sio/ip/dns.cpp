@@ -0,0 +1,336 @@
+#include "./dns.hpp"
+#include "./resolve.hpp"
+
+#include <netdb.h>
+#include <strings.h>
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+namespace sio::ip::dns {
+  namespace {
+    std::string read_file(const std::filesystem::path& path) {
+      std::ifstream file{path};
+      if (!file) {
+        return {};
+      }
+      std::ostringstream contents;
+      contents << file.rdbuf();
+      return contents.str();
+    }
+
+    template <class Fn>
+    void for_each_line(std::string_view contents, Fn fn) {
+      while (!contents.empty()) {
+        std::size_t end = contents.find('\n');
+        std::string_view line = contents.substr(0, end);
+        contents.remove_prefix(end == std::string_view::npos ? contents.size() : end + 1);
+        fn(line);
+      }
+    }
+
+    std::vector<std::string_view> split_words(std::string_view line, std::string_view comments) {
+      std::size_t comment = line.find_first_of(comments);
+      if (comment != std::string_view::npos) {
+        line = line.substr(0, comment);
+      }
+      std::vector<std::string_view> words{};
+      constexpr std::string_view whitespace = " \t\r";
+      std::size_t pos = line.find_first_not_of(whitespace);
+      while (pos != std::string_view::npos) {
+        std::size_t end = line.find_first_of(whitespace, pos);
+        words.push_back(line.substr(pos, end - pos));
+        pos = line.find_first_not_of(whitespace, end);
+      }
+      return words;
+    }
+
+    bool parse_int(std::string_view str, int& value) {
+      const char* last = str.data() + str.size();
+      auto [ptr, ec] = std::from_chars(str.data(), last, value);
+      return ec == std::errc{} && ptr == last;
+    }
+
+    bool iequals(std::string_view lhs, std::string_view rhs) noexcept {
+      return lhs.size() == rhs.size() && ::strncasecmp(lhs.data(), rhs.data(), lhs.size()) == 0;
+    }
+
+    std::uint8_t read_u8(std::span<const std::byte> message, std::size_t offset) noexcept {
+      return std::to_integer<std::uint8_t>(message[offset]);
+    }
+
+    std::uint16_t read_u16(std::span<const std::byte> message, std::size_t offset) noexcept {
+      return static_cast<std::uint16_t>(read_u8(message, offset) << 8 | read_u8(message, offset + 1));
+    }
+
+    void write_u16(std::span<std::byte> buffer, std::size_t offset, std::uint16_t value) noexcept {
+      buffer[offset] = static_cast<std::byte>(value >> 8);
+      buffer[offset + 1] = static_cast<std::byte>(value & 0xff);
+    }
+
+    // Advances offset past an encoded domain name. Returns false if the name is malformed.
+    bool skip_name(std::span<const std::byte> message, std::size_t& offset) noexcept {
+      while (offset < message.size()) {
+        std::uint8_t length = read_u8(message, offset);
+        if ((length & 0xc0) == 0xc0) {
+          offset += 2;
+          return offset <= message.size();
+        }
+        if (length & 0xc0) {
+          return false;
+        }
+        offset += 1;
+        if (length == 0) {
+          return true;
+        }
+        offset += length;
+      }
+      return false;
+    }
+
+    constexpr std::size_t header_size = 12;
+    constexpr std::uint16_t class_in = 1;
+  }
+
+  resolv_conf resolv_conf::parse(std::string_view contents) {
+    resolv_conf conf{};
+    for_each_line(contents, [&conf](std::string_view line) {
+      std::vector<std::string_view> words = split_words(line, "#;");
+      if (words.size() < 2) {
+        return;
+      }
+      if (words[0] == "nameserver") {
+        std::error_code ec{};
+        ip::address addr = ip::make_address(words[1], ec);
+        if (!ec) {
+          conf.nameservers.emplace_back(addr, default_port);
+        }
+      } else if (words[0] == "search" || words[0] == "domain") {
+        conf.search.assign(words.begin() + 1, words.end());
+      } else if (words[0] == "options") {
+        for (std::string_view option: std::span{words}.subspan(1)) {
+          std::size_t colon = option.find(':');
+          std::string_view name = option.substr(0, colon);
+          int value = 0;
+          if (colon == std::string_view::npos || !parse_int(option.substr(colon + 1), value)) {
+            continue;
+          }
+          if (name == "ndots") {
+            conf.ndots = std::clamp(value, 0, 15);
+          } else if (name == "timeout") {
+            conf.timeout = std::chrono::seconds(std::clamp(value, 1, 30));
+          } else if (name == "attempts") {
+            conf.attempts = std::clamp(value, 1, 5);
+          }
+        }
+      }
+    });
+    // resolv.conf(5): if no nameserver is given the name server on the local machine is used.
+    if (conf.nameservers.empty()) {
+      conf.nameservers.emplace_back(ip::address_v4::loopback(), default_port);
+    }
+    return conf;
+  }
+
+  resolv_conf resolv_conf::load(const std::filesystem::path& path) {
+    return parse(read_file(path));
+  }
+
+  std::vector<std::string> resolv_conf::candidate_names(std::string_view host_name) const {
+    std::vector<std::string> names{};
+    if (host_name.ends_with('.')) {
+      host_name.remove_suffix(1);
+      names.emplace_back(host_name);
+      return names;
+    }
+    const auto dots = std::count(host_name.begin(), host_name.end(), '.');
+    if (dots >= ndots) {
+      names.emplace_back(host_name);
+    }
+    for (const std::string& domain: search) {
+      std::string name{host_name};
+      name += '.';
+      name += domain;
+      names.push_back(static_cast<std::string&&>(name));
+    }
+    if (dots < ndots) {
+      names.emplace_back(host_name);
+    }
+    return names;
+  }
+
+  hosts_file hosts_file::parse(std::string_view contents) {
+    hosts_file hosts{};
+    for_each_line(contents, [&hosts](std::string_view line) {
+      std::vector<std::string_view> words = split_words(line, "#");
+      if (words.size() < 2) {
+        return;
+      }
+      std::error_code ec{};
+      ip::address addr = ip::make_address(words[0], ec);
+      if (ec) {
+        return;
+      }
+      for (std::string_view name: std::span{words}.subspan(1)) {
+        hosts.entries_.emplace_back(std::string{name}, addr);
+      }
+    });
+    return hosts;
+  }
+
+  hosts_file hosts_file::load(const std::filesystem::path& path) {
+    return parse(read_file(path));
+  }
+
+  void hosts_file::lookup(
+    std::string_view host_name,
+    int family,
+    std::vector<ip::address>& addresses) const {
+    if (host_name.ends_with('.')) {
+      host_name.remove_suffix(1);
+    }
+    for (const auto& [name, addr]: entries_) {
+      if (!iequals(name, host_name)) {
+        continue;
+      }
+      if ((family == AF_INET && !addr.is_v4()) || (family == AF_INET6 && !addr.is_v6())) {
+        continue;
+      }
+      if (std::find(addresses.begin(), addresses.end(), addr) == addresses.end()) {
+        addresses.push_back(addr);
+      }
+    }
+  }
+
+  std::size_t encode_query(
+    std::span<std::byte> buffer,
+    std::uint16_t id,
+    std::string_view name,
+    record_type type) {
+    if (name.ends_with('.')) {
+      name.remove_suffix(1);
+    }
+    // Each label is prefixed by its length and the name is terminated by the empty label.
+    const std::size_t encoded_name_size = name.size() + 2;
+    if (name.empty() || encoded_name_size > 255) {
+      throw std::system_error(std::make_error_code(std::errc::invalid_argument));
+    }
+    const std::size_t size = header_size + encoded_name_size + 4;
+    if (buffer.size() < size) {
+      throw std::system_error(std::make_error_code(std::errc::no_buffer_space));
+    }
+    std::fill_n(buffer.begin(), header_size, std::byte{0});
+    write_u16(buffer, 0, id);
+    write_u16(buffer, 2, 0x0100); // recursion desired
+    write_u16(buffer, 4, 1);      // one question
+    std::size_t offset = header_size;
+    while (!name.empty()) {
+      const std::size_t dot = name.find('.');
+      const std::string_view label = name.substr(0, dot);
+      if (label.empty() || label.size() > 63) {
+        throw std::system_error(std::make_error_code(std::errc::invalid_argument));
+      }
+      buffer[offset++] = static_cast<std::byte>(label.size());
+      std::memcpy(&buffer[offset], label.data(), label.size());
+      offset += label.size();
+      name.remove_prefix(dot == std::string_view::npos ? name.size() : dot + 1);
+    }
+    buffer[offset++] = std::byte{0};
+    write_u16(buffer, offset, static_cast<std::uint16_t>(type));
+    write_u16(buffer, offset + 2, class_in);
+    return offset + 4;
+  }
+
+  std::error_code decode_response(
+    std::span<const std::byte> message,
+    std::uint16_t id,
+    std::vector<ip::address>& addresses) {
+    const std::error_code bad_message = std::make_error_code(std::errc::bad_message);
+    if (message.size() < header_size || read_u16(message, 0) != id) {
+      return bad_message;
+    }
+    const std::uint16_t flags = read_u16(message, 2);
+    if (!(flags & 0x8000)) {
+      return bad_message;
+    }
+    if (flags & 0x0200) {
+      // The answer did not fit into a UDP datagram. We do not retry over TCP.
+      return std::make_error_code(std::errc::message_size);
+    }
+    switch (flags & 0x000f) {
+    case 0:
+      break;
+    case 2:
+      return make_error_code(gaierrc::temporary_failure);
+    case 3:
+      return make_error_code(gaierrc::unknown_name);
+    default:
+      return make_error_code(gaierrc::non_recoverable_failure);
+    }
+    const std::uint16_t n_questions = read_u16(message, 4);
+    const std::uint16_t n_answers = read_u16(message, 6);
+    std::size_t offset = header_size;
+    for (std::uint16_t i = 0; i < n_questions; ++i) {
+      if (!skip_name(message, offset) || offset + 4 > message.size()) {
+        return bad_message;
+      }
+      offset += 4;
+    }
+    const std::size_t n_addresses = addresses.size();
+    for (std::uint16_t i = 0; i < n_answers; ++i) {
+      if (!skip_name(message, offset) || offset + 10 > message.size()) {
+        return bad_message;
+      }
+      const auto type = static_cast<record_type>(read_u16(message, offset));
+      const std::uint16_t rclass = read_u16(message, offset + 2);
+      const std::uint16_t rdlength = read_u16(message, offset + 8);
+      offset += 10;
+      if (offset + rdlength > message.size()) {
+        return bad_message;
+      }
+      if (rclass == class_in && type == record_type::a && rdlength == 4) {
+        ip::address_v4::bytes_type bytes{};
+        std::memcpy(bytes.data(), &message[offset], bytes.size());
+        addresses.push_back(ip::address_v4{bytes});
+      } else if (rclass == class_in && type == record_type::aaaa && rdlength == 16) {
+        ip::address_v6::bytes_type bytes{};
+        std::memcpy(bytes.data(), &message[offset], bytes.size());
+        addresses.push_back(ip::address_v6{bytes});
+      }
+      offset += rdlength;
+    }
+    if (addresses.size() == n_addresses) {
+      return make_error_code(gaierrc::no_address);
+    }
+    return {};
+  }
+
+  port_type service_port(const std::string& service, int socktype, std::error_code& ec) noexcept {
+    ec.clear();
+    if (service.empty()) {
+      return 0;
+    }
+    int port = 0;
+    if (parse_int(service, port)) {
+      if (port < 0 || port > 0xffff) {
+        ec = make_error_code(gaierrc::service_not_supported);
+        return 0;
+      }
+      return static_cast<port_type>(port);
+    }
+    ::servent entry{};
+    ::servent* result = nullptr;
+    char buffer[1024];
+    const char* protocol = socktype == SOCK_DGRAM ? "udp" : "tcp";
+    if (
+      ::getservbyname_r(service.c_str(), protocol, &entry, buffer, sizeof(buffer), &result) != 0
+      || result == nullptr) {
+      ec = make_error_code(gaierrc::service_not_supported);
+      return 0;
+    }
+    return ::ntohs(static_cast<std::uint16_t>(result->s_port));
+  }
+}
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2024 Maikel Nadolski
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "./address.hpp"
+#include "./endpoint.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+// The pieces of a stub resolver that do not depend on any I/O: parsing of resolv.conf(5) and
+// hosts(5) and encoding and decoding of DNS messages as described in RFC 1035.
+namespace sio::ip::dns {
+  enum class record_type : std::uint16_t {
+    a = 1,
+    cname = 5,
+    aaaa = 28
+  };
+
+  // Queries and responses sent over UDP without EDNS0 are limited to 512 bytes.
+  inline constexpr std::size_t max_udp_message_size = 512;
+
+  inline constexpr port_type default_port = 53;
+
+  struct resolv_conf {
+    std::vector<ip::endpoint> nameservers{};
+    std::vector<std::string> search{};
+    int ndots{1};
+    std::chrono::milliseconds timeout{std::chrono::seconds(5)};
+    int attempts{2};
+
+    static resolv_conf parse(std::string_view contents);
+
+    static resolv_conf load(const std::filesystem::path& path = "/etc/resolv.conf");
+
+    // Returns the names that are queried in order for the given host name.
+    std::vector<std::string> candidate_names(std::string_view host_name) const;
+  };
+
+  class hosts_file {
+   public:
+    hosts_file() = default;
+
+    static hosts_file parse(std::string_view contents);
+
+    static hosts_file load(const std::filesystem::path& path = "/etc/hosts");
+
+    // Appends all addresses of the given family (or any family for AF_UNSPEC) for host_name.
+    void lookup(std::string_view host_name, int family, std::vector<ip::address>& addresses) const;
+
+   private:
+    std::vector<std::pair<std::string, ip::address>> entries_{};
+  };
+
+  // Writes a recursive query for name into buffer and returns the size of the message.
+  // Throws std::system_error if the name is not valid or if the buffer is too small.
+  std::size_t encode_query(
+    std::span<std::byte> buffer,
+    std::uint16_t id,
+    std::string_view name,
+    record_type type);
+
+  // Appends all A and AAAA records of the answer section of a response to addresses.
+  // Name errors and server failures are reported in the resolver error category.
+  std::error_code decode_response(
+    std::span<const std::byte> message,
+    std::uint16_t id,
+    std::vector<ip::address>& addresses);
+
+  // Returns the port of a numeric service or looks it up in the services database.
+  port_type service_port(const std::string& service, int socktype, std::error_code& ec) noexcept;
+}
@@ -29,10 +29,16 @@
 
 #include <netdb.h>
 
+#include <charconv>
 #include <csignal>
 #include <cstring>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <span>
 #include <string>
 #include <string_view>
+#include <vector>
 
 #include <exec/sequence_senders.hpp>
 #include <exec/inline_scheduler.hpp>
@@ -76,11 +82,15 @@ namespace sio::ip {
     }
   };
 
-  static const resolver_error_category_t& resolver_error_category() noexcept {
+  inline const resolver_error_category_t& resolver_error_category() noexcept {
     static const resolver_error_category_t impl{};
     return impl;
   }
 
+  inline std::error_code make_error_code(gaierrc ec) noexcept {
+    return std::error_code{static_cast<int>(ec), resolver_error_category()};
+  }
+
   enum class resolver_flags {
     canonical_name = AI_CANONNAME,
     passive = AI_PASSIVE,
@@ -165,14 +175,30 @@ namespace sio::ip {
       return hints_;
     }
 
-    const std::string& host_name() const {
+    const std::string& host_name() const& {
       return host_name_;
     }
 
-    const std::string& service_name() const {
+    std::string host_name() && noexcept {
+      return static_cast<std::string&&>(host_name_);
+    }
+
+    const std::string& service_name() const& {
       return service_name_;
     }
 
+    std::string service_name() && noexcept {
+      return static_cast<std::string&&>(service_name_);
+    }
+
+    friend bool operator==(const resolver_query& lhs, const resolver_query& rhs) noexcept {
+      return lhs.hints_.ai_family == rhs.hints_.ai_family
+          && lhs.hints_.ai_socktype == rhs.hints_.ai_socktype
+          && lhs.hints_.ai_protocol == rhs.hints_.ai_protocol
+          && lhs.hints_.ai_flags == rhs.hints_.ai_flags && lhs.host_name_ == rhs.host_name_
+          && lhs.service_name_ == rhs.service_name_;
+    }
+
    private:
     addrinfo_type hints_{};
     std::string host_name_;
@@ -186,21 +212,30 @@ namespace sio::ip {
       std::string host_name,
       std::string service_name) noexcept
       : host_name_{static_cast<std::string&&>(host_name)}
-      , service_name_{static_cast<std::string>(service_name)} {
+      , service_name_{static_cast<std::string&&>(service_name)} {
       if (result->ai_addr->sa_family == AF_INET) {
         ::sockaddr_in native_endpoint = std::bit_cast<::sockaddr_in>(*result->ai_addr);
         ip::address_v4 addr{std::bit_cast<ip::address_v4::bytes_type>(native_endpoint.sin_addr)};
-        endpoint_ = ip::endpoint{addr, native_endpoint.sin_port};
+        endpoint_ = ip::endpoint{addr, ::ntohs(native_endpoint.sin_port)};
       } else {
         SIO_ASSERT(result->ai_addr->sa_family == AF_INET6);
         SIO_ASSERT(result->ai_addrlen == sizeof(::sockaddr_in6));
         ::sockaddr_in6 native_endpoint;
         std::memcpy(&native_endpoint, result->ai_addr, sizeof(native_endpoint));
         ip::address_v6 addr{std::bit_cast<ip::address_v6::bytes_type>(native_endpoint.sin6_addr)};
-        endpoint_ = ip::endpoint{addr, native_endpoint.sin6_port};
+        endpoint_ = ip::endpoint{addr, ::ntohs(native_endpoint.sin6_port)};
       }
     }
 
+    explicit resolver_result(
+      ip::endpoint endpoint,
+      std::string host_name,
+      std::string service_name) noexcept
+      : host_name_{static_cast<std::string&&>(host_name)}
+      , service_name_{static_cast<std::string&&>(service_name)}
+      , endpoint_{endpoint} {
+    }
+
     operator ip::endpoint() const noexcept {
       return endpoint_;
     }
@@ -224,8 +259,125 @@ namespace sio::ip {
   };
 }
 
+namespace std {
+  template <>
+  struct hash<sio::ip::resolver_query> {
+    std::size_t operator()(const sio::ip::resolver_query& query) const noexcept {
+      const sio::ip::addrinfo_type& hints = query.hints();
+      std::size_t seed = std::hash<std::string>()(query.host_name());
+      auto combine = [&seed](std::size_t value) {
+        seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+      };
+      combine(std::hash<std::string>()(query.service_name()));
+      combine(std::hash<int>()(hints.ai_family));
+      combine(std::hash<int>()(hints.ai_socktype));
+      combine(std::hash<int>()(hints.ai_protocol));
+      combine(std::hash<int>()(hints.ai_flags));
+      return seed;
+    }
+  };
+}
+
 namespace sio::async {
   namespace resolve_ {
+    using results_type = std::vector<ip::resolver_result>;
+
+    template <class Receiver>
+    struct results_operation_base;
+
+    template <class Receiver>
+    struct results_next_receiver {
+      using receiver_concept = stdexec::receiver_t;
+      results_operation_base<Receiver>* op_{};
+
+      void set_value() && noexcept {
+        op_->index_ += 1;
+        if (op_->index_ < op_->results_->size()) {
+          op_->start_next();
+        } else {
+          op_->results_.reset();
+          stdexec::set_value(static_cast<Receiver&&>(op_->receiver_));
+        }
+      }
+
+      void set_stopped() && noexcept {
+        op_->results_.reset();
+        exec::set_value_unless_stopped(static_cast<Receiver&&>(op_->receiver_));
+      }
+
+      auto get_env() const noexcept -> stdexec::env_of_t<Receiver> {
+        return stdexec::get_env(op_->receiver_);
+      }
+    };
+
+    // Emits a list of already resolved results one by one to a sequence receiver.
+    // This is used by resolvers that do not produce their results from getaddrinfo.
+    template <class Receiver>
+    struct results_operation_base {
+      using just_result = decltype(stdexec::just(stdexec::__declval<ip::resolver_result>()));
+      using next_sender = exec::next_sender_of_t<Receiver&, just_result>;
+      using next_rcvr_t = results_next_receiver<Receiver>;
+
+      [[no_unique_address]] Receiver receiver_;
+      std::shared_ptr<const results_type> results_{};
+      std::size_t index_{};
+      std::optional<stdexec::connect_result_t<next_sender, next_rcvr_t>> next_op_{};
+
+      explicit results_operation_base(Receiver&& receiver)
+        : receiver_{static_cast<Receiver&&>(receiver)} {
+      }
+
+      void emit(std::shared_ptr<const results_type> results) noexcept {
+        results_ = static_cast<std::shared_ptr<const results_type>&&>(results);
+        index_ = 0;
+        if (!results_ || results_->empty()) {
+          results_.reset();
+          stdexec::set_value(static_cast<Receiver&&>(receiver_));
+        } else {
+          start_next();
+        }
+      }
+
+      void start_next() noexcept try {
+        auto& next_op = next_op_.emplace(stdexec::__emplace_from{[&] {
+          return stdexec::connect(
+            exec::set_next(receiver_, stdexec::just((*results_)[index_])), next_rcvr_t{this});
+        }});
+        stdexec::start(next_op);
+      } catch (...) {
+        results_.reset();
+        stdexec::set_error(static_cast<Receiver&&>(receiver_), std::current_exception());
+      }
+    };
+
+    // Parses a query with a literal address and a numeric port without calling getaddrinfo.
+    // Queries that need the name service or would be mapped by the hints are not handled here.
+    inline bool parse_numeric(const ip::resolver_query& query, ip::endpoint& endpoint) noexcept {
+      const std::string& service = query.service_name();
+      if (query.host_name().empty() || service.empty()) {
+        return false;
+      }
+      unsigned port = 0;
+      const char* last = service.data() + service.size();
+      auto [ptr, errc] = std::from_chars(service.data(), last, port);
+      if (errc != std::errc{} || ptr != last || port > 0xffff) {
+        return false;
+      }
+      std::error_code ec{};
+      ip::address addr = ip::make_address(query.host_name(), ec);
+      if (ec) {
+        return false;
+      }
+      const int family = query.hints().ai_family;
+      if (
+        (family == AF_INET && !addr.is_v4()) || (family == AF_INET6 && !addr.is_v6())
+        || (family != AF_UNSPEC && family != AF_INET && family != AF_INET6)) {
+        return false;
+      }
+      endpoint = ip::endpoint{addr, static_cast<ip::port_type>(port)};
+      return true;
+    }
+
     template <class Scheduler, class Receiver>
     struct operation;
 
@@ -235,19 +387,19 @@ namespace sio::async {
       operation<Scheduler, Receiver>* op_{};
 
       void set_value() && noexcept {
-        SIO_ASSERT(op_->result_iter_ != nullptr);
-        op_->result_iter_ = op_->result_iter_->ai_next;
+        if (op_->result_iter_) {
+          op_->result_iter_ = op_->result_iter_->ai_next;
+        }
         if (op_->result_iter_) {
           op_->start_next();
         } else {
-          ::freeaddrinfo(op_->request_.ar_result);
+          op_->free_result();
           stdexec::set_value(static_cast<Receiver&&>(op_->receiver_));
         }
       }
 
       void set_stopped() && noexcept {
-        SIO_ASSERT(op_->request_.ar_result);
-        ::freeaddrinfo(op_->request_.ar_result);
+        op_->free_result();
         exec::set_value_unless_stopped(static_cast<Receiver&&>(op_->receiver_));
       }
 
@@ -272,6 +424,7 @@ namespace sio::async {
       std::optional<stdexec::connect_result_t<next_sender, next_rcvr_t>> next_op_{};
       ::gaicb* requests_[1]{&request_};
       sigevent_t sigev{};
+      ip::endpoint numeric_endpoint_{};
 
       explicit operation(Scheduler&& scheduler, ip::resolver_query query, Receiver&& receiver)
         : receiver_{static_cast<Receiver&&>(receiver)}
@@ -286,16 +439,33 @@ namespace sio::async {
         sigev.sigev_notify_function = &operation::notify;
       }
 
+      void free_result() noexcept {
+        if (request_.ar_result) {
+          ::freeaddrinfo(request_.ar_result);
+          request_.ar_result = nullptr;
+        }
+      }
+
+      // A numeric query has a single result, which takes over the names of the query instead
+      // of copying them.
+      ip::resolver_result make_result() {
+        if (result_iter_) {
+          return ip::resolver_result{result_iter_, query_.host_name(), query_.service_name()};
+        }
+        return ip::resolver_result{
+          numeric_endpoint_,
+          static_cast<ip::resolver_query&&>(query_).host_name(),
+          static_cast<ip::resolver_query&&>(query_).service_name()};
+      }
+
       void start_next() noexcept try {
         auto& next_op = next_op_.emplace(stdexec::__emplace_from{[&] {
-          auto res = //
-            stdexec::just(
-              ip::resolver_result{result_iter_, query_.host_name(), query_.service_name()});
+          auto res = stdexec::just(make_result());
           return stdexec::connect(exec::set_next(receiver_, std::move(res)), next_rcvr_t{this});
         }});
         stdexec::start(next_op);
       } catch (...) {
-
+        free_result();
         stdexec::set_error(static_cast<Receiver&&>(receiver_), std::current_exception());
       }
 
@@ -319,6 +489,11 @@ namespace sio::async {
       }
 
       void start() noexcept {
+        // Literal addresses with numeric ports are emitted inline, without the notification thread.
+        if (resolve_::parse_numeric(query_, numeric_endpoint_)) {
+          start_next();
+          return;
+        }
         ::getaddrinfo_a(GAI_NOWAIT, requests_, 1, &sigev);
       }
     };
@@ -351,6 +526,165 @@ namespace sio::async {
 
   } // namespace resolve_
 
+  namespace resolve_many_ {
+    template <class Receiver>
+    struct operation;
+
+    template <class Receiver>
+    struct next_receiver {
+      using receiver_concept = stdexec::receiver_t;
+      operation<Receiver>* op_{};
+
+      void set_value() && noexcept {
+        SIO_ASSERT(op_->result_iter_ != nullptr);
+        op_->result_iter_ = op_->result_iter_->ai_next;
+        op_->advance();
+      }
+
+      void set_stopped() && noexcept {
+        op_->free_results();
+        exec::set_value_unless_stopped(static_cast<Receiver&&>(op_->receiver_));
+      }
+
+      auto get_env() const noexcept -> stdexec::env_of_t<Receiver> {
+        return stdexec::get_env(op_->receiver_);
+      }
+    };
+
+    template <class Receiver>
+    struct operation {
+      using just_result =
+        decltype(stdexec::just(std::size_t{}, stdexec::__declval<ip::resolver_result>()));
+      using next_sender = exec::next_sender_of_t<Receiver&, just_result>;
+      using next_rcvr_t = next_receiver<Receiver>;
+
+      [[no_unique_address]] Receiver receiver_;
+      std::vector<ip::resolver_query> queries_;
+      std::vector<::gaicb> requests_{};
+      std::vector<::gaicb*> request_ptrs_{};
+      std::size_t index_{};
+      ::addrinfo* result_iter_{};
+      std::error_code error_{};
+
+      std::optional<stdexec::connect_result_t<next_sender, next_rcvr_t>> next_op_{};
+      sigevent_t sigev{};
+
+      explicit operation(std::vector<ip::resolver_query> queries, Receiver&& receiver)
+        : receiver_{static_cast<Receiver&&>(receiver)}
+        , queries_{static_cast<std::vector<ip::resolver_query>&&>(queries)} {
+      }
+
+      void free_results() noexcept {
+        for (::gaicb& request: requests_) {
+          if (request.ar_result) {
+            ::freeaddrinfo(request.ar_result);
+            request.ar_result = nullptr;
+          }
+        }
+      }
+
+      void start_next() noexcept try {
+        auto& next_op = next_op_.emplace(stdexec::__emplace_from{[&] {
+          const ip::resolver_query& query = queries_[index_];
+          auto res = stdexec::just(
+            index_, ip::resolver_result{result_iter_, query.host_name(), query.service_name()});
+          return stdexec::connect(exec::set_next(receiver_, std::move(res)), next_rcvr_t{this});
+        }});
+        stdexec::start(next_op);
+      } catch (...) {
+        free_results();
+        stdexec::set_error(static_cast<Receiver&&>(receiver_), std::current_exception());
+      }
+
+      // Emits the next address of the current query or moves on to the next query.
+      // Failed queries are skipped and the first error is reported after all results.
+      void advance() noexcept {
+        while (!result_iter_) {
+          index_ += 1;
+          if (index_ == requests_.size()) {
+            free_results();
+            if (error_) {
+              stdexec::set_error(static_cast<Receiver&&>(receiver_), error_);
+            } else {
+              stdexec::set_value(static_cast<Receiver&&>(receiver_));
+            }
+            return;
+          }
+          result_iter_ = requests_[index_].ar_result;
+        }
+        start_next();
+      }
+
+      static void notify(sigval __sigval) noexcept {
+        operation& self = *static_cast<operation*>(__sigval.sival_ptr);
+        bool canceled = false;
+        for (::gaicb* request: self.request_ptrs_) {
+          int rc = ::gai_error(request);
+          if (rc == EAI_CANCELED) {
+            canceled = true;
+          } else if (rc != 0 && !self.error_) {
+            self.error_ = std::error_code{rc, ip::resolver_error_category()};
+          }
+        }
+        if (canceled) {
+          self.free_results();
+          stdexec::set_stopped(static_cast<Receiver&&>(self.receiver_));
+          return;
+        }
+        self.result_iter_ = self.requests_[0].ar_result;
+        self.advance();
+      }
+
+      void start() noexcept try {
+        if (queries_.empty()) {
+          stdexec::set_value(static_cast<Receiver&&>(receiver_));
+          return;
+        }
+        requests_.resize(queries_.size());
+        request_ptrs_.resize(queries_.size());
+        for (std::size_t i = 0; i < queries_.size(); ++i) {
+          requests_[i].ar_name = queries_[i].host_name().c_str();
+          requests_[i].ar_service = queries_[i].service_name().c_str();
+          requests_[i].ar_request = &queries_[i].hints();
+          requests_[i].ar_result = nullptr;
+          request_ptrs_[i] = &requests_[i];
+        }
+        sigev.sigev_notify = SIGEV_THREAD;
+        sigev.sigev_value.sival_ptr = this;
+        sigev.sigev_notify_function = &operation::notify;
+        int rc = ::getaddrinfo_a(
+          GAI_NOWAIT, request_ptrs_.data(), static_cast<int>(request_ptrs_.size()), &sigev);
+        if (rc != 0) {
+          stdexec::set_error(
+            static_cast<Receiver&&>(receiver_), std::error_code{rc, ip::resolver_error_category()});
+        }
+      } catch (...) {
+        stdexec::set_error(static_cast<Receiver&&>(receiver_), std::current_exception());
+      }
+    };
+
+    struct sender {
+      using sender_concept = exec::sequence_sender_t;
+
+      using completion_signatures = stdexec::completion_signatures<
+        stdexec::set_value_t(),
+        stdexec::set_error_t(std::error_code),
+        stdexec::set_error_t(std::exception_ptr),
+        stdexec::set_stopped_t()>;
+
+      using item_types = exec::item_types<decltype(stdexec::just(
+        std::declval<std::size_t>(), std::declval<ip::resolver_result>()))>;
+
+      std::vector<ip::resolver_query> queries_;
+
+      template <decays_to<sender> Self, class Receiver>
+      friend operation<Receiver> tag_invoke(exec::subscribe_t, Self&& self, Receiver receiver) {
+        return operation<Receiver>{
+          static_cast<Self&&>(self).queries_, static_cast<Receiver&&>(receiver)};
+      }
+    };
+  } // namespace resolve_many_
+
   struct resolve_t {
     template <class _Resolver>
       requires stdexec::tag_invocable<resolve_t, _Resolver, const ip::resolver_query&>
@@ -360,6 +694,16 @@ namespace sio::async {
       return tag_invoke(*this, static_cast<_Resolver&&>(__resolver), query);
     }
 
+    template <class _Resolver, class _Arg, class... _Args>
+      requires(!stdexec::__decays_to<_Arg, ip::resolver_query>)
+           && stdexec::tag_invocable<resolve_t, _Resolver, const ip::resolver_query&>
+           && std::constructible_from<ip::resolver_query, _Arg, _Args...>
+    auto operator()(_Resolver&& __resolver, _Arg&& __arg, _Args&&... __args) const {
+      return this->operator()(
+        static_cast<_Resolver&&>(__resolver),
+        ip::resolver_query{static_cast<_Arg&&>(__arg), static_cast<_Args&&>(__args)...});
+    }
+
     template <stdexec::scheduler Scheduler>
       requires(!stdexec::tag_invocable<resolve_t, Scheduler, const ip::resolver_query&>)
     resolve_::sender<Scheduler> operator()(Scheduler scheduler, ip::resolver_query query) const {
@@ -386,4 +730,18 @@ namespace sio::async {
   };
 
   inline constexpr resolve_t resolve;
+
+  // Submits all queries with a single getaddrinfo_a call and emits (index, resolver_result)
+  // items, where index refers to the position of the query in the span.
+  //
+  // glibc notifies once for the whole list, so items are emitted in the order of the queries
+  // after the last lookup has finished. Failed queries do not produce items. The sequence
+  // completes with the error of the first failed query after all results have been emitted.
+  struct resolve_many_t {
+    resolve_many_::sender operator()(std::span<const ip::resolver_query> queries) const {
+      return resolve_many_::sender{std::vector<ip::resolver_query>(queries.begin(), queries.end())};
+    }
+  };
+
+  inline constexpr resolve_many_t resolve_many;
 }
@@ -0,0 +1,411 @@
+/*
+ * Copyright (c) 2024 Maikel Nadolski
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "./resolve.hpp"
+#include "../intrusive_list.hpp"
+
+#include <chrono>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <system_error>
+#include <unordered_map>
+
+#include <exec/sequence_senders.hpp>
+#include <exec/inline_scheduler.hpp>
+
+namespace sio::ip {
+  struct resolver_cache_options {
+    // How long successful lookups are served from the cache.
+    std::chrono::steady_clock::duration ttl = std::chrono::seconds(30);
+    // How long failed lookups are served from the cache.
+    std::chrono::steady_clock::duration negative_ttl = std::chrono::seconds(5);
+    // Results of lookups that complete while the cache holds more entries are not kept.
+    std::size_t max_entries = 1024;
+  };
+
+  struct resolver_cache_statistics {
+    std::size_t hits{};
+    std::size_t misses{};
+    std::size_t coalesced{};
+    std::size_t entries{};
+  };
+
+  class resolver_cache;
+}
+
+namespace sio::async::resolver_cache_ {
+  using results_type = resolve_::results_type;
+
+  struct lookup_result {
+    std::shared_ptr<const results_type> results_{};
+    std::error_code error_{};
+    std::exception_ptr exception_{};
+    bool stopped_{false};
+  };
+
+  struct waiter_base {
+    void (*complete_)(waiter_base*, lookup_result) noexcept {};
+    const ip::resolver_query* key_{};
+    waiter_base* next_{};
+    waiter_base* prev_{};
+    bool waiting_{false};
+    // Set by cancel under the lock of the cache, such that a waiter that is stopped before it
+    // is queued completes right away.
+    bool stop_requested_{false};
+  };
+
+  using waiter_list = intrusive_list<&waiter_base::next_, &waiter_base::prev_>;
+
+  struct lookup;
+
+  template <class Receiver>
+  struct operation;
+}
+
+namespace sio::ip {
+  // Caches the results of async::resolve for a configurable time to live.
+  //
+  // Failed lookups are cached for a shorter time and concurrent lookups of the same query
+  // share a single request to the underlying resolver. The cache has to outlive all lookups
+  // that have been started through it.
+  class resolver_cache {
+   public:
+    using clock = std::chrono::steady_clock;
+
+    explicit resolver_cache(resolver_cache_options options = {}) noexcept
+      : options_{options} {
+    }
+
+    resolver_cache(const resolver_cache&) = delete;
+    resolver_cache& operator=(const resolver_cache&) = delete;
+
+    resolver_cache_statistics statistics() const {
+      std::scoped_lock lock{mutex_};
+      return {hits_, misses_, coalesced_, entries_.size()};
+    }
+
+    // Drops all settled entries. Lookups in flight are kept.
+    void clear() {
+      std::scoped_lock lock{mutex_};
+      std::erase_if(entries_, [](const auto& entry) { return !entry.second.pending_; });
+    }
+
+   private:
+    friend struct async::resolver_cache_::lookup;
+    template <class Receiver>
+    friend struct async::resolver_cache_::operation;
+
+    struct entry {
+      std::shared_ptr<const async::resolver_cache_::results_type> results_{};
+      std::error_code error_{};
+      clock::time_point expires_{};
+      bool pending_{false};
+      async::resolver_cache_::waiter_list waiters_{};
+    };
+
+    void start(async::resolver_cache_::waiter_base* waiter) noexcept;
+
+    bool cancel(async::resolver_cache_::waiter_base* waiter) noexcept;
+
+    void finish(const resolver_query& query, async::resolver_cache_::lookup_result result) noexcept;
+
+    resolver_cache_options options_;
+    mutable std::mutex mutex_{};
+    std::unordered_map<resolver_query, entry> entries_{};
+    std::size_t hits_{};
+    std::size_t misses_{};
+    std::size_t coalesced_{};
+  };
+}
+
+namespace sio::async::resolver_cache_ {
+  struct collect_receiver {
+    using receiver_concept = stdexec::receiver_t;
+
+    lookup* lookup_;
+
+    template <class Item>
+    friend auto tag_invoke(exec::set_next_t, collect_receiver& self, Item&& item) {
+      return stdexec::then(
+        static_cast<Item&&>(item), [self](ip::resolver_result result) noexcept {
+          self.push_back(static_cast<ip::resolver_result&&>(result));
+        });
+    }
+
+    void push_back(ip::resolver_result result) const noexcept;
+
+    void finish(lookup_result result) const noexcept;
+
+    void set_value() && noexcept;
+
+    void set_error(std::error_code ec) && noexcept;
+
+    void set_error(std::exception_ptr error) && noexcept;
+
+    void set_stopped() && noexcept;
+
+    auto get_env() const noexcept -> stdexec::empty_env {
+      return {};
+    }
+  };
+
+  // A lookup is shared by all waiters of a query and deletes itself when it completes.
+  struct lookup {
+    using sender_t = resolve_::sender<exec::inline_scheduler>;
+    using operation_t = exec::subscribe_result_t<sender_t, collect_receiver>;
+
+    lookup(ip::resolver_cache* cache, const ip::resolver_query& query)
+      : cache_{cache}
+      , query_{query}
+      , op_{exec::subscribe(sender_t{exec::inline_scheduler{}, query}, collect_receiver{this})} {
+    }
+
+    ip::resolver_cache* cache_;
+    ip::resolver_query query_;
+    results_type results_{};
+    std::exception_ptr error_{};
+    operation_t op_;
+  };
+
+  inline void collect_receiver::push_back(ip::resolver_result result) const noexcept {
+    if (lookup_->error_) {
+      return;
+    }
+    try {
+      lookup_->results_.push_back(static_cast<ip::resolver_result&&>(result));
+    } catch (...) {
+      lookup_->error_ = std::current_exception();
+    }
+  }
+
+  inline void collect_receiver::finish(lookup_result result) const noexcept {
+    lookup* self = lookup_;
+    self->cache_->finish(self->query_, static_cast<lookup_result&&>(result));
+    // This receiver is owned by the lookup and must not be accessed after this point.
+    delete self;
+  }
+
+  inline void collect_receiver::set_value() && noexcept {
+    lookup_result result{};
+    if (lookup_->error_) {
+      result.exception_ = lookup_->error_;
+    } else {
+      try {
+        result.results_ = std::make_shared<const results_type>(
+          static_cast<results_type&&>(lookup_->results_));
+      } catch (...) {
+        result.exception_ = std::current_exception();
+      }
+    }
+    finish(static_cast<lookup_result&&>(result));
+  }
+
+  inline void collect_receiver::set_error(std::error_code ec) && noexcept {
+    finish(lookup_result{nullptr, ec});
+  }
+
+  inline void collect_receiver::set_error(std::exception_ptr error) && noexcept {
+    finish(lookup_result{nullptr, {}, static_cast<std::exception_ptr&&>(error)});
+  }
+
+  inline void collect_receiver::set_stopped() && noexcept {
+    finish(lookup_result{nullptr, {}, nullptr, true});
+  }
+
+  template <class Receiver>
+  struct operation
+    : waiter_base
+    , resolve_::results_operation_base<Receiver> {
+    struct on_receiver_stop {
+      operation* op_;
+
+      void operator()() const noexcept {
+        op_->request_stop();
+      }
+    };
+
+    using stop_token_t = stdexec::stop_token_of_t<stdexec::env_of_t<Receiver>>;
+    using stop_callback_t = typename stop_token_t::template callback_type<on_receiver_stop>;
+
+    ip::resolver_cache* cache_;
+    ip::resolver_query query_;
+    std::optional<stop_callback_t> stop_callback_{};
+
+    explicit operation(ip::resolver_cache* cache, ip::resolver_query query, Receiver&& receiver)
+      : waiter_base{&operation::complete}
+      , resolve_::results_operation_base<Receiver>{static_cast<Receiver&&>(receiver)}
+      , cache_{cache}
+      , query_{static_cast<ip::resolver_query&&>(query)} {
+      this->key_ = &query_;
+    }
+
+    static void complete(waiter_base* self, lookup_result result) noexcept {
+      operation& op = *static_cast<operation*>(self);
+      op.stop_callback_.reset();
+      if (result.stopped_) {
+        stdexec::set_stopped(static_cast<Receiver&&>(op.receiver_));
+      } else if (result.exception_) {
+        stdexec::set_error(
+          static_cast<Receiver&&>(op.receiver_),
+          static_cast<std::exception_ptr&&>(result.exception_));
+      } else if (result.error_) {
+        stdexec::set_error(static_cast<Receiver&&>(op.receiver_), result.error_);
+      } else {
+        op.emit(static_cast<std::shared_ptr<const results_type>&&>(result.results_));
+      }
+    }
+
+    void request_stop() noexcept {
+      if (cache_->cancel(this)) {
+        stdexec::set_stopped(static_cast<Receiver&&>(this->receiver_));
+      }
+    }
+
+    void start() noexcept {
+      // The callback is registered before the waiter becomes visible to other threads.
+      // A stop request that arrives earlier is observed by the cache before it queues us.
+      stop_callback_.emplace(
+        stdexec::get_stop_token(stdexec::get_env(this->receiver_)), on_receiver_stop{this});
+      cache_->start(this);
+    }
+  };
+
+  struct sender {
+    using sender_concept = exec::sequence_sender_t;
+
+    using completion_signatures = stdexec::completion_signatures<
+      stdexec::set_value_t(),
+      stdexec::set_error_t(std::error_code),
+      stdexec::set_error_t(std::exception_ptr),
+      stdexec::set_stopped_t()>;
+
+    using item_types =
+      exec::item_types<decltype(stdexec::just(std::declval<ip::resolver_result>()))>;
+
+    ip::resolver_cache* cache_;
+    ip::resolver_query query_;
+
+    template <decays_to<sender> Self, class Receiver>
+    friend operation<Receiver> tag_invoke(exec::subscribe_t, Self&& self, Receiver receiver) {
+      return operation<Receiver>{
+        self.cache_,
+        static_cast<Self&&>(self).query_,
+        static_cast<Receiver&&>(receiver)};
+    }
+  };
+}
+
+namespace sio::ip {
+  inline void resolver_cache::start(async::resolver_cache_::waiter_base* waiter) noexcept {
+    using namespace async::resolver_cache_;
+    lookup_result result{};
+    lookup* new_lookup = nullptr;
+    try {
+      std::scoped_lock lock{mutex_};
+      // A stop request either finds the waiter queued in cancel or is seen here.
+      if (waiter->stop_requested_) {
+        result.stopped_ = true;
+      } else {
+        const clock::time_point now = clock::now();
+        if (entries_.size() >= options_.max_entries) {
+          std::erase_if(entries_, [now](const auto& entry) {
+            return !entry.second.pending_ && entry.second.expires_ <= now;
+          });
+        }
+        auto [iter, inserted] = entries_.try_emplace(*waiter->key_);
+        entry& e = iter->second;
+        if (!inserted && e.pending_) {
+          coalesced_ += 1;
+          waiter->waiting_ = true;
+          e.waiters_.push_back(waiter);
+          return;
+        }
+        if (!inserted && now < e.expires_) {
+          hits_ += 1;
+          result.results_ = e.results_;
+          result.error_ = e.error_;
+        } else {
+          new_lookup = new lookup{this, *waiter->key_};
+          misses_ += 1;
+          e.pending_ = true;
+          e.results_.reset();
+          e.error_.clear();
+          waiter->waiting_ = true;
+          e.waiters_.push_back(waiter);
+        }
+      }
+    } catch (...) {
+      result.exception_ = std::current_exception();
+    }
+    if (new_lookup) {
+      // The waiter may be stopped concurrently from here on and must not be accessed anymore.
+      stdexec::start(new_lookup->op_);
+    } else {
+      waiter->complete_(waiter, static_cast<lookup_result&&>(result));
+    }
+  }
+
+  inline bool resolver_cache::cancel(async::resolver_cache_::waiter_base* waiter) noexcept {
+    std::scoped_lock lock{mutex_};
+    waiter->stop_requested_ = true;
+    if (!waiter->waiting_) {
+      return false;
+    }
+    auto iter = entries_.find(*waiter->key_);
+    SIO_ASSERT(iter != entries_.end());
+    iter->second.waiters_.erase(waiter);
+    waiter->waiting_ = false;
+    return true;
+  }
+
+  inline void resolver_cache::finish(
+    const resolver_query& query,
+    async::resolver_cache_::lookup_result result) noexcept {
+    using namespace async::resolver_cache_;
+    waiter_list waiters{};
+    {
+      std::scoped_lock lock{mutex_};
+      auto iter = entries_.find(query);
+      SIO_ASSERT(iter != entries_.end());
+      entry& e = iter->second;
+      waiters = static_cast<waiter_list&&>(e.waiters_);
+      for (waiter_base& w: waiters) {
+        w.waiting_ = false;
+      }
+      if (result.exception_ || result.stopped_ || entries_.size() > options_.max_entries) {
+        entries_.erase(iter);
+      } else {
+        e.pending_ = false;
+        e.results_ = result.results_;
+        e.error_ = result.error_;
+        e.expires_ = clock::now() + (result.error_ ? options_.negative_ttl : options_.ttl);
+      }
+    }
+    while (!waiters.empty()) {
+      waiter_base* w = waiters.pop_front();
+      w->complete_(w, result);
+    }
+  }
+
+  // Hooks the cache into async::resolve, i.e. async::resolve(cache, query).
+  inline auto tag_invoke(async::resolve_t, resolver_cache& cache, const resolver_query& query)
+    -> async::resolver_cache_::sender {
+    return async::resolver_cache_::sender{&cache, query};
+  }
+}
@@ -2,9 +2,14 @@
 
 #include "./assert.hpp"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cstdint>
 #include <cstddef>
 #include <cstring>
+#include <stdexcept>
+#include <utility>
 
 namespace sio {
 
@@ -26,6 +31,76 @@ namespace sio {
       value |= value >> 32;
       return tab64[((uint64_t) ((value - (value >> 1)) * 0x07EDD5E59A4E28C2)) >> 58];
     }
+
+    // A thread moves blocks between its magazine and the central lists in batches of this size.
+    constexpr std::uint32_t batch_size = 16;
+    constexpr std::uint32_t magazine_capacity = 2 * batch_size;
+
+    std::size_t this_thread_index() noexcept {
+      static std::atomic<std::size_t> next_index{0};
+      thread_local const std::size_t index = next_index.fetch_add(1, std::memory_order_relaxed);
+      return index;
+    }
+
+    void* next_block(void* block) noexcept {
+      void* next = nullptr;
+      std::memcpy(&next, block, sizeof(void*));
+      return next;
+    }
+
+    void set_next_block(void* block, void* next) noexcept {
+      std::memcpy(block, &next, sizeof(void*));
+    }
+
+    void* to_pointer(void* block) noexcept {
+      return static_cast<char*>(block) + sizeof(memory_block);
+    }
+
+    constexpr std::array<std::size_t, memory_pool::n_alignments> bucket_alignments{
+      alignof(std::max_align_t),
+      64,
+      memory_pool::max_alignment};
+
+    // Memory that is handed out starts at this offset within an upstream allocation.
+    std::size_t payload_offset(std::size_t bucket) noexcept {
+      return std::max(bucket_alignments[bucket], sizeof(memory_block));
+    }
+
+    int alignment_bucket(std::size_t alignment) noexcept {
+      if (alignment & (alignment - 1)) {
+        return -1;
+      }
+      for (std::size_t bucket = 0; bucket < bucket_alignments.size(); ++bucket) {
+        if (alignment <= bucket_alignments[bucket]) {
+          return static_cast<int>(bucket);
+        }
+      }
+      return -1;
+    }
+
+    // Sizes up to 16 bytes share the first class. Above that every doubling [2^k, 2^(k+1))
+    // is split into four classes with capacities 2^k + 2^(k-2) * (sub + 1).
+    int size_class_of(std::size_t size) noexcept {
+      if (size <= 16) {
+        return 0;
+      }
+      const int k = log2_64(size - 1);
+      const std::size_t sub = ((size - 1) >> (k - 2)) & 3;
+      const std::size_t size_class = 1 + static_cast<std::size_t>(k - 4) * 4 + sub;
+      if (size_class >= memory_pool::n_size_classes) {
+        return -1;
+      }
+      return static_cast<int>(size_class);
+    }
+
+    std::size_t block_size(std::size_t index) noexcept {
+      const std::size_t bucket = index / memory_pool::n_size_classes;
+      return payload_offset(bucket) + memory_pool::capacity(index % memory_pool::n_size_classes);
+    }
+
+    std::size_t block_alignment(std::size_t index) noexcept {
+      return bucket_alignments[index / memory_pool::n_size_classes];
+    }
   }
 
   memory_pool::memory_pool(memory_resource* res) noexcept
@@ -36,29 +111,201 @@ namespace sio {
   }
 
   memory_pool::~memory_pool() {
-    for (std::size_t i = 0; i < 32; ++i) {
-      void* ptr = block_lists_[i];
-      while (ptr) {
-        void* next = nullptr;
-        std::memcpy(&next, ptr, sizeof(void*));
-        upstream_->deallocate(ptr, 1 << (i + 1));
-        ptr = next;
+    for (std::size_t i = 0; i < n_free_lists; ++i) {
+      if (i < n_size_classes) {
+        for (magazine& mag: magazines_) {
+          free_blocks(i, mag.blocks_[i]);
+        }
       }
+      free_blocks(i, block_lists_[i]);
     }
   }
 
-  allocate_sender memory_pool::allocate(std::size_t size, std::size_t) {
-    auto index = log2_64(size + sizeof(memory_block));
-    if (index < 0 || index >= 32) {
+  allocate_sender memory_pool::allocate(std::size_t size, std::size_t alignment) {
+    const int size_class = size_class_of(size);
+    if (size_class < 0) {
       throw std::invalid_argument("invalid size");
     }
-    return allocate_sender{this, static_cast<std::size_t>(index)};
+    const int bucket = alignment_bucket(alignment);
+    if (bucket < 0) {
+      throw std::invalid_argument("invalid alignment");
+    }
+    const std::size_t index = static_cast<std::size_t>(bucket) * n_size_classes
+                            + static_cast<std::size_t>(size_class);
+    return allocate_sender{this, index};
   }
 
   deallocate_sender memory_pool::deallocate(void* ptr, void (*destroy)(void*)) noexcept {
     return deallocate_sender{this, ptr, destroy};
   }
 
+  std::size_t memory_pool::capacity(std::size_t size_class) noexcept {
+    if (size_class == 0) {
+      return 16;
+    }
+    const std::size_t k = (size_class - 1) / 4 + 4;
+    const std::size_t sub = (size_class - 1) % 4;
+    return (std::size_t{1} << k) + ((sub + 1) << (k - 2));
+  }
+
+  memory_pool::magazine& memory_pool::local_magazine() noexcept {
+    return magazines_[this_thread_index() % n_magazines];
+  }
+
+  void* memory_pool::try_allocate(std::size_t index) noexcept {
+    std::atomic<bool>& used = counters_[index].used_;
+    if (!used.load(std::memory_order_relaxed)) {
+      used.store(true, std::memory_order_relaxed);
+    }
+    const bool cached = index < n_size_classes;
+    magazine& mag = local_magazine();
+    if (cached && !mag.busy_.test_and_set()) {
+      void* block = mag.blocks_[index];
+      if (block) {
+        mag.blocks_[index] = next_block(block);
+        mag.counts_[index] -= 1;
+      }
+      mag.busy_.clear();
+      if (block) {
+        return to_pointer(block);
+      }
+    }
+    void* batch = nullptr;
+    {
+      std::scoped_lock lock{mutex_};
+      batch = block_lists_[index];
+      void* last = nullptr;
+      void* block = batch;
+      for (std::uint32_t n = 0; block && n < batch_size; ++n) {
+        last = block;
+        block = next_block(block);
+        central_counts_[index] -= 1;
+      }
+      block_lists_[index] = block;
+      if (last) {
+        set_next_block(last, nullptr);
+      }
+    }
+    if (batch) {
+      void* rest = next_block(batch);
+      if (rest && cached && !mag.busy_.test_and_set()) {
+        while (rest) {
+          void* next = next_block(rest);
+          set_next_block(rest, mag.blocks_[index]);
+          mag.blocks_[index] = rest;
+          mag.counts_[index] += 1;
+          rest = next;
+        }
+        mag.busy_.clear();
+        if (pending_count_[index].load() > 0) {
+          flush_magazine(mag, index);
+        }
+      } else if (rest) {
+        release_blocks(index, rest);
+      }
+      return to_pointer(batch);
+    }
+    void* buffer = upstream_->allocate(block_size(index), block_alignment(index));
+    if (!buffer) {
+      return nullptr;
+    }
+    counters& c = counters_[index];
+    c.upstream_allocations_.fetch_add(1, std::memory_order_relaxed);
+    const std::size_t owned = c.owned_.fetch_add(1, std::memory_order_relaxed) + 1;
+    std::size_t high_water_mark = c.high_water_mark_.load(std::memory_order_relaxed);
+    while (high_water_mark < owned
+           && !c.high_water_mark_.compare_exchange_weak(
+             high_water_mark, owned, std::memory_order_relaxed)) {
+    }
+    const std::size_t offset = payload_offset(index / n_size_classes);
+    void* header = static_cast<char*>(buffer) + offset - sizeof(memory_block);
+    memory_block block{
+      nullptr, static_cast<std::uint32_t>(index), static_cast<std::uint32_t>(offset)};
+    std::memcpy(header, &block, sizeof(memory_block));
+    return to_pointer(header);
+  }
+
+  bool memory_pool::enqueue(allocate_operation_base* op) noexcept {
+    const std::size_t index = op->index_;
+    {
+      std::unique_lock lock{mutex_};
+      if (op->stop_requested_) {
+        return false;
+      }
+      if (void* block = block_lists_[index]) {
+        block_lists_[index] = next_block(block);
+        central_counts_[index] -= 1;
+        lock.unlock();
+        op->result_.emplace<0>(to_pointer(block));
+        op->complete_(op);
+        return true;
+      }
+      op->waiting_ = true;
+      pending_allocation_[index].push_back(op);
+      pending_count_[index].fetch_add(1);
+    }
+    // Blocks may still be cached in magazines. Threads that cache blocks from now on see the
+    // pending count and hand them to the central list themselves.
+    if (index < n_size_classes) {
+      for (magazine& mag: magazines_) {
+        flush_magazine(mag, index);
+      }
+    }
+    return true;
+  }
+
+  bool memory_pool::cancel(allocate_operation_base* op) noexcept {
+    std::scoped_lock lock{mutex_};
+    op->stop_requested_ = true;
+    if (!op->waiting_) {
+      return false;
+    }
+    pending_allocation_[op->index_].erase(op);
+    pending_count_[op->index_].fetch_sub(1);
+    op->waiting_ = false;
+    return true;
+  }
+
+  void memory_pool::flush_magazine(magazine& mag, std::size_t index) noexcept {
+    // The owner of a magazine holds the flag only for a few instructions.
+    while (mag.busy_.test_and_set()) {
+    }
+    void* blocks = std::exchange(mag.blocks_[index], nullptr);
+    mag.counts_[index] = 0;
+    mag.busy_.clear();
+    if (blocks) {
+      release_blocks(index, blocks);
+    }
+  }
+
+  // Completes pending allocations with the given blocks and puts the rest on the central list.
+  void memory_pool::release_blocks(std::size_t index, void* blocks) noexcept {
+    intrusive_list<&allocate_operation_base::next_, &allocate_operation_base::prev_> ready{};
+    {
+      std::scoped_lock lock{mutex_};
+      while (blocks && !pending_allocation_[index].empty()) {
+        allocate_operation_base* op = pending_allocation_[index].pop_front();
+        pending_count_[index].fetch_sub(1);
+        op->waiting_ = false;
+        void* next = next_block(blocks);
+        op->result_.emplace<0>(to_pointer(blocks));
+        ready.push_back(op);
+        blocks = next;
+      }
+      while (blocks) {
+        void* next = next_block(blocks);
+        set_next_block(blocks, block_lists_[index]);
+        block_lists_[index] = blocks;
+        central_counts_[index] += 1;
+        blocks = next;
+      }
+    }
+    while (!ready.empty()) {
+      allocate_operation_base* op = ready.pop_front();
+      op->complete_(op);
+    }
+  }
+
   void memory_pool::reclaim_memory(void* ptr) noexcept {
     if (!ptr) {
       return;
@@ -66,17 +313,139 @@ namespace sio {
     void* blockptr = static_cast<char*>(ptr) - sizeof(memory_block);
     memory_block block{};
     std::memcpy(&block, blockptr, sizeof(memory_block));
-    SIO_ASSERT(block.index < 32);
-    std::unique_lock lock(mutex_);
-    if (!pending_allocation_[block.index].empty()) {
-      allocate_operation_base* op = pending_allocation_[block.index].pop_front();
-      op->result_.emplace<0>(ptr);
-      lock.unlock();
-      op->complete_(op);
-    } else {
-      block.next = block_lists_[block.index];
-      std::memcpy(blockptr, &block, sizeof(memory_block));
-      block_lists_[block.index] = blockptr;
+    SIO_ASSERT(block.index < n_free_lists);
+    const std::size_t index = block.index;
+    magazine& mag = local_magazine();
+    if (index >= n_size_classes || mag.busy_.test_and_set()) {
+      set_next_block(blockptr, nullptr);
+      release_blocks(index, blockptr);
+      return;
+    }
+    set_next_block(blockptr, mag.blocks_[index]);
+    mag.blocks_[index] = blockptr;
+    mag.counts_[index] += 1;
+    void* overflow = nullptr;
+    if (mag.counts_[index] > magazine_capacity) {
+      // Keep the most recently freed blocks and return the older half to the central list.
+      void* last = mag.blocks_[index];
+      for (std::uint32_t n = 1; n < mag.counts_[index] - batch_size; ++n) {
+        last = next_block(last);
+      }
+      overflow = next_block(last);
+      set_next_block(last, nullptr);
+      mag.counts_[index] -= batch_size;
+    }
+    mag.busy_.clear();
+    if (overflow) {
+      release_blocks(index, overflow);
+    }
+    if (pending_count_[index].load() > 0) {
+      flush_magazine(mag, index);
+    }
+  }
+
+  memory_pool_statistics memory_pool::statistics() const {
+    std::array<std::size_t, n_size_classes> magazine_counts{};
+    for (const magazine& mag: magazines_) {
+      while (mag.busy_.test_and_set()) {
+      }
+      for (std::size_t i = 0; i < n_size_classes; ++i) {
+        magazine_counts[i] += mag.counts_[i];
+      }
+      mag.busy_.clear();
+    }
+    memory_pool_statistics stats{};
+    std::scoped_lock lock{mutex_};
+    for (std::size_t i = 0; i < n_free_lists; ++i) {
+      const counters& c = counters_[i];
+      const std::size_t upstream_allocations =
+        c.upstream_allocations_.load(std::memory_order_relaxed);
+      const std::size_t pending = pending_count_[i].load();
+      if (upstream_allocations == 0 && pending == 0) {
+        continue;
+      }
+      const std::size_t owned = c.owned_.load(std::memory_order_relaxed);
+      const std::size_t cached =
+        central_counts_[i] + (i < n_size_classes ? magazine_counts[i] : 0);
+      memory_pool_size_class_statistics& entry = stats.size_classes.emplace_back();
+      entry.size = capacity(i % n_size_classes);
+      entry.alignment = block_alignment(i);
+      entry.live_blocks = owned > cached ? owned - cached : 0;
+      entry.cached_blocks = cached;
+      entry.upstream_allocations = upstream_allocations;
+      entry.pending_allocations = pending;
+      entry.high_water_mark = c.high_water_mark_.load(std::memory_order_relaxed);
+      stats.live_bytes += entry.live_blocks * entry.size;
+      stats.cached_bytes += entry.cached_blocks * entry.size;
+    }
+    return stats;
+  }
+
+  // Returns a list of blocks to the upstream resource and returns the number of bytes freed.
+  std::size_t memory_pool::free_blocks(std::size_t index, void* blocks) noexcept {
+    std::size_t n_blocks = 0;
+    while (blocks) {
+      void* next = next_block(blocks);
+      memory_block block{};
+      std::memcpy(&block, blocks, sizeof(memory_block));
+      void* buffer = static_cast<char*>(to_pointer(blocks)) - block.offset;
+      upstream_->deallocate(buffer, block_size(index), block_alignment(index));
+      n_blocks += 1;
+      blocks = next;
+    }
+    counters_[index].owned_.fetch_sub(n_blocks, std::memory_order_relaxed);
+    return n_blocks * block_size(index);
+  }
+
+  std::size_t memory_pool::trim(std::size_t max_cached_blocks) noexcept {
+    std::size_t released = 0;
+    for (std::size_t i = 0; i < n_free_lists; ++i) {
+      released += trim_free_list(i, max_cached_blocks);
+    }
+    return released;
+  }
+
+  std::size_t
+    memory_pool::trim_free_list(std::size_t index, std::size_t max_cached_blocks) noexcept {
+    if (counters_[index].owned_.load(std::memory_order_relaxed) == 0) {
+      return 0;
+    }
+    if (index < n_size_classes) {
+      for (magazine& mag: magazines_) {
+        flush_magazine(mag, index);
+      }
+    }
+    // The most recently freed blocks are at the front of the list and are kept.
+    void* excess = nullptr;
+    {
+      std::scoped_lock lock{mutex_};
+      if (central_counts_[index] <= max_cached_blocks) {
+        return 0;
+      }
+      if (max_cached_blocks == 0) {
+        excess = std::exchange(block_lists_[index], nullptr);
+      } else {
+        void* last = block_lists_[index];
+        for (std::size_t n = 1; n < max_cached_blocks; ++n) {
+          last = next_block(last);
+        }
+        excess = next_block(last);
+        set_next_block(last, nullptr);
+      }
+      central_counts_[index] = max_cached_blocks;
+    }
+    return free_blocks(index, excess);
+  }
+
+  // Each free list is idle on its own, such that a busy size class does not keep the cached
+  // blocks of the others alive. Allocations that are served from the cache count as activity.
+  std::size_t memory_pool::trim_if_idle(std::size_t max_cached_blocks) noexcept {
+    std::size_t released = 0;
+    for (std::size_t i = 0; i < n_free_lists; ++i) {
+      if (!counters_[i].used_.exchange(false, std::memory_order_relaxed)) {
+        released += trim_free_list(i, max_cached_blocks);
+      }
     }
+    return released;
   }
 }
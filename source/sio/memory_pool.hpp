@@ -20,12 +20,17 @@
 #include "./intrusive_list.hpp"
 
 #include <array>
+#include <atomic>
+#include <cstdint>
 #include <cstring>
 #include <mutex>
+#include <optional>
 #include <variant>
+#include <vector>
 
 #include <stdexec/__detail/__concepts.hpp>
 #include <stdexec/__detail/__senders_core.hpp>
+#include <exec/timed_scheduler.hpp>
 
 namespace sio {
   class memory_resource {
@@ -39,11 +44,7 @@ namespace sio {
     memory_resource& operator=(const memory_resource&) = default;
 
     [[nodiscard]] void* allocate(size_t __bytes, size_t __alignment = _S_max_align) noexcept {
-      void* ptr = do_allocate(__bytes, __alignment);
-      if (ptr) {
-        return ::operator new(__bytes, do_allocate(__bytes, __alignment));
-      }
-      return nullptr;
+      return do_allocate(__bytes, __alignment);
     }
 
     void deallocate(void* __p, size_t __bytes, size_t __alignment = _S_max_align) noexcept {
@@ -70,8 +71,30 @@ namespace sio {
         return ::operator new(__bytes, std::align_val_t(__alignment));
       }
 
-      void do_deallocate(void* __p, size_t, size_t) noexcept override {
-        ::operator delete(__p);
+      void do_deallocate(void* __p, size_t, size_t __alignment) noexcept override {
+        ::operator delete(__p, std::align_val_t(__alignment));
+      }
+
+      bool do_is_equal(const memory_resource& __other) const noexcept override {
+        return &__other == this;
+      }
+    };
+
+    static type res{};
+    return &res;
+  }
+
+  // A resource whose allocations always fail. As the upstream of a fixed buffer it bounds the
+  // memory of the resources built on top of it.
+  inline memory_resource* null_memory_resource() noexcept {
+    struct type : memory_resource {
+      type() = default;
+
+      void* do_allocate(size_t, size_t) noexcept override {
+        return nullptr;
+      }
+
+      void do_deallocate(void*, size_t, size_t) noexcept override {
       }
 
       bool do_is_equal(const memory_resource& __other) const noexcept override {
@@ -85,9 +108,34 @@ namespace sio {
 
   class memory_pool;
 
+  struct memory_pool_size_class_statistics {
+    // The usable size and the alignment of blocks in this class.
+    std::size_t size;
+    std::size_t alignment;
+    // Blocks that are currently handed out.
+    std::size_t live_blocks;
+    // Free blocks in the central list and in the magazines of all threads.
+    std::size_t cached_blocks;
+    std::size_t upstream_allocations;
+    std::size_t pending_allocations;
+    // The largest number of blocks that were owned by the pool at the same time.
+    std::size_t high_water_mark;
+  };
+
+  struct memory_pool_statistics {
+    // Only size classes that were used are reported.
+    std::vector<memory_pool_size_class_statistics> size_classes;
+    std::size_t live_bytes;
+    std::size_t cached_bytes;
+  };
+
+  // The header is placed directly in front of the memory that is handed out.
   struct memory_block {
     void* next;
-    std::size_t index;
+    // The free list of the block, which is alignment bucket * n_size_classes + size class.
+    std::uint32_t index;
+    // The distance from the start of the upstream allocation to the end of this header.
+    std::uint32_t offset;
   };
 
   struct allocate_operation_base {
@@ -97,6 +145,9 @@ namespace sio {
     allocate_operation_base* next_{};
     allocate_operation_base* prev_{};
     std::variant<void*, std::exception_ptr> result_{};
+    // Both flags are guarded by the mutex of the pool.
+    bool waiting_{false};
+    bool stop_requested_{false};
   };
 
   template <class Receiver>
@@ -200,21 +251,79 @@ namespace sio {
     }
   };
 
+  // Blocks are cached in a small number of magazines in front of the central free lists.
+  // Each thread uses one magazine that is guarded by a spin flag. Threads that find their
+  // magazine busy or empty fall back to the mutex-protected central lists, which are refilled
+  // and drained in batches.
+  //
+  // Every doubling of the requested size is split into four size classes. Blocks are kept in
+  // separate free lists for default, cache line and page alignment. Only blocks with default
+  // alignment are cached in magazines.
   class memory_pool {
+   public:
+    static constexpr std::size_t n_size_classes = 113;
+    static constexpr std::size_t n_alignments = 3;
+    static constexpr std::size_t n_free_lists = n_size_classes * n_alignments;
+    static constexpr std::size_t max_alignment = 4096;
+    static constexpr std::size_t n_magazines = 16;
+
+    // Returns the number of bytes usable in blocks of the given size class.
+    static std::size_t capacity(std::size_t size_class) noexcept;
+
    private:
     template <class Receiver>
     friend struct allocate_operation;
     template <class Receiver>
     friend struct deallocate_operation;
 
+    struct alignas(64) magazine {
+      mutable std::atomic_flag busy_{};
+      std::array<void*, n_size_classes> blocks_{};
+      std::array<std::uint32_t, n_size_classes> counts_{};
+    };
+
+    struct counters {
+      std::atomic<std::size_t> upstream_allocations_{};
+      std::atomic<std::size_t> owned_{};
+      std::atomic<std::size_t> high_water_mark_{};
+      // Set by allocations and cleared by trim_if_idle. It is only written when it changes, so
+      // that the hot path does not contend on it.
+      std::atomic<bool> used_{};
+    };
+
     memory_resource* upstream_{};
-    std::mutex mutex_{};
-    std::array<void*, 32> block_lists_{};
-    std::array<intrusive_list<&allocate_operation_base::next_, &allocate_operation_base::prev_>, 32>
+    mutable std::mutex mutex_{};
+    std::array<void*, n_free_lists> block_lists_{};
+    // The number of blocks in each central list, guarded by the mutex.
+    std::array<std::size_t, n_free_lists> central_counts_{};
+    std::array<counters, n_free_lists> counters_{};
+    std::array<
+      intrusive_list<&allocate_operation_base::next_, &allocate_operation_base::prev_>,
+      n_free_lists>
       pending_allocation_{};
+    // The number of pending allocations per free list. Threads that cache a block in their
+    // magazine check this afterwards and hand their blocks to the central list if it is set.
+    std::array<std::atomic<std::size_t>, n_free_lists> pending_count_{};
+    std::array<magazine, n_magazines> magazines_{};
+
+    magazine& local_magazine() noexcept;
+
+    void* try_allocate(std::size_t index) noexcept;
+
+    bool enqueue(allocate_operation_base* op) noexcept;
+
+    bool cancel(allocate_operation_base* op) noexcept;
+
+    void flush_magazine(magazine& mag, std::size_t index) noexcept;
+
+    void release_blocks(std::size_t index, void* blocks) noexcept;
 
     void reclaim_memory(void* ptr) noexcept;
 
+    std::size_t free_blocks(std::size_t index, void* blocks) noexcept;
+
+    std::size_t trim_free_list(std::size_t index, std::size_t max_cached_blocks) noexcept;
+
    public:
     explicit memory_pool(memory_resource* res = get_default_resource()) noexcept;
     memory_pool(const memory_pool&) = delete;
@@ -224,35 +333,37 @@ namespace sio {
     ~memory_pool();
 
     allocate_sender allocate(std::size_t size, std::size_t alignment);
+
+    // Takes a snapshot of the counters of all size classes. The magazines of other threads are
+    // locked one after another, so the snapshot is not atomic as a whole.
+    memory_pool_statistics statistics() const;
+
+    // Returns cached blocks to the upstream resource until at most max_cached_blocks are left
+    // in each free list. Blocks cached in the magazines of all threads are drained first.
+    // Returns the number of bytes that were released.
+    std::size_t trim(std::size_t max_cached_blocks = 0) noexcept;
+
+    // Trims the free lists that did not hand out a block since the previous call.
+    std::size_t trim_if_idle(std::size_t max_cached_blocks) noexcept;
+
     deallocate_sender deallocate(void* ptr, void (*destroy)(void*) = nullptr) noexcept;
   };
 
   template <class Receiver>
   void allocate_operation<Receiver>::start() noexcept {
-    SIO_ASSERT(index_ >= 0 && index_ < 32);
-    std::unique_lock lock(pool_->mutex_);
-    void* block_ptr = pool_->block_lists_[index_];
-    void* buffer = block_ptr;
-    if (!buffer) {
-      buffer = pool_->upstream_->allocate(1 << (index_ + 1));
-      if (!buffer) {
-        pool_->pending_allocation_[index_].push_back(this);
-        stop_callback_.emplace(
-          stdexec::get_stop_token(stdexec::get_env(receiver_)), on_receiver_stop{this});
-        return;
-      }
+    SIO_ASSERT(index_ < memory_pool::n_free_lists);
+    if (void* result = pool_->try_allocate(index_)) {
+      stdexec::set_value(static_cast<Receiver&&>(receiver_), result);
+      return;
     }
-    if (block_ptr) {
-      void* next = nullptr;
-      std::memcpy(&next, buffer, sizeof(void*));
-      pool_->block_lists_[index_] = next;
-    } else {
-      memory_block block{nullptr, index_};
-      std::memcpy(buffer, &block, sizeof(memory_block));
+    // The callback is registered before the operation is queued. A stop request that arrives
+    // earlier is remembered by the pool and the operation is not queued at all.
+    stop_callback_.emplace(
+      stdexec::get_stop_token(stdexec::get_env(receiver_)), on_receiver_stop{this});
+    if (!pool_->enqueue(this)) {
+      stop_callback_.reset();
+      stdexec::set_stopped(static_cast<Receiver&&>(receiver_));
     }
-    lock.unlock();
-    void* result = static_cast<char*>(buffer) + sizeof(memory_block);
-    stdexec::set_value(static_cast<Receiver&&>(receiver_), result);
   }
 
   template <class Receiver>
@@ -313,12 +424,11 @@ namespace sio {
 
   template <class Receiver>
   void allocate_operation<Receiver>::on_receiver_stop::operator()() const noexcept {
-    {
-      std::scoped_lock lock{op_->pool_->mutex_};
-      op_->pool_->pending_allocation_[op_->index_].erase(op_);
+    allocate_operation* op = op_;
+    if (op->pool_->cancel(op)) {
+      op->stop_callback_.reset();
+      stdexec::set_stopped(static_cast<Receiver&&>(op->receiver_));
     }
-    op_->stop_callback_.reset();
-    stdexec::set_stopped(static_cast<Receiver&&>(op_->receiver_));
   }
 
   template <class T>
@@ -326,4 +436,129 @@ namespace sio {
     return pool_->deallocate(ptr, [](void* vptr) { static_cast<T*>(vptr)->~T(); });
   }
 
+  namespace periodic_ {
+    template <class Scheduler, class Fn, class Receiver>
+    struct operation;
+
+    template <class Scheduler, class Fn, class Receiver>
+    struct timer_receiver {
+      using receiver_concept = stdexec::receiver_t;
+      operation<Scheduler, Fn, Receiver>* op_;
+
+      void set_value() && noexcept {
+        op_->tick();
+      }
+
+      template <class Error>
+      void set_error(Error&& error) && noexcept {
+        if constexpr (std::same_as<std::decay_t<Error>, std::exception_ptr>) {
+          stdexec::set_error(static_cast<Receiver&&>(op_->receiver_), static_cast<Error&&>(error));
+        } else {
+          stdexec::set_error(
+            static_cast<Receiver&&>(op_->receiver_),
+            std::make_exception_ptr(static_cast<Error&&>(error)));
+        }
+      }
+
+      void set_stopped() && noexcept {
+        stdexec::set_stopped(static_cast<Receiver&&>(op_->receiver_));
+      }
+
+      auto get_env() const noexcept -> stdexec::env_of_t<Receiver> {
+        return stdexec::get_env(op_->receiver_);
+      }
+    };
+
+    template <class Scheduler>
+    using timer_sender_t = decltype(exec::schedule_after(
+      std::declval<Scheduler&>(), std::declval<exec::duration_of_t<Scheduler>>()));
+
+    template <class Scheduler, class Fn, class Receiver>
+    struct operation {
+      using timer_op_t = stdexec::
+        connect_result_t<timer_sender_t<Scheduler>, timer_receiver<Scheduler, Fn, Receiver>>;
+
+      Scheduler scheduler_;
+      exec::duration_of_t<Scheduler> period_;
+      Fn fn_;
+      [[no_unique_address]] Receiver receiver_;
+      std::optional<timer_op_t> timer_op_{};
+
+      void start_timer() noexcept try {
+        auto& op = timer_op_.emplace(stdexec::__emplace_from{[&] {
+          return stdexec::connect(
+            exec::schedule_after(scheduler_, period_),
+            timer_receiver<Scheduler, Fn, Receiver>{this});
+        }});
+        stdexec::start(op);
+      } catch (...) {
+        stdexec::set_error(static_cast<Receiver&&>(receiver_), std::current_exception());
+      }
+
+      void tick() noexcept {
+        try {
+          fn_();
+        } catch (...) {
+          stdexec::set_error(static_cast<Receiver&&>(receiver_), std::current_exception());
+          return;
+        }
+        start_timer();
+      }
+
+      void start() noexcept {
+        start_timer();
+      }
+    };
+
+    // Calls fn after every period until it is stopped.
+    template <class Scheduler, class Fn>
+    struct sender {
+      using sender_concept = stdexec::sender_t;
+
+      using completion_signatures = stdexec::completion_signatures<
+        stdexec::set_value_t(),
+        stdexec::set_error_t(std::exception_ptr),
+        stdexec::set_stopped_t()>;
+
+      Scheduler scheduler_;
+      exec::duration_of_t<Scheduler> period_;
+      Fn fn_;
+
+      template <stdexec::receiver_of<completion_signatures> Receiver>
+      auto connect(Receiver receiver) const -> operation<Scheduler, Fn, Receiver> {
+        return {scheduler_, period_, fn_, static_cast<Receiver&&>(receiver)};
+      }
+    };
+  }
+
+  // Calls fn with a snapshot of the statistics of pool after every period until stopped.
+  template <exec::timed_scheduler Scheduler, class Fn>
+    requires std::invocable<Fn&, memory_pool_statistics>
+  auto report_statistics(
+    memory_pool& pool,
+    Scheduler scheduler,
+    exec::duration_of_t<Scheduler> period,
+    Fn fn) {
+    auto report = [&pool, fn = static_cast<Fn&&>(fn)]() mutable {
+      fn(pool.statistics());
+    };
+    return periodic_::sender<Scheduler, decltype(report)>{
+      static_cast<Scheduler&&>(scheduler), period, static_cast<decltype(report)&&>(report)};
+  }
+
+  // Checks the pool after every period and trims each free list down to max_cached_blocks once
+  // a whole period passed without an allocation from that list.
+  template <exec::timed_scheduler Scheduler>
+  auto trim_when_idle(
+    memory_pool& pool,
+    Scheduler scheduler,
+    exec::duration_of_t<Scheduler> period,
+    std::size_t max_cached_blocks) {
+    auto trim = [&pool, max_cached_blocks] {
+      pool.trim_if_idle(max_cached_blocks);
+    };
+    return periodic_::sender<Scheduler, decltype(trim)>{
+      static_cast<Scheduler&&>(scheduler), period, trim};
+  }
+
 } // namespace sio
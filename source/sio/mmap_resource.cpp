@@ -0,0 +1,152 @@
+#include "./mmap_resource.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace sio {
+  namespace {
+    constexpr std::size_t huge_page_size = std::size_t{2} << 20;
+
+    std::size_t round_up(std::size_t size, std::size_t alignment) noexcept {
+      return (size + alignment - 1) / alignment * alignment;
+    }
+
+    // Maps size bytes at a huge page boundary, such that transparent huge pages can back the
+    // whole range. The mapping is one huge page larger than needed and trimmed at both ends.
+    void* map_huge_page_aligned(std::size_t size, int flags) noexcept {
+      const std::size_t mapped = size + huge_page_size;
+      void* data = ::mmap(nullptr, mapped, PROT_READ | PROT_WRITE, flags, -1, 0);
+      if (data == MAP_FAILED) {
+        return MAP_FAILED;
+      }
+      char* begin = static_cast<char*>(data);
+      char* aligned = reinterpret_cast<char*>(
+        round_up(reinterpret_cast<std::uintptr_t>(begin), huge_page_size));
+      if (aligned != begin) {
+        ::munmap(begin, static_cast<std::size_t>(aligned - begin));
+      }
+      char* end = begin + mapped;
+      if (aligned + size != end) {
+        ::munmap(aligned + size, static_cast<std::size_t>(end - (aligned + size)));
+      }
+      return aligned;
+    }
+
+    // Faults in a mapping after the huge page hint was given.
+    void populate(void* data, std::size_t size, std::size_t page_size) noexcept {
+#ifdef MADV_POPULATE_WRITE
+      if (::madvise(data, size, MADV_POPULATE_WRITE) == 0) {
+        return;
+      }
+#endif
+      for (std::size_t offset = 0; offset < size; offset += page_size) {
+        static_cast<volatile char*>(data)[offset] = 0;
+      }
+    }
+  }
+
+  mmap_arena_resource::mmap_arena_resource(mmap_resource_options options) noexcept
+    : options_{options}
+    , page_size_{static_cast<std::size_t>(::sysconf(_SC_PAGESIZE))} {
+    const std::size_t granularity =
+      options_.pages == huge_pages::none ? page_size_ : huge_page_size;
+    options_.chunk_size = round_up(std::max(options_.chunk_size, granularity), granularity);
+  }
+
+  mmap_arena_resource::~mmap_arena_resource() {
+    for (mapping& chunk: chunks_) {
+      ::munmap(chunk.data, chunk.size);
+    }
+  }
+
+  std::size_t mmap_arena_resource::mapped_bytes() const noexcept {
+    std::scoped_lock lock{mutex_};
+    return mapped_bytes_;
+  }
+
+  void* mmap_arena_resource::map(std::size_t size) noexcept {
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+    if (options_.populate) {
+      flags |= MAP_POPULATE;
+    }
+    void* data = MAP_FAILED;
+    if (options_.pages == huge_pages::explicit_ && size % huge_page_size == 0) {
+      data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, flags | MAP_HUGETLB, -1, 0);
+    }
+    if (data == MAP_FAILED && options_.pages == huge_pages::none) {
+      data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, flags, -1, 0);
+      if (data == MAP_FAILED) {
+        return nullptr;
+      }
+    } else if (data == MAP_FAILED) {
+      // The pages are faulted in after the hint, so MAP_POPULATE is not passed here.
+      data = map_huge_page_aligned(size, flags & ~MAP_POPULATE);
+      if (data == MAP_FAILED) {
+        return nullptr;
+      }
+      // This is only a hint and the mapping is usable if it fails.
+      ::madvise(data, size, MADV_HUGEPAGE);
+      if (options_.populate) {
+        populate(data, size, page_size_);
+      }
+    }
+    if (options_.lock && ::mlock(data, size) == -1) {
+      ::munmap(data, size);
+      return nullptr;
+    }
+    mapped_bytes_ += size;
+    return data;
+  }
+
+  void mmap_arena_resource::unmap(void* data, std::size_t size) noexcept {
+    ::munmap(data, size);
+    mapped_bytes_ -= size;
+  }
+
+  std::size_t mmap_arena_resource::dedicated_size(std::size_t bytes) const noexcept {
+    const std::size_t granularity =
+      options_.pages == huge_pages::none ? page_size_ : huge_page_size;
+    return round_up(bytes, granularity);
+  }
+
+  void* mmap_arena_resource::do_allocate(std::size_t bytes, std::size_t alignment) noexcept {
+    if (alignment > page_size_ || (alignment & (alignment - 1))) {
+      return nullptr;
+    }
+    std::scoped_lock lock{mutex_};
+    if (bytes > options_.chunk_size / 4) {
+      // Large allocations are page aligned by mmap and are unmapped again on deallocation.
+      return map(dedicated_size(bytes));
+    }
+    auto aligned = [&] {
+      const std::uintptr_t address = reinterpret_cast<std::uintptr_t>(current_);
+      return reinterpret_cast<char*>(round_up(address, alignment));
+    };
+    if (!current_ || static_cast<std::size_t>(end_ - aligned()) < bytes) {
+      void* chunk = map(options_.chunk_size);
+      if (!chunk) {
+        return nullptr;
+      }
+      chunks_.push_back(mapping{chunk, options_.chunk_size});
+      current_ = static_cast<char*>(chunk);
+      end_ = current_ + options_.chunk_size;
+    }
+    char* result = aligned();
+    current_ = result + bytes;
+    return result;
+  }
+
+  void mmap_arena_resource::do_deallocate(void* ptr, std::size_t bytes, std::size_t) noexcept {
+    if (bytes > options_.chunk_size / 4) {
+      std::scoped_lock lock{mutex_};
+      unmap(ptr, dedicated_size(bytes));
+    }
+  }
+
+  bool mmap_arena_resource::do_is_equal(const memory_resource& other) const noexcept {
+    return this == &other;
+  }
+}
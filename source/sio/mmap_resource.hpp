@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2024 Maikel Nadolski
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "./memory_pool.hpp"
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+namespace sio {
+  enum class huge_pages {
+    // Use the regular page size.
+    none,
+    // Ask for transparent huge pages with madvise(MADV_HUGEPAGE). Mappings are aligned to the
+    // huge page size, such that they can be backed by huge pages completely.
+    transparent,
+    // Map chunks with MAP_HUGETLB. Falls back to transparent huge pages if the system has no
+    // huge pages reserved.
+    explicit_,
+  };
+
+  struct mmap_resource_options {
+    // Memory is mapped in chunks of this size. Allocations that do not fit into a chunk get a
+    // mapping of their own.
+    std::size_t chunk_size = std::size_t{2} << 20;
+    huge_pages pages = huge_pages::none;
+    // Pre-fault every chunk with MAP_POPULATE.
+    bool populate = false;
+    // Lock every chunk into memory with mlock. Allocations fail if the lock fails.
+    bool lock = false;
+  };
+
+  // An arena that hands out memory from anonymous mappings. Memory of a chunk is only returned
+  // to the system when the resource is destroyed, which suits it as the upstream resource of a
+  // memory_pool. Alignments up to the page size are supported.
+  class mmap_arena_resource : public memory_resource {
+   public:
+    explicit mmap_arena_resource(mmap_resource_options options = {}) noexcept;
+    mmap_arena_resource(const mmap_arena_resource&) = delete;
+    mmap_arena_resource& operator=(const mmap_arena_resource&) = delete;
+    ~mmap_arena_resource() override;
+
+    // The total number of bytes that are currently mapped.
+    std::size_t mapped_bytes() const noexcept;
+
+   private:
+    struct mapping {
+      void* data;
+      std::size_t size;
+    };
+
+    mmap_resource_options options_;
+    std::size_t page_size_;
+    mutable std::mutex mutex_{};
+    std::vector<mapping> chunks_{};
+    std::size_t mapped_bytes_{};
+    char* current_{};
+    char* end_{};
+
+    void* map(std::size_t size) noexcept;
+
+    void unmap(void* data, std::size_t size) noexcept;
+
+    std::size_t dedicated_size(std::size_t bytes) const noexcept;
+
+    void* do_allocate(std::size_t bytes, std::size_t alignment) noexcept override;
+
+    void do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) noexcept override;
+
+    bool do_is_equal(const memory_resource& other) const noexcept override;
+  };
+}
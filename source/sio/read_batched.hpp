@@ -1,5 +1,7 @@
 #pragma once
 
+#include "./async_allocator.hpp"
+#include "./concepts.hpp"
 #include "./io_concepts.hpp"
 #include "./sequence/fork.hpp"
 #include "./sequence/ignore_all.hpp"
@@ -7,9 +9,208 @@
 #include "./sequence/let_value_each.hpp"
 #include "./sequence/zip.hpp"
 
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <optional>
 #include <span>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include <stdexec/execution.hpp>
+#include <stdexec/__detail/__transform_completion_signatures.hpp>
 
 namespace sio::async {
+  namespace read_batched_ {
+    template <class ByteStream>
+    using read_sender_t = decltype(async::read(
+      std::declval<const ByteStream&>(),
+      std::declval<buffer_type_of_t<ByteStream>>(),
+      std::declval<offset_type_of_t<ByteStream>>()));
+
+    template <class Receiver>
+    using allocator_of_t =
+      decltype(async::get_allocator(std::declval<stdexec::env_of_t<Receiver>>()));
+
+    template <class ByteStream, class Receiver>
+    using errors_variant_t = stdexec::__mapply<
+      stdexec::__mtransform<
+        stdexec::__q<std::decay_t>,
+        stdexec::__q<stdexec::__nullable_std_variant>>,
+      stdexec::__minvoke<
+        stdexec::__mconcat<stdexec::__q<stdexec::__types>>,
+        stdexec::__types<std::exception_ptr>,
+        stdexec::error_types_of_t<
+          read_sender_t<ByteStream>,
+          stdexec::env_of_t<Receiver>,
+          stdexec::__types>>>;
+
+    template <class Receiver>
+    struct error_visitor {
+      Receiver* receiver_;
+
+      template <class Error>
+      void operator()(Error&& error) const noexcept {
+        if constexpr (stdexec::__not_decays_to<Error, std::monostate>) {
+          stdexec::set_error(static_cast<Receiver&&>(*receiver_), static_cast<Error&&>(error));
+        }
+      }
+    };
+
+    template <class ByteStream, class Receiver>
+    struct chunk_operation_base;
+
+    template <class ByteStream, class Receiver>
+    struct chunk_receiver {
+      using receiver_concept = stdexec::receiver_t;
+
+      chunk_operation_base<ByteStream, Receiver>* op_;
+
+      template <class... Args>
+      void set_value(Args&&...) && noexcept {
+        op_->release(1);
+      }
+
+      template <class Error>
+      void set_error(Error&& error) && noexcept {
+        op_->notify_error(static_cast<Error&&>(error));
+        op_->release(1);
+      }
+
+      void set_stopped() && noexcept {
+        op_->stopped_.store(true, std::memory_order_relaxed);
+        op_->release(1);
+      }
+
+      auto get_env() const noexcept -> stdexec::env_of_t<Receiver> {
+        return stdexec::get_env(op_->rcvr_);
+      }
+    };
+
+    // Issues all reads of a chunk at once. Their operation states live in one array from the
+    // environment allocator, which has to allocate without suspending. The chunk completes
+    // once every read completed, with the first error if there was one.
+    template <class ByteStream, class Receiver>
+    struct chunk_operation_base {
+      using read_op_t =
+        stdexec::connect_result_t<read_sender_t<ByteStream>, chunk_receiver<ByteStream, Receiver>>;
+      using slot_t = std::optional<read_op_t>;
+      using allocator_t =
+        typename std::allocator_traits<allocator_of_t<Receiver>>::template rebind_alloc<slot_t>;
+      using errors_variant = errors_variant_t<ByteStream, Receiver>;
+
+      static_assert(
+        sync_array_allocator<allocator_t>,
+        "read_batched needs an allocator that allocates without suspending");
+
+      ByteStream stream_;
+      std::span<buffer_type_of_t<ByteStream>> buffers_;
+      std::span<offset_type_of_t<ByteStream>> offsets_;
+      [[no_unique_address]] Receiver rcvr_;
+      slot_t* ops_{};
+      std::atomic<std::size_t> n_pending_{0};
+      std::atomic<int> error_emplaced_{0};
+      std::atomic<bool> stopped_{false};
+      errors_variant errors_{};
+
+      allocator_t allocator() const noexcept {
+        return allocator_t(async::get_allocator(stdexec::get_env(rcvr_)));
+      }
+
+      void start_reads() noexcept {
+        const std::size_t n_reads = buffers_.size();
+        if (n_reads == 0) {
+          stdexec::set_value(static_cast<Receiver&&>(rcvr_));
+          return;
+        }
+        try {
+          ops_ = async::sync_allocate(allocator(), n_reads);
+        } catch (...) {
+          stdexec::set_error(static_cast<Receiver&&>(rcvr_), std::current_exception());
+          return;
+        }
+        std::uninitialized_default_construct_n(ops_, n_reads);
+        // Every read holds a reference and so does this loop, such that the chunk does not
+        // complete before all reads were started.
+        n_pending_.store(n_reads + 1, std::memory_order_relaxed);
+        for (std::size_t index = 0; index < n_reads; ++index) {
+          try {
+            auto& op = ops_[index].emplace(stdexec::__emplace_from{[&] {
+              return stdexec::connect(
+                async::read(stream_, buffers_[index], offsets_[index]),
+                chunk_receiver<ByteStream, Receiver>{this});
+            }});
+            stdexec::start(op);
+          } catch (...) {
+            notify_error(std::current_exception());
+            release(n_reads - index + 1);
+            return;
+          }
+        }
+        release(1);
+      }
+
+      template <class Error>
+        requires emplaceable<errors_variant, std::decay_t<Error>, Error>
+      void notify_error(Error&& error) noexcept {
+        int expected = 0;
+        if (error_emplaced_.compare_exchange_strong(expected, 1, std::memory_order_relaxed)) {
+          errors_.template emplace<std::decay_t<Error>>(static_cast<Error&&>(error));
+          error_emplaced_.store(2, std::memory_order_release);
+        }
+      }
+
+      void release(std::size_t n) noexcept {
+        if (n_pending_.fetch_sub(n, std::memory_order_acq_rel) == n) {
+          complete();
+        }
+      }
+
+      void complete() noexcept {
+        std::destroy_n(ops_, buffers_.size());
+        async::sync_deallocate(allocator(), ops_, buffers_.size());
+        if (error_emplaced_.load(std::memory_order_acquire) == 2) {
+          std::visit(error_visitor<Receiver>{&rcvr_}, static_cast<errors_variant&&>(errors_));
+        } else if (stopped_.load(std::memory_order_relaxed)) {
+          stdexec::set_stopped(static_cast<Receiver&&>(rcvr_));
+        } else {
+          stdexec::set_value(static_cast<Receiver&&>(rcvr_));
+        }
+      }
+    };
+
+    template <class ByteStream, class Receiver>
+    struct chunk_operation : chunk_operation_base<ByteStream, Receiver> {
+      void start() noexcept {
+        this->start_reads();
+      }
+    };
+
+    template <class ByteStream>
+    struct chunk_sender {
+      using sender_concept = stdexec::sender_t;
+
+      ByteStream stream_;
+      std::span<buffer_type_of_t<ByteStream>> buffers_;
+      std::span<offset_type_of_t<ByteStream>> offsets_;
+
+      template <class Env>
+      auto get_completion_signatures(Env&&) const noexcept
+        -> stdexec::transform_completion_signatures_of<
+          read_sender_t<ByteStream>,
+          Env,
+          stdexec::completion_signatures<stdexec::set_error_t(std::exception_ptr)>,
+          stdexec::__mconst<stdexec::completion_signatures<stdexec::set_value_t()>>::__f>;
+
+      template <class Receiver>
+      auto connect(Receiver rcvr) const -> chunk_operation<ByteStream, Receiver> {
+        return {{stream_, buffers_, offsets_, static_cast<Receiver&&>(rcvr)}};
+      }
+    };
+  }
+
   template <seekable_byte_stream ByteStream>
   auto read_batched(
     ByteStream stream,
@@ -24,4 +225,23 @@ namespace sio::async {
         })
       | ignore_all();
   }
+
+  // Like read_batched, but forks one item per chunk of up to chunk reads instead of one item
+  // per read. The reads of a chunk are issued together.
+  template <seekable_byte_stream ByteStream>
+  auto read_batched(
+    ByteStream stream,
+    std::span<buffer_type_of_t<ByteStream>> buffers,
+    std::span<offset_type_of_t<ByteStream>> offsets,
+    std::size_t chunk) {
+    return                                                                  //
+      zip(iterate_chunked(buffers, chunk), iterate_chunked(offsets, chunk)) //
+      | fork()                                                              //
+      | let_value_each([stream](
+                         std::span<buffer_type_of_t<ByteStream>> buffers,
+                         std::span<offset_type_of_t<ByteStream>> offsets) {
+          return read_batched_::chunk_sender<ByteStream>{stream, buffers, offsets};
+        })
+      | ignore_all();
+  }
 }
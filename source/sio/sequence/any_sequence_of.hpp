@@ -15,8 +15,283 @@
  */
 #pragma once
 
-#include "exec/sequence/any_sequence_of.hpp"
+#include "../any_sender_of.hpp"
+
+#include <exec/sequence_senders.hpp>
+#include <stdexec/__detail/__transform_completion_signatures.hpp>
 
 namespace sio {
-  using exec::any_sequence_receiver_ref;
+  namespace any_ {
+    template <std::size_t InlineSize>
+    using next_sender_t = any_sender_of<
+      stdexec::completion_signatures<stdexec::set_value_t(), stdexec::set_stopped_t()>,
+      InlineSize>;
+
+    template <class ItemSigs, class Sigs, std::size_t InlineSize>
+    struct sequence_receiver_vtable {
+      using item_t = any_sender_of<ItemSigs, InlineSize>;
+
+      completion_vtable<Sigs> completions_;
+      next_sender_t<InlineSize> (*set_next_)(void* op, item_t&& item, memory_resource* resource);
+    };
+
+    // The receiver that erased sequences are subscribed with. Every item is erased to an
+    // any_sender_of<ItemSigs> and so is the sender that set_next returns. Both are allocated
+    // from resource_ when they do not fit inline.
+    template <class ItemSigs, class Sigs, std::size_t InlineSize>
+    struct sequence_receiver_ref {
+      using receiver_concept = stdexec::receiver_t;
+      using vtable_t = sequence_receiver_vtable<ItemSigs, Sigs, InlineSize>;
+      using completions_t = completion_vtable<Sigs>;
+      using item_t = any_sender_of<ItemSigs, InlineSize>;
+
+      const vtable_t* vtable_;
+      void* op_;
+      stdexec::inplace_stop_token token_;
+      memory_resource* resource_;
+
+      template <class Item>
+        requires constructible_from<item_t, Item>
+      friend auto tag_invoke(exec::set_next_t, sequence_receiver_ref& self, Item&& item)
+        -> next_sender_t<InlineSize> {
+        return self.vtable_->set_next_(
+          self.op_,
+          item_t{
+            std::allocator_arg,
+            resource_allocator<char>{self.resource_},
+            static_cast<Item&&>(item)},
+          self.resource_);
+      }
+
+      void set_value() && noexcept
+        requires callable<const completions_t&, void*, stdexec::set_value_t>
+      {
+        vtable_->completions_(op_, stdexec::set_value_t{});
+      }
+
+      template <class Error>
+        requires callable<const completions_t&, void*, stdexec::set_error_t, Error>
+      void set_error(Error&& error) && noexcept {
+        vtable_->completions_(op_, stdexec::set_error_t{}, static_cast<Error&&>(error));
+      }
+
+      void set_stopped() && noexcept
+        requires callable<const completions_t&, void*, stdexec::set_stopped_t>
+      {
+        vtable_->completions_(op_, stdexec::set_stopped_t{});
+      }
+
+      auto get_env() const noexcept {
+        return exec::make_env(
+          exec::with(stdexec::get_stop_token, token_),
+          exec::with(async::get_allocator, resource_allocator<char>{resource_}));
+      }
+    };
+
+    template <class ItemSigs, class Sigs, std::size_t InlineSize, class Op>
+    inline constexpr sequence_receiver_vtable<ItemSigs, Sigs, InlineSize> sequence_receiver_vtable_for{
+      make_completion_vtable<Op>(static_cast<Sigs*>(nullptr)),
+      [](void* op, any_sender_of<ItemSigs, InlineSize>&& item, memory_resource* resource)
+        -> next_sender_t<InlineSize> {
+        return {
+          std::allocator_arg,
+          resource_allocator<char>{resource},
+          exec::set_next(
+            static_cast<Op*>(op)->rcvr_, static_cast<any_sender_of<ItemSigs, InlineSize>&&>(item))};
+      }};
+
+    template <class Receiver, class Sig>
+    struct receiver_completion;
+
+    template <class Receiver, class Tag, class... Args>
+    struct receiver_completion<Receiver, Tag(Args...)> {
+      static void complete(void* rcvr, Args&&... args) noexcept {
+        Tag{}(static_cast<Receiver&&>(*static_cast<Receiver*>(rcvr)), static_cast<Args&&>(args)...);
+      }
+    };
+
+    template <class Receiver, class... Sigs>
+    constexpr auto make_receiver_vtable(stdexec::completion_signatures<Sigs...>*) noexcept
+      -> completion_vtable<stdexec::completion_signatures<Sigs...>> {
+      return {completion_entry<Sigs>{&receiver_completion<Receiver, Sigs>::complete}...};
+    }
+
+    // Like sequence_receiver_vtable_for, but for references that point to the receiver itself.
+    template <class ItemSigs, class Sigs, std::size_t InlineSize, class Receiver>
+    inline constexpr sequence_receiver_vtable<ItemSigs, Sigs, InlineSize> receiver_vtable_for{
+      make_receiver_vtable<Receiver>(static_cast<Sigs*>(nullptr)),
+      [](void* rcvr, any_sender_of<ItemSigs, InlineSize>&& item, memory_resource* resource)
+        -> next_sender_t<InlineSize> {
+        return {
+          std::allocator_arg,
+          resource_allocator<char>{resource},
+          exec::set_next(
+            *static_cast<Receiver*>(rcvr),
+            static_cast<any_sender_of<ItemSigs, InlineSize>&&>(item))};
+      }};
+
+    template <class Env>
+    concept inplace_stoppable_env = //
+      stdexec::unstoppable_token<stdexec::stop_token_of_t<Env>>
+      || std::same_as<stdexec::stop_token_of_t<Env>, stdexec::inplace_stop_token>;
+
+    template <class Env>
+    stdexec::inplace_stop_token inplace_stop_token_of(const Env& env) noexcept {
+      if constexpr (stdexec::unstoppable_token<stdexec::stop_token_of_t<Env>>) {
+        return {};
+      } else {
+        return stdexec::get_stop_token(env);
+      }
+    }
+
+    // The completions of a sequence whose items complete with Sigs.
+    template <class Sigs>
+    using sequence_completions_t = stdexec::transform_completion_signatures<
+      Sigs,
+      stdexec::completion_signatures<stdexec::set_value_t()>,
+      stdexec::__mconst<stdexec::completion_signatures<>>::__f>;
+
+    template <class ItemSigs, class Sigs, std::size_t InlineSize>
+    struct sequence_vtable {
+      using receiver_t = sequence_receiver_ref<ItemSigs, Sigs, InlineSize>;
+
+      void (*subscribe_)(void* seq, storage<InlineSize>& op, receiver_t rcvr, memory_resource*);
+      void (*start_)(void* op) noexcept;
+    };
+
+    template <class Sequence, class ItemSigs, class Sigs, std::size_t InlineSize>
+    inline constexpr sequence_vtable<ItemSigs, Sigs, InlineSize> sequence_vtable_for{
+      [](
+        void* seq,
+        storage<InlineSize>& op,
+        sequence_receiver_ref<ItemSigs, Sigs, InlineSize> rcvr,
+        memory_resource* resource) {
+        using op_t =
+          exec::subscribe_result_t<Sequence, sequence_receiver_ref<ItemSigs, Sigs, InlineSize>>;
+        op.template emplace_from<op_t>(resource, [&] {
+          return exec::subscribe(static_cast<Sequence&&>(*static_cast<Sequence*>(seq)), rcvr);
+        });
+      },
+      [](void* op) noexcept {
+        using op_t =
+          exec::subscribe_result_t<Sequence, sequence_receiver_ref<ItemSigs, Sigs, InlineSize>>;
+        stdexec::start(*static_cast<op_t*>(op));
+      }};
+
+    template <class ItemSigs, class Sigs, std::size_t InlineSize, class Receiver>
+    struct sequence_operation : operation_base<Receiver> {
+      storage<InlineSize> op_{};
+      void (*start_)(void*) noexcept;
+
+      sequence_operation(
+        void* seq,
+        const sequence_vtable<ItemSigs, Sigs, InlineSize>* vtable,
+        Receiver rcvr)
+        : operation_base<Receiver>{static_cast<Receiver&&>(rcvr)}
+        , start_{vtable->start_} {
+        vtable->subscribe_(
+          seq,
+          op_,
+          sequence_receiver_ref<ItemSigs, Sigs, InlineSize>{
+            &sequence_receiver_vtable_for<ItemSigs, Sigs, InlineSize, sequence_operation>,
+            this,
+            this->stop_source_.get_token(),
+            this->resource()},
+          this->resource());
+      }
+
+      void start() noexcept {
+        this->forward_stop_requests();
+        start_(op_.get());
+      }
+    };
+  }
+
+  // A move-only sequence sender that erases the type of a sequence whose items complete with
+  // ItemSigs. Items are passed on as any_sender_of<ItemSigs, InlineSize>. Storage works as for
+  // any_sender_of.
+  template <
+    class ItemSigs,
+    class Sigs = stdexec::completion_signatures<
+      stdexec::set_value_t(),
+      stdexec::set_error_t(std::exception_ptr),
+      stdexec::set_stopped_t()>,
+    std::size_t InlineSize = 8 * sizeof(void*)>
+  class any_sequence_of {
+   public:
+    using sender_concept = exec::sequence_sender_t;
+    using completion_signatures = Sigs;
+    using item_sender = any_sender_of<ItemSigs, InlineSize>;
+
+    template <class Sequence>
+      requires(!decays_to<Sequence, any_sequence_of>)
+           && exec::sequence_sender_to<
+                decay_t<Sequence>,
+                any_::sequence_receiver_ref<ItemSigs, Sigs, InlineSize>>
+    any_sequence_of(Sequence&& seq)
+      : vtable_{&any_::sequence_vtable_for<decay_t<Sequence>, ItemSigs, Sigs, InlineSize>} {
+      sequence_.template emplace_from<decay_t<Sequence>>(get_default_resource(), [&] {
+        return decay_t<Sequence>(static_cast<Sequence&&>(seq));
+      });
+    }
+
+    any_sequence_of(any_sequence_of&& other) noexcept
+      : vtable_{other.vtable_} {
+      sequence_.move_from(other.sequence_);
+    }
+
+    any_sequence_of& operator=(any_sequence_of&& other) noexcept {
+      if (this != &other) {
+        sequence_.reset();
+        sequence_.move_from(other.sequence_);
+        vtable_ = other.vtable_;
+      }
+      return *this;
+    }
+
+    template <class Receiver>
+    friend auto tag_invoke(exec::subscribe_t, any_sequence_of&& self, Receiver rcvr)
+      -> any_::sequence_operation<ItemSigs, Sigs, InlineSize, Receiver> {
+      SIO_ASSERT(self.sequence_.get());
+      return {self.sequence_.get(), self.vtable_, static_cast<Receiver&&>(rcvr)};
+    }
+
+    template <class Env>
+    friend auto tag_invoke(exec::get_item_types_t, const any_sequence_of&, Env&&) noexcept
+      -> exec::item_types<item_sender> {
+      return {};
+    }
+
+   private:
+    any_::storage<InlineSize> sequence_{};
+    const any_::sequence_vtable<ItemSigs, Sigs, InlineSize>* vtable_;
+  };
+
+  // A type-erased reference to a sequence receiver whose items complete with Sigs. Items and
+  // the senders that set_next returns are erased to any_sender_of and allocated from the
+  // allocator in the environment of the referenced receiver. Of that environment only the stop
+  // token and the allocator, erased to a resource_allocator, are forwarded.
+  template <class Sigs, std::size_t InlineSize = 8 * sizeof(void*)>
+  class any_sequence_receiver_ref
+    : public any_::sequence_receiver_ref<Sigs, any_::sequence_completions_t<Sigs>, InlineSize> {
+    using completions_t = any_::sequence_completions_t<Sigs>;
+    using base_t = any_::sequence_receiver_ref<Sigs, completions_t, InlineSize>;
+
+   public:
+    // Sender queries are not supported.
+    template <class... SenderQueries>
+      requires(sizeof...(SenderQueries) == 0)
+    using any_sender = any_sequence_of<Sigs, completions_t, InlineSize>;
+
+    template <class Receiver>
+      requires(!decays_to<Receiver, any_sequence_receiver_ref>)
+           && any_::inplace_stoppable_env<stdexec::env_of_t<Receiver>>
+    any_sequence_receiver_ref(Receiver& rcvr) noexcept
+      : base_t{
+        &any_::receiver_vtable_for<Sigs, completions_t, InlineSize, Receiver>,
+        &rcvr,
+        any_::inplace_stop_token_of(stdexec::get_env(rcvr)),
+        any_::resource_of(async::get_allocator(stdexec::get_env(rcvr)))} {
+    }
+  };
 }
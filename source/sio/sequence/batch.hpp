@@ -0,0 +1,617 @@
+/*
+ * Copyright (c) 2024 Maikel Nadolski
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "./sequence_concepts.hpp"
+#include "../assert.hpp"
+#include "../async_allocator.hpp"
+#include "../concepts.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include <stdexec/execution.hpp>
+#include <exec/__detail/__basic_sequence.hpp>
+#include <exec/env.hpp>
+#include <exec/sequence_senders.hpp>
+#include <exec/timed_scheduler.hpp>
+
+namespace sio {
+  namespace batch_ {
+    using namespace stdexec;
+
+    struct options {
+      std::size_t max_items_;
+      std::chrono::nanoseconds max_delay_;
+    };
+
+    template <class Env>
+    using env_t = decltype(exec::make_env(
+      __declval<Env>(),
+      exec::with(get_stop_token, __declval<inplace_stop_token>())));
+
+    template <class Sequence, class Env>
+    using item_t = exec::item_sender_t<exec::item_types_of_t<Sequence, env_t<Env>>>;
+
+    template <class Sequence, class Env>
+    using value_t = decay_t<__single_sender_value_t<item_t<Sequence, Env>, env_t<Env>>>;
+
+    template <class Env>
+    using allocator_of_t = decltype(async::get_allocator(__declval<Env>()));
+
+    // Batches are plain std::vectors unless an allocator is installed in the environment.
+    template <class Tp, class Alloc>
+    struct vector_for {
+      using type = std::vector<Tp, async::std_allocator<Tp, Alloc>>;
+    };
+
+    template <class Tp, class S>
+    struct vector_for<Tp, async::new_delete_allocator<S>> {
+      using type = std::vector<Tp>;
+    };
+
+    template <class Tp, class Env>
+    using vector_t = typename vector_for<Tp, allocator_of_t<Env>>::type;
+
+    template <class Tp, class Env>
+    using batch_sender_t = decltype(stdexec::just(std::declval<vector_t<Tp, Env>>()));
+
+    template <class Env>
+    using scheduler_t = decay_t<__call_result_t<get_scheduler_t, Env>>;
+
+    template <class Scheduler>
+    using timer_sender_t = decltype(exec::schedule_at(
+      std::declval<Scheduler&>(), std::declval<exec::time_point_of_t<Scheduler>>()));
+
+    template <class Env, class Sequence>
+    using error_types_t = __minvoke<
+      __mconcat<__q<__types>>,
+      __types<std::exception_ptr>,
+      error_types_of_t<Sequence, env_t<Env>, __types>,
+      error_types_of_t<item_t<Sequence, Env>, env_t<Env>, __types>>;
+
+    template <class Error>
+    using as_error_signature = set_error_t(decay_t<Error>);
+
+    struct on_stop_requested {
+      inplace_stop_source& stop_source_;
+
+      void operator()() const noexcept {
+        stop_source_.request_stop();
+      }
+    };
+
+    template <class Receiver>
+    struct error_visitor {
+      Receiver* receiver_;
+
+      template <class Error>
+      void operator()(Error&& error) const noexcept {
+        if constexpr (__not_decays_to<Error, std::monostate>) {
+          stdexec::set_error(static_cast<Receiver&&>(*receiver_), static_cast<Error&&>(error));
+        }
+      }
+    };
+
+    template <class Receiver, class Tp, class ErrorsVariant>
+    struct operation_base;
+
+    template <class Receiver, class Tp, class ErrorsVariant>
+    struct timer_receiver {
+      using receiver_concept = stdexec::receiver_t;
+
+      operation_base<Receiver, Tp, ErrorsVariant>* op_;
+
+      void set_value() && noexcept {
+        op_->flush_or_finish();
+      }
+
+      template <class Error>
+      void set_error(Error&& error) && noexcept {
+        if constexpr (std::same_as<decay_t<Error>, std::exception_ptr>) {
+          op_->notify_error(static_cast<Error&&>(error));
+        } else {
+          op_->notify_error(std::make_exception_ptr(static_cast<Error&&>(error)));
+        }
+        op_->flush_or_finish();
+      }
+
+      void set_stopped() && noexcept {
+        op_->flush_or_finish();
+      }
+
+      auto get_env() const noexcept -> env_t<env_of_t<Receiver>> {
+        return exec::make_env(
+          stdexec::get_env(op_->receiver_),
+          exec::with(get_stop_token, op_->timer_stop_source_.get_token()));
+      }
+    };
+
+    template <class Receiver, class Tp, class ErrorsVariant>
+    struct flush_receiver {
+      using receiver_concept = stdexec::receiver_t;
+
+      operation_base<Receiver, Tp, ErrorsVariant>* op_;
+
+      void set_value() && noexcept {
+        op_->after_flush();
+      }
+
+      void set_stopped() && noexcept {
+        op_->stop_source_.request_stop();
+        op_->after_flush();
+      }
+
+      auto get_env() const noexcept -> env_t<env_of_t<Receiver>> {
+        return op_->get_env();
+      }
+    };
+
+    template <class Receiver, class Tp, class ErrorsVariant>
+    struct operation_base : __immovable {
+      using scheduler_t = batch_::scheduler_t<env_of_t<Receiver>>;
+      using vector_type = vector_t<Tp, env_of_t<Receiver>>;
+      using timer_op_t = connect_result_t<
+        timer_sender_t<scheduler_t>,
+        timer_receiver<Receiver, Tp, ErrorsVariant>>;
+      using flush_op_t = connect_result_t<
+        exec::next_sender_of_t<Receiver, batch_sender_t<Tp, env_of_t<Receiver>>>,
+        flush_receiver<Receiver, Tp, ErrorsVariant>>;
+      using on_stop =
+        typename stop_token_of_t<env_of_t<Receiver>>::template callback_type<on_stop_requested>;
+
+      [[no_unique_address]] Receiver receiver_;
+      options options_;
+      [[no_unique_address]] ErrorsVariant errors_{};
+      std::atomic<int> error_emplaced_{0};
+      // One reference for the input sequence and one for the timer and the batches it flushes.
+      std::atomic<int> n_pending_{2};
+      inplace_stop_source stop_source_{};
+      inplace_stop_source timer_stop_source_{};
+      std::optional<on_stop> stop_callback_{};
+      std::mutex mutex_{};
+      vector_type batch_{make_batch()};
+      // When the current batch is due. It is set by the first value of a batch.
+      exec::time_point_of_t<scheduler_t> deadline_{};
+      // Set while the timer or a batch flushed by it is in flight. A non-empty batch always
+      // has a running timer. The timer may have been started for an earlier batch that was
+      // emitted because it was full. It then waits again until the deadline of the current
+      // batch.
+      bool timer_running_{false};
+      bool input_done_{false};
+      std::optional<timer_op_t> timer_op_{};
+      std::optional<flush_op_t> flush_op_{};
+
+      auto get_env() const noexcept -> env_t<env_of_t<Receiver>> {
+        return exec::make_env(
+          stdexec::get_env(receiver_), exec::with(get_stop_token, stop_source_.get_token()));
+      }
+
+      // Batches take their memory from the allocator in the environment of the receiver.
+      vector_type make_batch() const noexcept {
+        if constexpr (std::same_as<vector_type, std::vector<Tp>>) {
+          return {};
+        } else {
+          return vector_type(typename vector_type::allocator_type(
+            async::get_allocator(stdexec::get_env(receiver_))));
+        }
+      }
+
+      scheduler_t scheduler() const noexcept {
+        return stdexec::get_scheduler(stdexec::get_env(receiver_));
+      }
+
+      // Called with the lock held when the first value of a batch arrives.
+      void set_deadline() noexcept {
+        using duration_t = exec::duration_of_t<scheduler_t>;
+        deadline_ = exec::now(scheduler())
+                  + std::chrono::duration_cast<duration_t>(options_.max_delay_);
+      }
+
+      template <class Error>
+        requires emplaceable<ErrorsVariant, decay_t<Error>, Error>
+      void notify_error(Error&& error) noexcept {
+        int expected = 0;
+        if (error_emplaced_.compare_exchange_strong(expected, 1, std::memory_order_relaxed)) {
+          errors_.template emplace<decay_t<Error>>(static_cast<Error&&>(error));
+          error_emplaced_.store(2, std::memory_order_release);
+        }
+        stop_source_.request_stop();
+      }
+
+      // Fires at the given deadline, which the caller read under the lock.
+      void start_timer(exec::time_point_of_t<scheduler_t> deadline) noexcept {
+        try {
+          auto& op = timer_op_.emplace(stdexec::__emplace_from{[&] {
+            return stdexec::connect(
+              exec::schedule_at(scheduler(), deadline),
+              timer_receiver<Receiver, Tp, ErrorsVariant>{this});
+          }});
+          stdexec::start(op);
+        } catch (...) {
+          notify_error(std::current_exception());
+          flush_or_finish();
+        }
+      }
+
+      void flush(vector_type batch) noexcept {
+        try {
+          auto& op = flush_op_.emplace(stdexec::__emplace_from{[&] {
+            return stdexec::connect(
+              exec::set_next(receiver_, stdexec::just(std::move(batch))),
+              flush_receiver<Receiver, Tp, ErrorsVariant>{this});
+          }});
+          stdexec::start(op);
+        } catch (...) {
+          notify_error(std::current_exception());
+          flush_or_finish();
+        }
+      }
+
+      // Flushes the current batch when the timer fires. If the timer was started for an
+      // earlier batch, it waits again until the current batch is due. Once there is nothing
+      // left to flush, the timer stops until the next item arrives.
+      void flush_or_finish() noexcept {
+        std::unique_lock lock{mutex_};
+        if (batch_.empty() || stop_source_.stop_requested()) {
+          batch_.clear();
+          timer_running_ = false;
+          const bool input_done = input_done_;
+          lock.unlock();
+          if (input_done) {
+            release(1);
+          }
+          return;
+        }
+        if (!input_done_ && exec::now(scheduler()) < deadline_) {
+          const auto deadline = deadline_;
+          lock.unlock();
+          start_timer(deadline);
+          return;
+        }
+        vector_type batch = std::exchange(batch_, make_batch());
+        lock.unlock();
+        flush(std::move(batch));
+      }
+
+      void after_flush() noexcept {
+        std::unique_lock lock{mutex_};
+        if (!input_done_ && !stop_source_.stop_requested()) {
+          if (batch_.empty()) {
+            timer_running_ = false;
+            return;
+          }
+          const auto deadline = deadline_;
+          lock.unlock();
+          start_timer(deadline);
+          return;
+        }
+        lock.unlock();
+        flush_or_finish();
+      }
+
+      void on_input_done() noexcept {
+        std::unique_lock lock{mutex_};
+        input_done_ = true;
+        if (!timer_running_) {
+          lock.unlock();
+          release(2);
+          return;
+        }
+        lock.unlock();
+        // The timer flushes the last batch and releases its reference.
+        timer_stop_source_.request_stop();
+        release(1);
+      }
+
+      void release(int n) noexcept {
+        if (n_pending_.fetch_sub(n, std::memory_order_acq_rel) == n) {
+          stop_callback_.reset();
+          if (error_emplaced_.load(std::memory_order_acquire) == 2) {
+            std::visit(error_visitor<Receiver>{&receiver_}, static_cast<ErrorsVariant&&>(errors_));
+          } else {
+            exec::set_value_unless_stopped(static_cast<Receiver&&>(receiver_));
+          }
+        }
+      }
+    };
+
+    template <class ItemReceiver, class Receiver, class Tp, class ErrorsVariant>
+    struct item_operation_base;
+
+    template <class ItemReceiver, class Receiver, class Tp, class ErrorsVariant>
+    struct emit_receiver {
+      using receiver_concept = stdexec::receiver_t;
+
+      item_operation_base<ItemReceiver, Receiver, Tp, ErrorsVariant>* item_op_;
+
+      void set_value() && noexcept {
+        stdexec::set_value(static_cast<ItemReceiver&&>(item_op_->item_receiver_));
+      }
+
+      void set_stopped() && noexcept {
+        item_op_->op_->stop_source_.request_stop();
+        stdexec::set_stopped(static_cast<ItemReceiver&&>(item_op_->item_receiver_));
+      }
+
+      auto get_env() const noexcept -> env_t<env_of_t<Receiver>> {
+        return item_op_->op_->get_env();
+      }
+    };
+
+    template <class ItemReceiver, class Receiver, class Tp, class ErrorsVariant>
+    struct item_operation_base {
+      using vector_type = vector_t<Tp, env_of_t<Receiver>>;
+      using emit_op_t = connect_result_t<
+        exec::next_sender_of_t<Receiver, batch_sender_t<Tp, env_of_t<Receiver>>>,
+        emit_receiver<ItemReceiver, Receiver, Tp, ErrorsVariant>>;
+
+      [[no_unique_address]] ItemReceiver item_receiver_;
+      operation_base<Receiver, Tp, ErrorsVariant>* op_;
+      std::optional<emit_op_t> emit_op_{};
+
+      // Emits the batch that this item filled. The item completes with the emitted batch.
+      void emit(vector_type batch) noexcept {
+        try {
+          auto& op = emit_op_.emplace(stdexec::__emplace_from{[&] {
+            return stdexec::connect(
+              exec::set_next(op_->receiver_, stdexec::just(std::move(batch))),
+              emit_receiver<ItemReceiver, Receiver, Tp, ErrorsVariant>{this});
+          }});
+          stdexec::start(op);
+        } catch (...) {
+          op_->notify_error(std::current_exception());
+          stdexec::set_stopped(static_cast<ItemReceiver&&>(item_receiver_));
+        }
+      }
+    };
+
+    template <class ItemReceiver, class Receiver, class Tp, class ErrorsVariant>
+    struct item_receiver {
+      using receiver_concept = stdexec::receiver_t;
+
+      item_operation_base<ItemReceiver, Receiver, Tp, ErrorsVariant>* item_op_;
+
+      template <class... Args>
+      void set_value(Args&&... args) && noexcept {
+        operation_base<Receiver, Tp, ErrorsVariant>* op = item_op_->op_;
+        std::unique_lock lock{op->mutex_};
+        if (op->stop_source_.stop_requested()) {
+          lock.unlock();
+          stdexec::set_stopped(static_cast<ItemReceiver&&>(item_op_->item_receiver_));
+          return;
+        }
+        try {
+          if (op->batch_.empty()) {
+            op->batch_.reserve(op->options_.max_items_);
+            op->set_deadline();
+          }
+          op->batch_.emplace_back(static_cast<Args&&>(args)...);
+        } catch (...) {
+          lock.unlock();
+          op->notify_error(std::current_exception());
+          stdexec::set_stopped(static_cast<ItemReceiver&&>(item_op_->item_receiver_));
+          return;
+        }
+        using vector_type = typename operation_base<Receiver, Tp, ErrorsVariant>::vector_type;
+        std::optional<vector_type> full{};
+        bool start_timer = false;
+        if (op->batch_.size() >= op->options_.max_items_) {
+          full.emplace(std::exchange(op->batch_, op->make_batch()));
+        } else if (!op->timer_running_) {
+          op->timer_running_ = true;
+          start_timer = true;
+        }
+        const auto deadline = op->deadline_;
+        lock.unlock();
+        if (start_timer) {
+          op->start_timer(deadline);
+        }
+        if (full) {
+          item_op_->emit(std::move(*full));
+        } else {
+          stdexec::set_value(static_cast<ItemReceiver&&>(item_op_->item_receiver_));
+        }
+      }
+
+      void set_stopped() && noexcept {
+        item_op_->op_->stop_source_.request_stop();
+        stdexec::set_stopped(static_cast<ItemReceiver&&>(item_op_->item_receiver_));
+      }
+
+      template <class Error>
+      void set_error(Error&& error) && noexcept {
+        item_op_->op_->notify_error(static_cast<Error&&>(error));
+        stdexec::set_stopped(static_cast<ItemReceiver&&>(item_op_->item_receiver_));
+      }
+
+      auto get_env() const noexcept -> env_of_t<ItemReceiver> {
+        return stdexec::get_env(item_op_->item_receiver_);
+      }
+    };
+
+    template <class Item, class ItemReceiver, class Receiver, class Tp, class ErrorsVariant>
+    struct item_operation : item_operation_base<ItemReceiver, Receiver, Tp, ErrorsVariant> {
+      using base_t = item_operation_base<ItemReceiver, Receiver, Tp, ErrorsVariant>;
+      using item_receiver_t = item_receiver<ItemReceiver, Receiver, Tp, ErrorsVariant>;
+
+      connect_result_t<Item, item_receiver_t> item_op_;
+
+      item_operation(
+        Item&& item,
+        ItemReceiver item_rcvr,
+        operation_base<Receiver, Tp, ErrorsVariant>* op)
+        : base_t{static_cast<ItemReceiver&&>(item_rcvr), op}
+        , item_op_{stdexec::connect(static_cast<Item&&>(item), item_receiver_t{this})} {
+      }
+
+      void start() noexcept {
+        stdexec::start(item_op_);
+      }
+    };
+
+    template <class Item, class Receiver, class Tp, class ErrorsVariant>
+    struct item_sender {
+      using sender_concept = stdexec::sender_t;
+      using completion_signatures =
+        stdexec::completion_signatures<set_value_t(), set_stopped_t()>;
+
+      Item item_;
+      operation_base<Receiver, Tp, ErrorsVariant>* op_;
+
+      template <class ItemReceiver>
+      auto connect(ItemReceiver item_rcvr)
+        -> item_operation<Item, ItemReceiver, Receiver, Tp, ErrorsVariant> {
+        return {static_cast<Item&&>(item_), static_cast<ItemReceiver&&>(item_rcvr), op_};
+      }
+    };
+
+    template <class Receiver, class Tp, class ErrorsVariant>
+    struct receiver {
+      using receiver_concept = stdexec::receiver_t;
+
+      operation_base<Receiver, Tp, ErrorsVariant>* op_;
+
+      template <class Item>
+      friend auto tag_invoke(exec::set_next_t, receiver& self, Item&& item)
+        -> item_sender<decay_t<Item>, Receiver, Tp, ErrorsVariant> {
+        return {static_cast<Item&&>(item), self.op_};
+      }
+
+      void set_value() && noexcept {
+        op_->on_input_done();
+      }
+
+      void set_stopped() && noexcept {
+        op_->stop_source_.request_stop();
+        op_->on_input_done();
+      }
+
+      template <class Error>
+      void set_error(Error&& error) && noexcept {
+        op_->notify_error(static_cast<Error&&>(error));
+        op_->on_input_done();
+      }
+
+      auto get_env() const noexcept -> env_t<env_of_t<Receiver>> {
+        return op_->get_env();
+      }
+    };
+
+    template <class Receiver, class Sequence>
+    struct traits {
+      using value_type = value_t<Sequence, env_of_t<Receiver>>;
+      using errors_variant = __mapply<
+        __mtransform<__q<decay_t>, __q<__nullable_std_variant>>,
+        error_types_t<env_of_t<Receiver>, Sequence>>;
+
+      using operation_base = batch_::operation_base<Receiver, value_type, errors_variant>;
+      using receiver = batch_::receiver<Receiver, value_type, errors_variant>;
+    };
+
+    template <class Sequence, class Receiver>
+    struct operation : traits<Receiver, Sequence>::operation_base {
+      using base_type = typename traits<Receiver, Sequence>::operation_base;
+      using receiver_t = typename traits<Receiver, Sequence>::receiver;
+
+      exec::subscribe_result_t<Sequence, receiver_t> op_;
+
+      operation(Sequence&& sequence, Receiver rcvr, options opts)
+        : base_type{{}, static_cast<Receiver&&>(rcvr), opts}
+        , op_{exec::subscribe(static_cast<Sequence&&>(sequence), receiver_t{this})} {
+      }
+
+      void start() noexcept {
+        this->stop_callback_.emplace(
+          stdexec::get_stop_token(stdexec::get_env(this->receiver_)),
+          on_stop_requested{this->stop_source_});
+        stdexec::start(op_);
+      }
+    };
+
+    template <class Receiver>
+    struct subscribe_fn {
+      Receiver& rcvr_;
+
+      template <class Child>
+      auto operator()(stdexec::__ignore, options opts, Child&& child)
+        -> operation<Child, Receiver> {
+        return {static_cast<Child&&>(child), static_cast<Receiver&&>(rcvr_), opts};
+      }
+    };
+
+    struct batch_t {
+      template <stdexec::sender Sender, class Rep, class Period>
+      auto operator()(
+        Sender&& sndr,
+        std::size_t max_items,
+        std::chrono::duration<Rep, Period> max_delay) const -> stdexec::__well_formed_sender auto {
+        SIO_ASSERT(max_items > 0);
+        auto domain = stdexec::__get_early_domain(sndr);
+        return stdexec::transform_sender(
+          domain,
+          exec::make_sequence_expr<batch_t>(
+            options{max_items, std::chrono::duration_cast<std::chrono::nanoseconds>(max_delay)},
+            static_cast<Sender&&>(sndr)));
+      }
+
+      template <class Rep, class Period>
+      auto operator()(std::size_t max_items, std::chrono::duration<Rep, Period> max_delay) const
+        noexcept -> binder_back<batch_t, std::size_t, std::chrono::duration<Rep, Period>> {
+        return {{max_items, max_delay}, {}, {}};
+      }
+
+      template <stdexec::sender_expr_for<batch_t> Self, class Receiver>
+      static auto subscribe(Self&& self, Receiver rcvr) noexcept(
+        stdexec::__nothrow_callable<stdexec::__sexpr_apply_t, Self, subscribe_fn<Receiver>>)
+        -> stdexec::__call_result_t<stdexec::__sexpr_apply_t, Self, subscribe_fn<Receiver>> {
+        return stdexec::__sexpr_apply(static_cast<Self&&>(self), subscribe_fn<Receiver>{rcvr});
+      }
+
+      template <class Env, class Sequence>
+      using completions = __concat_completion_signatures<
+        completion_signatures<set_value_t(), set_stopped_t()>,
+        __mapply<
+          __mtransform<__q<as_error_signature>, __q<completion_signatures>>,
+          error_types_t<Env, Sequence>>>;
+
+      template <stdexec::sender_expr_for<batch_t> Self, class Env>
+      static auto get_completion_signatures(Self&&, Env&&) noexcept
+        -> stdexec::__children_of<Self, stdexec::__mbind_front_q<completions, Env>>;
+
+      template <class Env, class Sequence>
+      using item_types = exec::item_types<batch_sender_t<value_t<Sequence, Env>, Env>>;
+
+      template <stdexec::sender_expr_for<batch_t> Self, class Env>
+      static auto get_item_types(Self&&, Env&&) noexcept
+        -> stdexec::__children_of<Self, stdexec::__mbind_front_q<item_types, Env>>;
+    };
+  } // namespace batch_
+
+  // Groups the values of a sequence into std::vector batches. A batch is emitted once it holds
+  // max_items values, or max_delay after its first value. The timer runs on the scheduler of
+  // the receiver's environment. The item that fills a batch completes only after the batch was
+  // processed, which throttles the input. If an allocator is installed in the environment, the
+  // vectors use it through async::std_allocator.
+  using batch_::batch_t;
+  inline constexpr batch_t batch{};
+}
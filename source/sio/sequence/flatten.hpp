@@ -0,0 +1,492 @@
+/*
+ * Copyright (c) 2024 Maikel Nadolski
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "./sequence_concepts.hpp"
+#include "../assert.hpp"
+#include "../async_allocator.hpp"
+#include "../concepts.hpp"
+#include "../intrusive_queue.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+
+#include <stdexec/execution.hpp>
+#include <exec/__detail/__basic_sequence.hpp>
+#include <exec/env.hpp>
+#include <exec/sequence_senders.hpp>
+
+namespace sio {
+  namespace flatten_ {
+    using namespace stdexec;
+
+    template <class Env>
+    using env_t = decltype(exec::make_env(
+      __declval<Env>(),
+      exec::with(get_stop_token, __declval<inplace_stop_token>())));
+
+    // The items of the outer sequence are senders of the inner sequences.
+    template <class Item, class Env>
+    using inner_sequence_t = decay_t<__single_sender_value_t<Item, env_t<Env>>>;
+
+    template <class Sequence, class Env>
+    using outer_item_t = exec::item_sender_t<exec::item_types_of_t<Sequence, env_t<Env>>>;
+
+    template <class Env, class Sequence>
+    using error_types_t = __minvoke<
+      __mconcat<__q<__types>>,
+      __types<std::exception_ptr>,
+      error_types_of_t<Sequence, env_t<Env>, __types>,
+      error_types_of_t<outer_item_t<Sequence, Env>, env_t<Env>, __types>,
+      error_types_of_t<inner_sequence_t<outer_item_t<Sequence, Env>, Env>, env_t<Env>, __types>>;
+
+    template <class Error>
+    using as_error_signature = set_error_t(decay_t<Error>);
+
+    template <class Receiver, class T>
+    using allocator_t = typename std::allocator_traits<decltype(async::get_allocator(
+      __declval<env_of_t<Receiver>>()))>::template rebind_alloc<T>;
+
+    template <class Receiver, class ErrorsVariant>
+    struct operation_base;
+
+    // The item operations that wait for a free slot are queued through next_.
+    template <class Receiver, class ErrorsVariant>
+    struct item_operation_base {
+      item_operation_base* next_{};
+      operation_base<Receiver, ErrorsVariant>* op_;
+      void (*run_)(item_operation_base*) noexcept;
+      void (*complete_)(item_operation_base*) noexcept;
+
+      // Hands the slot of this item to the next waiting item and completes this item.
+      void finish() noexcept;
+    };
+
+    // An inner sequence runs detached from the item that produced it, so that the outer
+    // sequence can continue. It keeps its slot until it completes.
+    template <class Receiver, class ErrorsVariant>
+    struct inner_operation_base {
+      operation_base<Receiver, ErrorsVariant>* op_;
+      void (*destroy_)(inner_operation_base*) noexcept;
+
+      // Hands the slot to the next waiting item and destroys this operation.
+      void finish() noexcept;
+    };
+
+    struct on_stop_requested {
+      inplace_stop_source& stop_source_;
+
+      void operator()() const noexcept {
+        stop_source_.request_stop();
+      }
+    };
+
+    template <class Receiver>
+    struct error_visitor {
+      Receiver* receiver_;
+
+      template <class Error>
+      void operator()(Error&& error) const noexcept {
+        if constexpr (__not_decays_to<Error, std::monostate>) {
+          stdexec::set_error(static_cast<Receiver&&>(*receiver_), static_cast<Error&&>(error));
+        }
+      }
+    };
+
+    template <class Receiver, class ErrorsVariant>
+    struct operation_base : __immovable {
+      using item_base_t = item_operation_base<Receiver, ErrorsVariant>;
+      using on_stop =
+        typename stop_token_of_t<env_of_t<Receiver>>::template callback_type<on_stop_requested>;
+
+      [[no_unique_address]] Receiver receiver_;
+      std::size_t max_concurrency_;
+      [[no_unique_address]] ErrorsVariant errors_{};
+      std::atomic<int> error_emplaced_{0};
+      inplace_stop_source stop_source_{};
+      std::optional<on_stop> stop_callback_{};
+      std::mutex mutex_{};
+      std::size_t n_active_{0};
+      intrusive_queue<&item_base_t::next_> waiting_{};
+      // The outer sequence and every running inner sequence hold a reference.
+      std::atomic<std::size_t> n_pending_{1};
+
+      auto get_env() const noexcept -> env_t<env_of_t<Receiver>> {
+        return exec::make_env(
+          stdexec::get_env(receiver_), exec::with(get_stop_token, stop_source_.get_token()));
+      }
+
+      // Returns true if the item may run now. Otherwise, it runs once a slot is released.
+      bool try_acquire(item_base_t* item) noexcept {
+        std::scoped_lock lock{mutex_};
+        if (n_active_ < max_concurrency_) {
+          ++n_active_;
+          return true;
+        }
+        waiting_.push_back(item);
+        return false;
+      }
+
+      // Returns the waiting item that takes over the released slot, if any.
+      item_base_t* release() noexcept {
+        std::scoped_lock lock{mutex_};
+        if (waiting_.empty()) {
+          --n_active_;
+          return nullptr;
+        }
+        return waiting_.pop_front();
+      }
+
+      template <class Error>
+        requires emplaceable<ErrorsVariant, decay_t<Error>, Error>
+      void notify_error(Error&& error) noexcept {
+        int expected = 0;
+        if (error_emplaced_.compare_exchange_strong(expected, 1, std::memory_order_relaxed)) {
+          errors_.template emplace<decay_t<Error>>(static_cast<Error&&>(error));
+          error_emplaced_.store(2, std::memory_order_release);
+        }
+        stop_source_.request_stop();
+      }
+
+      void release_reference() noexcept {
+        if (n_pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+          complete();
+        }
+      }
+
+      void complete() noexcept {
+        stop_callback_.reset();
+        if (error_emplaced_.load(std::memory_order_acquire) == 2) {
+          std::visit(error_visitor<Receiver>{&receiver_}, static_cast<ErrorsVariant&&>(errors_));
+        } else {
+          exec::set_value_unless_stopped(static_cast<Receiver&&>(receiver_));
+        }
+      }
+    };
+
+    template <class Receiver, class ErrorsVariant>
+    void item_operation_base<Receiver, ErrorsVariant>::finish() noexcept {
+      if (item_operation_base* waiting = op_->release()) {
+        waiting->run_(waiting);
+      }
+      complete_(this);
+    }
+
+    template <class Receiver, class ErrorsVariant>
+    void inner_operation_base<Receiver, ErrorsVariant>::finish() noexcept {
+      auto* op = op_;
+      if (item_operation_base<Receiver, ErrorsVariant>* waiting = op->release()) {
+        waiting->run_(waiting);
+      }
+      destroy_(this);
+      op->release_reference();
+    }
+
+    // Receives the items of an inner sequence and passes them on unchanged.
+    template <class Receiver, class ErrorsVariant>
+    struct inner_receiver {
+      using receiver_concept = stdexec::receiver_t;
+
+      inner_operation_base<Receiver, ErrorsVariant>* inner_op_;
+
+      template <class Item>
+        requires callable<exec::set_next_t, Receiver&, Item>
+      friend auto tag_invoke(exec::set_next_t, inner_receiver& self, Item&& item)
+        -> exec::next_sender_of_t<Receiver, Item> {
+        return exec::set_next(self.inner_op_->op_->receiver_, static_cast<Item&&>(item));
+      }
+
+      void set_value() && noexcept {
+        inner_op_->finish();
+      }
+
+      void set_stopped() && noexcept {
+        inner_op_->op_->stop_source_.request_stop();
+        inner_op_->finish();
+      }
+
+      template <class Error>
+      void set_error(Error&& error) && noexcept {
+        inner_op_->op_->notify_error(static_cast<Error&&>(error));
+        inner_op_->finish();
+      }
+
+      auto get_env() const noexcept -> env_t<env_of_t<Receiver>> {
+        return inner_op_->op_->get_env();
+      }
+    };
+
+    // Allocated from the allocator in the environment of the receiver.
+    template <class Inner, class Receiver, class ErrorsVariant>
+    struct inner_operation : inner_operation_base<Receiver, ErrorsVariant> {
+      using base_t = inner_operation_base<Receiver, ErrorsVariant>;
+      using receiver_t = inner_receiver<Receiver, ErrorsVariant>;
+      using allocator_type = allocator_t<Receiver, inner_operation>;
+
+      static_assert(
+        async::sync_allocator<allocator_type>,
+        "flatten needs an allocator that allocates without suspending");
+
+      exec::subscribe_result_t<Inner, receiver_t> inner_op_;
+
+      inner_operation(Inner&& inner, operation_base<Receiver, ErrorsVariant>* op)
+        : base_t{op, &destroy}
+        , inner_op_{exec::subscribe(static_cast<Inner&&>(inner), receiver_t{this})} {
+      }
+
+      static void destroy(base_t* base) noexcept {
+        auto* self = static_cast<inner_operation*>(base);
+        allocator_type alloc(async::get_allocator(stdexec::get_env(self->op_->receiver_)));
+        async::sync_delete(alloc, self);
+      }
+    };
+
+    // Receives the inner sequence from an item of the outer sequence and subscribes to it.
+    template <class ItemOperation>
+    struct value_receiver {
+      using receiver_concept = stdexec::receiver_t;
+
+      ItemOperation* item_op_;
+
+      template <class Sequence>
+      void set_value(Sequence&& sequence) && noexcept {
+        item_op_->subscribe(static_cast<Sequence&&>(sequence));
+      }
+
+      void set_stopped() && noexcept {
+        item_op_->op_->stop_source_.request_stop();
+        item_op_->finish();
+      }
+
+      template <class Error>
+      void set_error(Error&& error) && noexcept {
+        item_op_->op_->notify_error(static_cast<Error&&>(error));
+        item_op_->finish();
+      }
+
+      auto get_env() const noexcept {
+        return item_op_->op_->get_env();
+      }
+    };
+
+    template <class Item, class ItemReceiver, class Receiver, class ErrorsVariant>
+    struct item_operation : item_operation_base<Receiver, ErrorsVariant> {
+      using base_t = item_operation_base<Receiver, ErrorsVariant>;
+      using value_receiver_t = value_receiver<item_operation>;
+      using inner_t = inner_sequence_t<Item, env_of_t<Receiver>>;
+      using inner_op_t = inner_operation<inner_t, Receiver, ErrorsVariant>;
+
+      [[no_unique_address]] ItemReceiver item_receiver_;
+      stdexec::connect_result_t<Item, value_receiver_t> item_op_;
+
+      static void run(base_t* base) noexcept {
+        auto* self = static_cast<item_operation*>(base);
+        if (self->op_->stop_source_.stop_requested()) {
+          self->finish();
+        } else {
+          stdexec::start(self->item_op_);
+        }
+      }
+
+      static void complete(base_t* base) noexcept {
+        auto* self = static_cast<item_operation*>(base);
+        exec::set_value_unless_stopped(static_cast<ItemReceiver&&>(self->item_receiver_));
+      }
+
+      item_operation(
+        Item&& item,
+        ItemReceiver item_rcvr,
+        operation_base<Receiver, ErrorsVariant>* op)
+        : base_t{nullptr, op, &run, &complete}
+        , item_receiver_(static_cast<ItemReceiver&&>(item_rcvr))
+        , item_op_{stdexec::connect(static_cast<Item&&>(item), value_receiver_t{this})} {
+      }
+
+      // The slot passes to the inner sequence and this item completes, so that the outer
+      // sequence can produce the next item while the inner sequence runs.
+      template <class Sequence>
+      void subscribe(Sequence&& sequence) noexcept {
+        inner_op_t* inner_op = nullptr;
+        try {
+          typename inner_op_t::allocator_type alloc(
+            async::get_allocator(stdexec::get_env(this->op_->receiver_)));
+          inner_op = async::sync_new(alloc, inner_t(static_cast<Sequence&&>(sequence)), this->op_);
+        } catch (...) {
+          this->op_->notify_error(std::current_exception());
+          this->finish();
+          return;
+        }
+        this->op_->n_pending_.fetch_add(1, std::memory_order_relaxed);
+        stdexec::start(inner_op->inner_op_);
+        this->complete_(this);
+      }
+
+      void start() noexcept {
+        if (this->op_->try_acquire(this)) {
+          run(this);
+        }
+      }
+    };
+
+    template <class Item, class Receiver, class ErrorsVariant>
+    struct item_sender {
+      using sender_concept = stdexec::sender_t;
+      using completion_signatures =
+        stdexec::completion_signatures<set_value_t(), set_stopped_t()>;
+
+      Item item_;
+      operation_base<Receiver, ErrorsVariant>* op_;
+
+      template <class ItemReceiver>
+      auto connect(ItemReceiver item_rcvr)
+        -> item_operation<Item, ItemReceiver, Receiver, ErrorsVariant> {
+        return {static_cast<Item&&>(item_), static_cast<ItemReceiver&&>(item_rcvr), op_};
+      }
+    };
+
+    template <class Receiver, class ErrorsVariant>
+    struct receiver {
+      using receiver_concept = stdexec::receiver_t;
+
+      operation_base<Receiver, ErrorsVariant>* op_;
+
+      template <class Item>
+      friend auto tag_invoke(exec::set_next_t, receiver& self, Item&& item)
+        -> item_sender<decay_t<Item>, Receiver, ErrorsVariant> {
+        return {static_cast<Item&&>(item), self.op_};
+      }
+
+      void set_value() && noexcept {
+        op_->release_reference();
+      }
+
+      void set_stopped() && noexcept {
+        op_->stop_source_.request_stop();
+        op_->release_reference();
+      }
+
+      template <class Error>
+      void set_error(Error&& error) && noexcept {
+        op_->notify_error(static_cast<Error&&>(error));
+        op_->release_reference();
+      }
+
+      auto get_env() const noexcept -> env_t<env_of_t<Receiver>> {
+        return op_->get_env();
+      }
+    };
+
+    template <class Receiver, class Sequence>
+    struct traits {
+      using errors_variant = __mapply<
+        __mtransform<__q<decay_t>, __q<__nullable_std_variant>>,
+        error_types_t<env_of_t<Receiver>, Sequence>>;
+
+      using operation_base = flatten_::operation_base<Receiver, errors_variant>;
+      using receiver = flatten_::receiver<Receiver, errors_variant>;
+    };
+
+    template <class Sequence, class Receiver>
+    struct operation : traits<Receiver, Sequence>::operation_base {
+      using base_type = typename traits<Receiver, Sequence>::operation_base;
+      using receiver_t = typename traits<Receiver, Sequence>::receiver;
+
+      exec::subscribe_result_t<Sequence, receiver_t> op_;
+
+      operation(Sequence&& sequence, Receiver rcvr, std::size_t max_concurrency)
+        : base_type{{}, static_cast<Receiver&&>(rcvr), max_concurrency}
+        , op_{exec::subscribe(static_cast<Sequence&&>(sequence), receiver_t{this})} {
+      }
+
+      void start() noexcept {
+        this->stop_callback_.emplace(
+          stdexec::get_stop_token(stdexec::get_env(this->receiver_)),
+          on_stop_requested{this->stop_source_});
+        stdexec::start(op_);
+      }
+    };
+
+    template <class Receiver>
+    struct subscribe_fn {
+      Receiver& rcvr_;
+
+      template <class Child>
+      auto operator()(stdexec::__ignore, std::size_t max_concurrency, Child&& child)
+        -> operation<Child, Receiver> {
+        return {static_cast<Child&&>(child), static_cast<Receiver&&>(rcvr_), max_concurrency};
+      }
+    };
+
+    struct flatten_t {
+      static constexpr std::size_t unbounded = std::numeric_limits<std::size_t>::max();
+
+      template <stdexec::sender Sender>
+      auto operator()(Sender&& sndr, std::size_t max_concurrency = unbounded) const
+        -> stdexec::__well_formed_sender auto {
+        SIO_ASSERT(max_concurrency > 0);
+        auto domain = stdexec::__get_early_domain(sndr);
+        return stdexec::transform_sender(
+          domain,
+          exec::make_sequence_expr<flatten_t>(max_concurrency, static_cast<Sender&&>(sndr)));
+      }
+
+      auto operator()(std::size_t max_concurrency = unbounded) const noexcept
+        -> binder_back<flatten_t, std::size_t> {
+        return {{max_concurrency}, {}, {}};
+      }
+
+      template <stdexec::sender_expr_for<flatten_t> Self, class Receiver>
+      static auto subscribe(Self&& self, Receiver rcvr) noexcept(
+        stdexec::__nothrow_callable<stdexec::__sexpr_apply_t, Self, subscribe_fn<Receiver>>)
+        -> stdexec::__call_result_t<stdexec::__sexpr_apply_t, Self, subscribe_fn<Receiver>> {
+        return stdexec::__sexpr_apply(static_cast<Self&&>(self), subscribe_fn<Receiver>{rcvr});
+      }
+
+      template <class Env, class Sequence>
+      using completions = __concat_completion_signatures<
+        completion_signatures<set_value_t(), set_stopped_t()>,
+        __mapply<
+          __mtransform<__q<as_error_signature>, __q<completion_signatures>>,
+          error_types_t<Env, Sequence>>>;
+
+      template <stdexec::sender_expr_for<flatten_t> Self, class Env>
+      static auto get_completion_signatures(Self&&, Env&&) noexcept
+        -> stdexec::__children_of<Self, stdexec::__mbind_front_q<completions, Env>>;
+
+      template <class Env, class Sequence>
+      using item_types =
+        exec::item_types_of_t<inner_sequence_t<outer_item_t<Sequence, Env>, Env>, env_t<Env>>;
+
+      template <stdexec::sender_expr_for<flatten_t> Self, class Env>
+      static auto get_item_types(Self&&, Env&&) noexcept
+        -> stdexec::__children_of<Self, stdexec::__mbind_front_q<item_types, Env>>;
+    };
+  } // namespace flatten_
+
+  // Merges a sequence of sequences into one sequence. Each item of the outer sequence must
+  // complete with an inner sequence, to which flatten subscribes as soon as fewer than
+  // max_concurrency inner sequences are active. The item completes once its inner sequence
+  // is started, and items that wait for a free slot stay pending. Inner sequences are
+  // allocated from the allocator in the environment of the receiver. Stop requests and
+  // errors are propagated like in merge_each.
+  using flatten_::flatten_t;
+  inline constexpr flatten_t flatten{};
+}
@@ -21,6 +21,12 @@
 #include "../async_allocator.hpp"
 #include "./sequence_concepts.hpp"
 
+#include <array>
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <utility>
+
 #include <exec/env.hpp>
 #include <exec/variant_sender.hpp>
 #include <exec/sequence_senders.hpp>
@@ -40,17 +46,80 @@ namespace sio {
       return otherwise;
     }
 
-    template <class SeqRcvr, class ErrorsVariant>
+    template <class ItemTypes>
+    inline constexpr std::size_t n_item_types = 0;
+
+    template <class... Items>
+    inline constexpr std::size_t n_item_types<exec::item_types<Items...>> = sizeof...(Items);
+
+    template <class Item, class ItemTypes>
+    inline constexpr std::size_t index_of_item = 0;
+
+    // The position of an item type in the item types of the sequence, which selects its free
+    // list.
+    template <class Item, class... Items>
+    inline constexpr std::size_t index_of_item<Item, exec::item_types<Items...>> = [] {
+      constexpr bool matches[] = {std::same_as<Item, Items>...};
+      std::size_t index = 0;
+      while (!matches[index]) {
+        ++index;
+      }
+      return index;
+    }();
+
+    template <class SeqRcvr, class ErrorsVariant, class ItemTypes>
     struct operation_base;
 
-    template <class SeqRcvr, class ErrorsVariant>
+    template <class SeqRcvr, class ErrorsVariant, class ItemTypes>
     struct on_stop_requested {
-      operation_base<SeqRcvr, ErrorsVariant>* op_;
+      operation_base<SeqRcvr, ErrorsVariant, ItemTypes>* op_;
 
       void operator()() const noexcept;
     };
 
-    template <class SeqRcvr, class ErrorsVariant>
+    // Item operations are kept in the free list of their item type after their item completed
+    // and are reused for later items of the same type.
+    struct item_operation_base {
+      item_operation_base* next_free_{};
+      // Starts the deallocation of the item operation. This also identifies its type.
+      void (*delete_)(item_operation_base*) noexcept;
+    };
+
+    // A lock-free stack of cached item operations. Pushes may race with each other and with a
+    // pop. Pops are serialized by popping_: a pop that finds another one in progress reports an
+    // empty stack, and the caller allocates a new operation. Thus no operation can be popped and
+    // pushed again while a pop reads its successor.
+    struct free_list {
+      std::atomic<item_operation_base*> head_{nullptr};
+      std::atomic<bool> popping_{false};
+
+      void push(item_operation_base* item) noexcept {
+        item_operation_base* head = head_.load(std::memory_order_relaxed);
+        do {
+          item->next_free_ = head;
+        } while (!head_.compare_exchange_weak(
+          head, item, std::memory_order_release, std::memory_order_relaxed));
+      }
+
+      auto try_pop() noexcept -> item_operation_base* {
+        if (popping_.exchange(true, std::memory_order_acquire)) {
+          return nullptr;
+        }
+        item_operation_base* head = head_.load(std::memory_order_acquire);
+        while (head
+               && !head_.compare_exchange_weak(
+                 head, head->next_free_, std::memory_order_acquire, std::memory_order_acquire)) {
+        }
+        popping_.store(false, std::memory_order_release);
+        return head;
+      }
+
+      auto pop_all() noexcept -> item_operation_base* {
+        return head_.exchange(nullptr, std::memory_order_acquire);
+      }
+    };
+
+    template <class SeqRcvr, class ErrorsVariant, class ItemTypes>
     struct operation_base {
       enum completion_type {
         value = 0,
@@ -69,9 +138,12 @@ namespace sio {
       ErrorsVariant error_{};
       stdexec::inplace_stop_source stop_source_{};
       using stop_token_t = stdexec::stop_token_of_t<stdexec::env_of_t<SeqRcvr>>;
-      using callback_t =
-        typename stop_token_t::template callback_type<on_stop_requested<SeqRcvr, ErrorsVariant>>;
+      using callback_t = typename stop_token_t::template callback_type<
+        on_stop_requested<SeqRcvr, ErrorsVariant, ItemTypes>>;
       std::optional< callback_t > stop_callback_{};
+      // One free list per item type. The cache can not grow beyond the largest number of items
+      // that were in flight at once.
+      std::array<free_list, n_item_types<ItemTypes>> free_items_{};
 
       template <class Tp>
       auto get_allocator() {
@@ -132,9 +204,49 @@ namespace sio {
         }
       }
 
+      template <class ItemOp>
+      auto take_free_item() noexcept -> ItemOp* {
+        return static_cast<ItemOp*>(free_items_[ItemOp::type_index].try_pop());
+      }
+
+      template <class ItemOp>
+      void recycle_item(ItemOp* item) noexcept {
+        free_items_[ItemOp::type_index].push(item);
+      }
+
       void decrease_ref() {
         if (ref_counter_.fetch_sub(1, std::memory_order_relaxed) == 1) {
+          release_free_items();
+        }
+      }
+
+      // All items are done. The cached item operations are deleted with the allocator of the
+      // environment before the sequence completes. Each deletion completes with decrease_ref,
+      // which brings us back here with an empty cache. The stop callback also releases a
+      // reference, so it is removed before the counter is used for the deletions.
+      void release_free_items() {
+        stop_callback_.reset();
+        item_operation_base* items = nullptr;
+        std::ptrdiff_t n_items = 0;
+        for (free_list& free_items: free_items_) {
+          item_operation_base* item = free_items.pop_all();
+          while (item) {
+            item_operation_base* next = item->next_free_;
+            item->next_free_ = items;
+            items = item;
+            item = next;
+            n_items += 1;
+          }
+        }
+        if (n_items == 0) {
           complete();
+          return;
+        }
+        ref_counter_.store(n_items, std::memory_order_relaxed);
+        while (items) {
+          item_operation_base* next = items->next_free_;
+          items->delete_(items);
+          items = next;
         }
       }
 
@@ -149,18 +261,23 @@ namespace sio {
       }
     };
 
-    template <class SeqRcvr, class ErrorsVariant>
-    void on_stop_requested<SeqRcvr, ErrorsVariant>::operator()() const noexcept {
+    template <class SeqRcvr, class ErrorsVariant, class ItemTypes>
+    void on_stop_requested<SeqRcvr, ErrorsVariant, ItemTypes>::operator()() const noexcept {
       op_->request_stop();
       op_->decrease_ref();
     }
 
-    template <class Item, class SeqRcvr, class ErrorsVariant>
+    template <class Item, class SeqRcvr, class ErrorsVariant, class ItemTypes>
     struct item_operation;
 
     template <class Env>
     using allocator_of_t = decltype(sio::async::get_allocator(std::declval<const Env&>()));
 
+    // Item operations are created and deleted directly if the allocator never suspends.
+    template <class Rcvr>
+    concept has_sync_allocator =
+      sio::async::sync_allocator<allocator_of_t<stdexec::env_of_t<Rcvr>>>;
+
     template <class Rcvr, class T>
     using rcvr_allocator_t = typename std::allocator_traits<
       allocator_of_t<stdexec::env_of_t<Rcvr>>>::template rebind_alloc<T>;
@@ -169,20 +286,19 @@ namespace sio {
     using async_new_sender_of_t =
       decltype(sio::async::async_new(std::declval<Allocator>(), std::declval<Args>()...));
 
-    template <class Item, class SeqRcvr, class ErrorsVariant>
+    template <class Item, class SeqRcvr, class ErrorsVariant, class ItemTypes>
     using async_new_sender = async_new_sender_of_t<
-      rcvr_allocator_t<SeqRcvr, item_operation<Item, SeqRcvr, ErrorsVariant>>,
-      Item,
-      operation_base<SeqRcvr, ErrorsVariant>*>;
+      rcvr_allocator_t<SeqRcvr, item_operation<Item, SeqRcvr, ErrorsVariant, ItemTypes>>,
+      operation_base<SeqRcvr, ErrorsVariant, ItemTypes>*>;
 
     template <class Allocator, class Tp>
     using async_delete_sender_of_t =
       decltype(sio::async::async_delete(std::declval<Allocator>(), std::declval<Tp>()));
 
-    template <class Item, class SeqRcvr, class ErrorsVariant>
+    template <class Item, class SeqRcvr, class ErrorsVariant, class ItemTypes>
     using async_delete_sender = async_delete_sender_of_t<
-      rcvr_allocator_t<SeqRcvr, item_operation<Item, SeqRcvr, ErrorsVariant>>,
-      item_operation<Item, SeqRcvr, ErrorsVariant>*>;
+      rcvr_allocator_t<SeqRcvr, item_operation<Item, SeqRcvr, ErrorsVariant, ItemTypes>>,
+      item_operation<Item, SeqRcvr, ErrorsVariant, ItemTypes>*>;
 
 
     template <class SeqRcvr>
@@ -190,11 +306,11 @@ namespace sio {
       stdexec::env_of_t<SeqRcvr>,
       exec::with_t<stdexec::get_stop_token_t, stdexec::inplace_stop_token>>;
 
-    template <class Item, class SeqRcvr, class ErrorsVariant>
+    template <class Item, class SeqRcvr, class ErrorsVariant, class ItemTypes>
     struct item_receiver {
       using receiver_concept = stdexec::receiver_t;
 
-      item_operation<Item, SeqRcvr, ErrorsVariant>* item_op_;
+      item_operation<Item, SeqRcvr, ErrorsVariant, ItemTypes>* item_op_;
 
       void set_value() noexcept;
 
@@ -203,11 +319,11 @@ namespace sio {
       auto get_env() const noexcept -> env_t<SeqRcvr>;
     };
 
-    template <class SeqRcvr, class ErrorsVariant>
+    template <class SeqRcvr, class ErrorsVariant, class ItemTypes>
     struct final_receiver {
       using receiver_concept = stdexec::receiver_t;
 
-      operation_base<SeqRcvr, ErrorsVariant>* sequence_op_;
+      operation_base<SeqRcvr, ErrorsVariant, ItemTypes>* sequence_op_;
 
       void set_value() noexcept {
         sequence_op_->decrease_ref();
@@ -220,85 +336,139 @@ namespace sio {
       }
     };
 
-    template <class Item, class SeqRcvr, class ErrorsVariant>
-    struct item_operation {
-      explicit item_operation(Item item, operation_base<SeqRcvr, ErrorsVariant>* base)
-        : sequence_op_{base}
-        , inner_operations_{
-            exec::set_next(base->next_rcvr_, static_cast<Item&&>(item)),
-            item_receiver_t{this}} {
+    template <class Item, class SeqRcvr, class ErrorsVariant, class ItemTypes>
+    struct item_operation : item_operation_base {
+      static constexpr std::size_t type_index = index_of_item<Item, ItemTypes>;
+
+      explicit item_operation(operation_base<SeqRcvr, ErrorsVariant, ItemTypes>* base) noexcept
+        : item_operation_base{nullptr, &delete_item}
+        , sequence_op_{base} {
       }
 
       using next_sender_t = exec::next_sender_of_t<SeqRcvr, Item>;
-      using item_receiver_t = item_receiver<Item, SeqRcvr, ErrorsVariant>;
+      using item_receiver_t = item_receiver<Item, SeqRcvr, ErrorsVariant, ItemTypes>;
 
-      using async_delete_t = async_delete_sender<Item, SeqRcvr, ErrorsVariant>;
-      using final_receiver_t = final_receiver<SeqRcvr, ErrorsVariant>;
+      using async_delete_t = async_delete_sender<Item, SeqRcvr, ErrorsVariant, ItemTypes>;
+      using final_receiver_t = final_receiver<SeqRcvr, ErrorsVariant, ItemTypes>;
 
+      // At most one of the members is alive. An item operation is only destroyed by its own
+      // async_delete operation.
       union inner_operations_t {
-        explicit inner_operations_t(next_sender_t&& next, item_receiver_t rcvr)
-          : next_(stdexec::connect(
-              static_cast<next_sender_t&&>(next),
-              static_cast<item_receiver_t&&>(rcvr))) {
+        inner_operations_t() noexcept {
         }
 
         ~inner_operations_t() {
-          std::destroy_at(&async_delete_);
+          if constexpr (!has_sync_allocator<SeqRcvr>) {
+            std::destroy_at(&async_delete_);
+          }
         }
 
         stdexec::connect_result_t<next_sender_t, item_receiver_t> next_;
         stdexec::connect_result_t<async_delete_t, final_receiver_t> async_delete_;
       };
 
-      operation_base<SeqRcvr, ErrorsVariant>* sequence_op_;
-      inner_operations_t inner_operations_;
-
-      void start_delete_operation() noexcept {
-        // destroy next_ operation
-        std::destroy_at(&inner_operations_.next_);
-
-        // start async_delete options
-        auto alloc = sequence_op_->template get_allocator<item_operation>();
-
-        std::construct_at(&inner_operations_.async_delete_, stdexec::__emplace_from{[&] {
+      operation_base<SeqRcvr, ErrorsVariant, ItemTypes>* sequence_op_;
+      inner_operations_t inner_operations_{};
+
+      static void delete_item(item_operation_base* base) noexcept {
+        auto* self = static_cast<item_operation*>(base);
+        auto alloc = self->sequence_op_->template get_allocator<item_operation>();
+        if constexpr (has_sync_allocator<SeqRcvr>) {
+          operation_base<SeqRcvr, ErrorsVariant, ItemTypes>* sequence_op = self->sequence_op_;
+          sio::async::sync_delete(alloc, self);
+          sequence_op->decrease_ref();
+          return;
+        }
+        std::construct_at(&self->inner_operations_.async_delete_, stdexec::__emplace_from{[&] {
           return stdexec::connect(
-            sio::async::async_delete(alloc, this), final_receiver_t{sequence_op_});
+            sio::async::async_delete(alloc, self), final_receiver_t{self->sequence_op_});
         }});
-        stdexec::start(inner_operations_.async_delete_);
+        stdexec::start(self->inner_operations_.async_delete_);
       }
 
-      void start() noexcept {
+      // Puts this operation back into the cache of the sequence operation and releases the
+      // reference of the item.
+      void finish() noexcept {
+        std::destroy_at(&inner_operations_.next_);
+        operation_base<SeqRcvr, ErrorsVariant, ItemTypes>* sequence_op = sequence_op_;
+        // This operation may be reused by another thread from here on.
+        sequence_op->recycle_item(this);
+        sequence_op->decrease_ref();
+      }
+
+      void start_next(Item item) {
+        try {
+          std::construct_at(&inner_operations_.next_, stdexec::__emplace_from{[&] {
+            return stdexec::connect(
+              exec::set_next(sequence_op_->next_rcvr_, static_cast<Item&&>(item)),
+              item_receiver_t{this});
+          }});
+        } catch (...) {
+          sequence_op_->recycle_item(this);
+          throw;
+        }
         if (sequence_op_->stop_source_.stop_requested()) {
-          start_delete_operation();
+          finish();
         } else {
           stdexec::start(inner_operations_.next_);
         }
       }
     };
 
-    template <class Item, class SeqRcvr, class ErrorsVariant>
-    void item_receiver<Item, SeqRcvr, ErrorsVariant>::set_value() noexcept {
-      item_op_->start_delete_operation();
+    template <class Item, class SeqRcvr, class ErrorsVariant, class ItemTypes>
+    void item_receiver<Item, SeqRcvr, ErrorsVariant, ItemTypes>::set_value() noexcept {
+      item_op_->finish();
     }
 
-    template <class Item, class SeqRcvr, class ErrorsVariant>
-    void item_receiver<Item, SeqRcvr, ErrorsVariant>::set_stopped() noexcept {
+    template <class Item, class SeqRcvr, class ErrorsVariant, class ItemTypes>
+    void item_receiver<Item, SeqRcvr, ErrorsVariant, ItemTypes>::set_stopped() noexcept {
       item_op_->sequence_op_->request_stop();
-      item_op_->start_delete_operation();
+      item_op_->finish();
     }
 
-    template <class Item, class SeqRcvr, class ErrorsVariant>
-    auto item_receiver<Item, SeqRcvr, ErrorsVariant>::get_env() const noexcept -> env_t<SeqRcvr> {
+    template <class Item, class SeqRcvr, class ErrorsVariant, class ItemTypes>
+    auto item_receiver<Item, SeqRcvr, ErrorsVariant, ItemTypes>::get_env() const noexcept
+      -> env_t<SeqRcvr> {
       return exec::make_env(
         stdexec::get_env(item_op_->sequence_op_->next_rcvr_),
         exec::with(stdexec::get_stop_token, item_op_->sequence_op_->stop_source_.get_token()));
     }
 
-    template <class SeqRcvr, class ErrorsVariant>
+    template <class SeqRcvr, class ErrorsVariant, class ItemTypes>
     struct receiver {
       using receiver_concept = stdexec::receiver_t;
 
-      operation_base<SeqRcvr, ErrorsVariant>* op_;
+      operation_base<SeqRcvr, ErrorsVariant, ItemTypes>* op_;
+
+      // Reuses the operation of a completed item if possible and allocates a new one otherwise.
+      static auto start_item(operation_base<SeqRcvr, ErrorsVariant, ItemTypes>* op) {
+        if constexpr (has_sync_allocator<SeqRcvr>) {
+          return stdexec::then([op]<class... Vals>(Vals&&... values) {
+            using just_t = decltype(stdexec::just(std::forward<Vals>(values)...));
+            using item_op_t = item_operation<just_t, SeqRcvr, ErrorsVariant, ItemTypes>;
+            item_op_t* item_op = op->template take_free_item<item_op_t>();
+            if (!item_op) {
+              item_op = sio::async::sync_new(op->template get_allocator<item_op_t>(), op);
+            }
+            item_op->start_next(stdexec::just(std::forward<Vals>(values)...));
+          });
+        } else {
+          return stdexec::let_value([op]<class... Vals>(Vals&&... values) noexcept {
+            using just_t = decltype(stdexec::just(std::forward<Vals>(values)...));
+            using item_op_t = item_operation<just_t, SeqRcvr, ErrorsVariant, ItemTypes>;
+            item_op_t* recycled = op->template take_free_item<item_op_t>();
+            return if_then_else(
+                     recycled != nullptr,
+                     stdexec::just(recycled),
+                     sio::async::async_new(op->template get_allocator< item_op_t>(), op))
+                 | stdexec::then(
+                     [item = stdexec::just(std::forward<Vals>(values)...)](
+                       item_op_t* item_op) mutable {
+                       item_op->start_next(static_cast<just_t&&>(item));
+                     });
+          });
+        }
+      }
 
       template <class Item>
       friend auto tag_invoke(exec::set_next_t, receiver& self, Item&& item) {
@@ -307,17 +477,7 @@ namespace sio {
                  return if_then_else(
                    op->increase_ref(), static_cast<Item&&>(item), stdexec::just_stopped());
                })
-             | stdexec::let_value([op = self.op_]<class... Vals>(Vals&&... values) noexcept {
-                 using just_t = decltype(stdexec::just(std::forward<Vals>(values)...));
-                 using item_op_t = item_operation<just_t, SeqRcvr, ErrorsVariant>;
-                 return sio::async::async_new(
-                          op->template get_allocator< item_op_t>(),
-                          stdexec::just(std::forward<Vals>(values)...),
-                          op)
-                      | stdexec::then([](item_op_t* item_op) noexcept {
-                          stdexec::start(*item_op);
-                        });
-               })
+             | start_item(self.op_)
              | stdexec::upon_stopped([op = self.op_]() noexcept {
                  op->request_stop();
                  op->decrease_ref();
@@ -382,13 +542,15 @@ namespace sio {
     template <class Sequence, class SeqRcvr>
     using base_type = operation_base<
       SeqRcvr,
-      typename traits<Sequence, stdexec::env_of_t<SeqRcvr>>::errors_variant>;
+      typename traits<Sequence, stdexec::env_of_t<SeqRcvr>>::errors_variant,
+      typename traits<Sequence, stdexec::env_of_t<SeqRcvr>>::item_types>;
 
     template <class Sequence, class SeqRcvr>
     struct operation : base_type<Sequence, SeqRcvr> {
       using env = stdexec::env_of_t<SeqRcvr>;
       using errors_variant = typename traits<Sequence, env>::errors_variant;
-      using receiver_t = receiver<SeqRcvr, errors_variant>;
+      using item_types = typename traits<Sequence, env>::item_types;
+      using receiver_t = receiver<SeqRcvr, errors_variant, item_types>;
       using subscribe_result_t = exec::subscribe_result_t<Sequence, receiver_t>;
 
       subscribe_result_t op_;
@@ -401,7 +563,7 @@ namespace sio {
       void start() noexcept {
         this->stop_callback_.emplace(
           stdexec::get_stop_token(stdexec::get_env(this->next_rcvr_)),
-          on_stop_requested<SeqRcvr, errors_variant>{this});
+          on_stop_requested<SeqRcvr, errors_variant, item_types>{this});
         if (this->stop_source_.stop_requested()) {
           this->stop_callback_.reset();
           stdexec::set_stopped(static_cast<SeqRcvr&&>(this->next_rcvr_));
@@ -417,7 +579,7 @@ namespace sio {
       SeqRcvr& rcvr_;
 
       template <class Child>
-      using receiver_t = receiver< SeqRcvr, typename traits<Child, SeqRcvr>::errors_variant>;
+      using receiver_t = typename operation<Child, SeqRcvr>::receiver_t;
 
       template <class Sequence>
         requires exec::sequence_sender_to< Sequence, receiver_t<Sequence> >
@@ -0,0 +1,573 @@
+/*
+ * Copyright (c) 2024 Maikel Nadolski
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "./sequence_concepts.hpp"
+#include "../assert.hpp"
+#include "../async_allocator.hpp"
+#include "../concepts.hpp"
+#include "../intrusive_queue.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <tuple>
+#include <utility>
+
+#include <stdexec/execution.hpp>
+#include <exec/__detail/__basic_sequence.hpp>
+#include <exec/env.hpp>
+#include <exec/sequence_senders.hpp>
+
+namespace sio {
+  namespace fork_ordered_ {
+    using namespace stdexec;
+
+    template <class Env>
+    using env_t = decltype(exec::make_env(
+      __declval<Env>(),
+      exec::with(get_stop_token, __declval<inplace_stop_token>())));
+
+    template <class Sequence, class Env>
+    using item_t = exec::item_sender_t<exec::item_types_of_t<Sequence, env_t<Env>>>;
+
+    template <class Item, class Env>
+    using values_t = __value_types_of_t<Item, env_t<Env>, __q<__decayed_tuple>, __q<__msingle>>;
+
+    template <class... Args>
+    using just_t = decltype(stdexec::just(std::declval<Args>()...));
+
+    template <class Item, class Env>
+    using just_sender_t = __mapply<__q<just_t>, values_t<Item, Env>>;
+
+    template <class Env, class Sequence>
+    using error_types_t = __minvoke<
+      __mconcat<__q<__types>>,
+      __types<std::exception_ptr>,
+      error_types_of_t<Sequence, env_t<Env>, __types>,
+      error_types_of_t<item_t<Sequence, Env>, env_t<Env>, __types>>;
+
+    template <class Error>
+    using as_error_signature = set_error_t(decay_t<Error>);
+
+    struct on_stop_requested {
+      inplace_stop_source& stop_source_;
+
+      void operator()() const noexcept {
+        stop_source_.request_stop();
+      }
+    };
+
+    template <class Receiver>
+    struct error_visitor {
+      Receiver* receiver_;
+
+      template <class Error>
+      void operator()(Error&& error) const noexcept {
+        if constexpr (__not_decays_to<Error, std::monostate>) {
+          stdexec::set_error(static_cast<Receiver&&>(*receiver_), static_cast<Error&&>(error));
+        }
+      }
+    };
+
+    template <class Receiver, class Item, class ErrorsVariant>
+    struct operation_base;
+
+    template <class Receiver, class Item, class ErrorsVariant>
+    struct slot;
+
+    // Receives the result of an item of the input sequence.
+    template <class Receiver, class Item, class ErrorsVariant>
+    struct item_receiver {
+      using receiver_concept = stdexec::receiver_t;
+
+      slot<Receiver, Item, ErrorsVariant>* slot_;
+
+      template <class... Args>
+      void set_value(Args&&... args) && noexcept {
+        try {
+          slot_->values_.emplace(static_cast<Args&&>(args)...);
+        } catch (...) {
+          slot_->op_->notify_error(std::current_exception());
+        }
+        slot_->op_->on_item_done(slot_);
+      }
+
+      template <class Error>
+      void set_error(Error&& error) && noexcept {
+        slot_->op_->notify_error(static_cast<Error&&>(error));
+        slot_->op_->on_item_done(slot_);
+      }
+
+      void set_stopped() && noexcept {
+        slot_->op_->stop_source_.request_stop();
+        slot_->op_->on_item_done(slot_);
+      }
+
+      auto get_env() const noexcept -> env_t<env_of_t<Receiver>> {
+        return slot_->op_->get_env();
+      }
+    };
+
+    // Completes once downstream has processed the value of a slot.
+    template <class Receiver, class Item, class ErrorsVariant>
+    struct emit_receiver {
+      using receiver_concept = stdexec::receiver_t;
+
+      slot<Receiver, Item, ErrorsVariant>* slot_;
+
+      void set_value() && noexcept {
+        slot_->op_->emitted(slot_);
+      }
+
+      void set_stopped() && noexcept {
+        slot_->op_->stop_source_.request_stop();
+        slot_->op_->emitted(slot_);
+      }
+
+      auto get_env() const noexcept -> env_t<env_of_t<Receiver>> {
+        return slot_->op_->get_env();
+      }
+    };
+
+    // The operations of set_next that wait for a free slot.
+    template <class Receiver, class Item, class ErrorsVariant>
+    struct waiter_base {
+      waiter_base* next_{};
+      // Called with the acquired slot, or with null if the sequence is stopping.
+      void (*resume_)(waiter_base*, slot<Receiver, Item, ErrorsVariant>*) noexcept;
+      // Called by prefetch once the item of the slot has completed.
+      void (*item_done_)(waiter_base*) noexcept;
+    };
+
+    // One entry of the reorder buffer. It runs an item and holds its values until it is its
+    // turn to be emitted.
+    template <class Receiver, class Item, class ErrorsVariant>
+    struct slot {
+      using env = env_of_t<Receiver>;
+      using item_op_t = connect_result_t<Item, item_receiver<Receiver, Item, ErrorsVariant>>;
+      using emit_op_t = connect_result_t<
+        exec::next_sender_of_t<Receiver, just_sender_t<Item, env>>,
+        emit_receiver<Receiver, Item, ErrorsVariant>>;
+
+      operation_base<Receiver, Item, ErrorsVariant>* op_{};
+      bool done_{false};
+      // The set_next operation that waits for the item, if the input is prefetched.
+      waiter_base<Receiver, Item, ErrorsVariant>* producer_{};
+      std::optional<item_op_t> item_op_{};
+      std::optional<values_t<Item, env>> values_{};
+      std::optional<emit_op_t> emit_op_{};
+
+      void start_item(Item&& item) {
+        auto& op = item_op_.emplace(stdexec::__emplace_from{[&] {
+          return stdexec::connect(
+            static_cast<Item&&>(item), item_receiver<Receiver, Item, ErrorsVariant>{this});
+        }});
+        stdexec::start(op);
+      }
+
+      void emit() {
+        auto& op = emit_op_.emplace(stdexec::__emplace_from{[&] {
+          return stdexec::connect(
+            exec::set_next(
+              op_->receiver_,
+              std::apply(
+                []<class... Args>(Args&&... args) {
+                  return stdexec::just(static_cast<Args&&>(args)...);
+                },
+                std::move(*values_))),
+            emit_receiver<Receiver, Item, ErrorsVariant>{this});
+        }});
+        stdexec::start(op);
+      }
+
+      void reset() noexcept {
+        emit_op_.reset();
+        values_.reset();
+        item_op_.reset();
+        done_ = false;
+      }
+    };
+
+    template <class Receiver, class Item, class ErrorsVariant>
+    struct operation_base : __immovable {
+      using slot_t = slot<Receiver, Item, ErrorsVariant>;
+      using waiter_t = waiter_base<Receiver, Item, ErrorsVariant>;
+      using on_stop =
+        typename stop_token_of_t<env_of_t<Receiver>>::template callback_type<on_stop_requested>;
+      using allocator_t = typename std::allocator_traits<decltype(async::get_allocator(
+        __declval<env_of_t<Receiver>>()))>::template rebind_alloc<slot_t>;
+
+      static_assert(
+        async::sync_array_allocator<allocator_t>,
+        "fork_ordered needs an allocator that allocates without suspending");
+
+      // The slots are taken from the allocator of the environment.
+      operation_base(Receiver rcvr, std::size_t window)
+        : receiver_(static_cast<Receiver&&>(rcvr))
+        , window_{window}
+        , slots_{async::sync_allocate(allocator(), window)} {
+        std::uninitialized_default_construct_n(slots_, window_);
+        for (std::size_t i = 0; i < window_; ++i) {
+          slots_[i].op_ = this;
+        }
+      }
+
+      ~operation_base() {
+        std::destroy_n(slots_, window_);
+        async::sync_deallocate(allocator(), slots_, window_);
+      }
+
+      [[no_unique_address]] Receiver receiver_;
+      std::size_t window_;
+      slot_t* slots_;
+      [[no_unique_address]] ErrorsVariant errors_{};
+      std::atomic<int> error_emplaced_{0};
+      inplace_stop_source stop_source_{};
+      std::optional<on_stop> stop_callback_{};
+      std::mutex mutex_{};
+      // The index of the next item that gets a slot and of the next item to emit. Only the
+      // thread that is emitting changes next_emit_.
+      std::size_t next_index_{0};
+      std::size_t next_emit_{0};
+      bool emitting_{false};
+      // The input sequence and every item that has a slot.
+      std::size_t n_pending_{1};
+      intrusive_queue<&waiter_t::next_> waiters_{};
+
+      auto get_env() const noexcept -> env_t<env_of_t<Receiver>> {
+        return exec::make_env(
+          stdexec::get_env(receiver_), exec::with(get_stop_token, stop_source_.get_token()));
+      }
+
+      allocator_t allocator() const noexcept {
+        return allocator_t(async::get_allocator(stdexec::get_env(receiver_)));
+      }
+
+      template <class Error>
+        requires emplaceable<ErrorsVariant, decay_t<Error>, Error>
+      void notify_error(Error&& error) noexcept {
+        int expected = 0;
+        if (error_emplaced_.compare_exchange_strong(expected, 1, std::memory_order_relaxed)) {
+          errors_.template emplace<decay_t<Error>>(static_cast<Error&&>(error));
+          error_emplaced_.store(2, std::memory_order_release);
+        }
+        stop_source_.request_stop();
+      }
+
+      // Requires the lock.
+      slot_t* take_slot() noexcept {
+        slot_t* slot = &slots_[next_index_ % window_];
+        ++next_index_;
+        ++n_pending_;
+        return slot;
+      }
+
+      // Resumes the waiter with a slot as soon as fewer than window items are in flight.
+      void acquire(waiter_t* waiter) noexcept {
+        std::unique_lock lock{mutex_};
+        slot_t* slot = nullptr;
+        if (!stop_source_.stop_requested()) {
+          if (next_index_ - next_emit_ >= window_) {
+            waiters_.push_back(waiter);
+            return;
+          }
+          slot = take_slot();
+        }
+        lock.unlock();
+        waiter->resume_(waiter, slot);
+      }
+
+      void on_item_done(slot_t* slot) noexcept {
+        // The slot is not released before it is done, which keeps this operation alive.
+        if (waiter_t* producer = std::exchange(slot->producer_, nullptr)) {
+          producer->item_done_(producer);
+        }
+        std::unique_lock lock{mutex_};
+        slot->done_ = true;
+        if (emitting_ || slot != &slots_[next_emit_ % window_]) {
+          return;
+        }
+        emitting_ = true;
+        lock.unlock();
+        emit_next();
+      }
+
+      // Emits the next item in order. Items without values are skipped, and so is everything
+      // once the sequence is stopping.
+      void emit_next() noexcept {
+        slot_t* slot = &slots_[next_emit_ % window_];
+        if (slot->values_ && !stop_source_.stop_requested()) {
+          try {
+            slot->emit();
+            return;
+          } catch (...) {
+            notify_error(std::current_exception());
+          }
+        }
+        emitted(slot);
+      }
+
+      void emitted(slot_t* slot) noexcept {
+        slot->reset();
+        intrusive_queue<&waiter_t::next_> stopped{};
+        waiter_t* waiter = nullptr;
+        slot_t* free_slot = nullptr;
+        std::unique_lock lock{mutex_};
+        ++next_emit_;
+        --n_pending_;
+        if (stop_source_.stop_requested()) {
+          stopped = std::move(waiters_);
+        } else if (!waiters_.empty()) {
+          waiter = waiters_.pop_front();
+          free_slot = take_slot();
+        }
+        const bool emit_more = next_emit_ < next_index_ && slots_[next_emit_ % window_].done_;
+        emitting_ = emit_more;
+        const bool done = n_pending_ == 0;
+        lock.unlock();
+        // A waiting or unemitted item keeps the input sequence and thus this operation alive.
+        while (!stopped.empty()) {
+          waiter_t* w = stopped.pop_front();
+          w->resume_(w, nullptr);
+        }
+        if (waiter) {
+          waiter->resume_(waiter, free_slot);
+        }
+        if (done) {
+          complete();
+        } else if (emit_more) {
+          emit_next();
+        }
+      }
+
+      void on_input_done() noexcept {
+        std::unique_lock lock{mutex_};
+        const bool done = --n_pending_ == 0;
+        lock.unlock();
+        if (done) {
+          complete();
+        }
+      }
+
+      void complete() noexcept {
+        stop_callback_.reset();
+        if (error_emplaced_.load(std::memory_order_acquire) == 2) {
+          std::visit(error_visitor<Receiver>{&receiver_}, static_cast<ErrorsVariant&&>(errors_));
+        } else {
+          exec::set_value_unless_stopped(static_cast<Receiver&&>(receiver_));
+        }
+      }
+    };
+
+    // Waits for a slot and starts the item in it. fork_ordered completes right away so that
+    // the input continues while the item runs. prefetch completes once the item is done, such
+    // that the input runs one item at a time but ahead of the receiver.
+    template <class Receiver, class Item, class ErrorsVariant, class NextReceiver, bool Prefetch>
+    struct next_operation : waiter_base<Receiver, Item, ErrorsVariant> {
+      using base_t = waiter_base<Receiver, Item, ErrorsVariant>;
+      using slot_t = slot<Receiver, Item, ErrorsVariant>;
+
+      Item item_;
+      operation_base<Receiver, Item, ErrorsVariant>* op_;
+      [[no_unique_address]] NextReceiver next_rcvr_;
+
+      static void resume(base_t* base, slot_t* slot) noexcept {
+        auto* self = static_cast<next_operation*>(base);
+        if (!slot) {
+          stdexec::set_stopped(static_cast<NextReceiver&&>(self->next_rcvr_));
+          return;
+        }
+        if constexpr (Prefetch) {
+          slot->producer_ = self;
+        }
+        try {
+          slot->start_item(static_cast<Item&&>(self->item_));
+        } catch (...) {
+          self->op_->notify_error(std::current_exception());
+          self->op_->on_item_done(slot);
+        }
+        if constexpr (!Prefetch) {
+          stdexec::set_value(static_cast<NextReceiver&&>(self->next_rcvr_));
+        }
+      }
+
+      static void item_done(base_t* base) noexcept {
+        auto* self = static_cast<next_operation*>(base);
+        stdexec::set_value(static_cast<NextReceiver&&>(self->next_rcvr_));
+      }
+
+      next_operation(
+        Item&& item,
+        operation_base<Receiver, Item, ErrorsVariant>* op,
+        NextReceiver next_rcvr)
+        : base_t{nullptr, &resume, &item_done}
+        , item_(static_cast<Item&&>(item))
+        , op_{op}
+        , next_rcvr_(static_cast<NextReceiver&&>(next_rcvr)) {
+      }
+
+      void start() noexcept {
+        op_->acquire(this);
+      }
+    };
+
+    template <class Receiver, class Item, class ErrorsVariant, bool Prefetch>
+    struct next_sender {
+      using sender_concept = stdexec::sender_t;
+      using completion_signatures =
+        stdexec::completion_signatures<set_value_t(), set_stopped_t()>;
+
+      Item item_;
+      operation_base<Receiver, Item, ErrorsVariant>* op_;
+
+      template <class NextReceiver>
+      auto connect(NextReceiver next_rcvr)
+        -> next_operation<Receiver, Item, ErrorsVariant, NextReceiver, Prefetch> {
+        return {static_cast<Item&&>(item_), op_, static_cast<NextReceiver&&>(next_rcvr)};
+      }
+    };
+
+    template <class Receiver, class Item, class ErrorsVariant, bool Prefetch>
+    struct receiver {
+      using receiver_concept = stdexec::receiver_t;
+
+      operation_base<Receiver, Item, ErrorsVariant>* op_;
+
+      template <class Sender>
+        requires same_as<decay_t<Sender>, Item>
+      friend auto tag_invoke(exec::set_next_t, receiver& self, Sender&& item)
+        -> next_sender<Receiver, Item, ErrorsVariant, Prefetch> {
+        return {static_cast<Sender&&>(item), self.op_};
+      }
+
+      void set_value() && noexcept {
+        op_->on_input_done();
+      }
+
+      void set_stopped() && noexcept {
+        op_->stop_source_.request_stop();
+        op_->on_input_done();
+      }
+
+      template <class Error>
+      void set_error(Error&& error) && noexcept {
+        op_->notify_error(static_cast<Error&&>(error));
+        op_->on_input_done();
+      }
+
+      auto get_env() const noexcept -> env_t<env_of_t<Receiver>> {
+        return op_->get_env();
+      }
+    };
+
+    template <class Receiver, class Sequence, bool Prefetch>
+    struct traits {
+      using item = item_t<Sequence, env_of_t<Receiver>>;
+      using errors_variant = __mapply<
+        __mtransform<__q<decay_t>, __q<__nullable_std_variant>>,
+        error_types_t<env_of_t<Receiver>, Sequence>>;
+
+      using operation_base = fork_ordered_::operation_base<Receiver, item, errors_variant>;
+      using receiver = fork_ordered_::receiver<Receiver, item, errors_variant, Prefetch>;
+    };
+
+    template <class Sequence, class Receiver, bool Prefetch>
+    struct operation : traits<Receiver, Sequence, Prefetch>::operation_base {
+      using base_type = typename traits<Receiver, Sequence, Prefetch>::operation_base;
+      using receiver_t = typename traits<Receiver, Sequence, Prefetch>::receiver;
+
+      exec::subscribe_result_t<Sequence, receiver_t> op_;
+
+      operation(Sequence&& sequence, Receiver rcvr, std::size_t window)
+        : base_type(static_cast<Receiver&&>(rcvr), window)
+        , op_{exec::subscribe(static_cast<Sequence&&>(sequence), receiver_t{this})} {
+      }
+
+      void start() noexcept {
+        this->stop_callback_.emplace(
+          stdexec::get_stop_token(stdexec::get_env(this->receiver_)),
+          on_stop_requested{this->stop_source_});
+        stdexec::start(op_);
+      }
+    };
+
+    template <class Receiver, bool Prefetch>
+    struct subscribe_fn {
+      Receiver& rcvr_;
+
+      template <class Child>
+      auto operator()(stdexec::__ignore, std::size_t window, Child&& child)
+        -> operation<Child, Receiver, Prefetch> {
+        return {static_cast<Child&&>(child), static_cast<Receiver&&>(rcvr_), window};
+      }
+    };
+
+    template <bool Prefetch>
+    struct ordered_t {
+      template <stdexec::sender Sender>
+      auto operator()(Sender&& sndr, std::size_t window) const
+        -> stdexec::__well_formed_sender auto {
+        SIO_ASSERT(window > 0);
+        auto domain = stdexec::__get_early_domain(sndr);
+        return stdexec::transform_sender(
+          domain, exec::make_sequence_expr<ordered_t>(window, static_cast<Sender&&>(sndr)));
+      }
+
+      auto operator()(std::size_t window) const noexcept
+        -> binder_back<ordered_t, std::size_t> {
+        return {{window}, {}, {}};
+      }
+
+      template <stdexec::sender_expr_for<ordered_t> Self, class Receiver>
+      static auto subscribe(Self&& self, Receiver rcvr) -> stdexec::
+        __call_result_t<stdexec::__sexpr_apply_t, Self, subscribe_fn<Receiver, Prefetch>> {
+        return stdexec::__sexpr_apply(
+          static_cast<Self&&>(self), subscribe_fn<Receiver, Prefetch>{rcvr});
+      }
+
+      template <class Env, class Sequence>
+      using completions = __concat_completion_signatures<
+        completion_signatures<set_value_t(), set_stopped_t()>,
+        __mapply<
+          __mtransform<__q<as_error_signature>, __q<completion_signatures>>,
+          error_types_t<Env, Sequence>>>;
+
+      template <stdexec::sender_expr_for<ordered_t> Self, class Env>
+      static auto get_completion_signatures(Self&&, Env&&) noexcept
+        -> stdexec::__children_of<Self, stdexec::__mbind_front_q<completions, Env>>;
+
+      template <class Env, class Sequence>
+      using item_types = exec::item_types<just_sender_t<item_t<Sequence, Env>, Env>>;
+
+      template <stdexec::sender_expr_for<ordered_t> Self, class Env>
+      static auto get_item_types(Self&&, Env&&) noexcept
+        -> stdexec::__children_of<Self, stdexec::__mbind_front_q<item_types, Env>>;
+    };
+
+    using fork_ordered_t = ordered_t<false>;
+    using prefetch_t = ordered_t<true>;
+  } // namespace fork_ordered_
+
+  // Runs up to window items of a sequence concurrently, but emits their values downstream one
+  // at a time and strictly in the order of the input. The values wait in a ring buffer of
+  // window slots, which is allocated once per subscription.
+  using fork_ordered_::fork_ordered_t;
+  inline constexpr fork_ordered_t fork_ordered{};
+}
@@ -15,9 +15,42 @@
  */
 #pragma once
 
+#include "../assert.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <ranges>
+#include <span>
+#include <type_traits>
+
 #include <exec/sequence/iterate.hpp>
 
 namespace sio {
   using exec::iterate_t;
   inline constexpr iterate_t iterate;
+
+  namespace iterate_chunked_ {
+    struct iterate_chunked_t {
+      template <std::ranges::contiguous_range Range>
+        requires std::ranges::sized_range<Range> && std::ranges::borrowed_range<Range>
+      auto operator()(Range&& range, std::size_t chunk) const {
+        SIO_ASSERT(chunk > 0);
+        using element_type = std::remove_reference_t<std::ranges::range_reference_t<Range>>;
+        std::span<element_type> elements{std::ranges::data(range), std::ranges::size(range)};
+        const std::size_t n_chunks = (elements.size() + chunk - 1) / chunk;
+        return iterate(
+          std::views::iota(std::size_t{0}, n_chunks)
+          | std::views::transform([elements, chunk](std::size_t index) {
+              const std::size_t offset = index * chunk;
+              return elements.subspan(offset, std::min(chunk, elements.size() - offset));
+            }));
+      }
+    };
+  }
+
+  // Emits the elements of a contiguous range as std::span chunks of up to chunk elements, such
+  // that the cost of an item is shared by all elements of a chunk. The range must outlive the
+  // sequence, which is why only lvalues and borrowed ranges are accepted.
+  using iterate_chunked_::iterate_chunked_t;
+  inline constexpr iterate_chunked_t iterate_chunked{};
 }
@@ -0,0 +1,27 @@
+/*
+ * Copyright (c) 2024 Maikel Nadolski
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "./fork_ordered.hpp"
+
+namespace sio {
+  // Lets the input sequence run up to n items ahead of the receiver. The input produces its
+  // items one at a time, as with a plain set_next, but it does not wait for the receiver to
+  // process them. Their values are stored in a ring buffer of n slots, and the input waits
+  // once all slots are taken. The receiver gets the values in order.
+  using fork_ordered_::prefetch_t;
+  inline constexpr prefetch_t prefetch{};
+}
@@ -17,12 +17,60 @@
 #pragma once
 
 #include "./sequence_concepts.hpp"
+#include "../assert.hpp"
+#include "../intrusive_queue.hpp"
+
+#include <cstddef>
+#include <exception>
+#include <optional>
 
 #include <exec/__detail/__basic_sequence.hpp>
 #include <stdexec/functional.hpp>
 
 namespace sio {
   namespace repeat_ {
+    struct trampoline_item {
+      trampoline_item* next_{};
+      void (*execute_)(trampoline_item*) noexcept;
+    };
+
+    // Runs items on the current thread with a bounded stack depth. Once max_depth items are
+    // nested, further items are queued and run by the outermost call after the stack has
+    // unwound. That call only touches its own stack frame after running an item, which may
+    // have completed and destroyed the operation that it belongs to.
+    class trampoline {
+     public:
+      static constexpr std::size_t max_depth = 16;
+
+      static void execute(trampoline_item* item) noexcept {
+        trampoline* current = current_;
+        if (current == nullptr) {
+          trampoline outermost{};
+          current_ = &outermost;
+          outermost.depth_ = 1;
+          item->execute_(item);
+          while (!outermost.pending_.empty()) {
+            trampoline_item* next = outermost.pending_.pop_front();
+            outermost.depth_ = 1;
+            next->execute_(next);
+          }
+          current_ = nullptr;
+        } else if (current->depth_ < max_depth) {
+          ++current->depth_;
+          item->execute_(item);
+          --current->depth_;
+        } else {
+          current->pending_.push_back(item);
+        }
+      }
+
+     private:
+      inline static thread_local trampoline* current_ = nullptr;
+
+      std::size_t depth_{0};
+      intrusive_queue<&trampoline_item::next_> pending_{};
+    };
+
     template <class Sender, class Receiver>
     struct operation;
 
@@ -56,22 +104,102 @@ namespace sio {
       }
     };
 
+    // Resumes the repetition after yielding to the scheduler of the environment.
+    template <class Sender, class Receiver>
+    struct yield_receiver {
+      using receiver_concept = stdexec::receiver_t;
+
+      operation<Sender, Receiver>* base_;
+
+      void set_value() && noexcept {
+        base_->repeat();
+      }
+
+      void set_stopped() && noexcept {
+        stdexec::set_value(static_cast<Receiver&&>(base_->rcvr_));
+      }
+
+      template <class Error>
+      void set_error(Error&& error) && noexcept {
+        if constexpr (std::same_as<stdexec::__decay_t<Error>, std::exception_ptr>) {
+          stdexec::set_error(static_cast<Receiver&&>(base_->rcvr_), static_cast<Error&&>(error));
+        } else {
+          stdexec::set_error(
+            static_cast<Receiver&&>(base_->rcvr_),
+            std::make_exception_ptr(static_cast<Error&&>(error)));
+        }
+      }
+
+      auto get_env() const noexcept -> stdexec::env_of_t<const Receiver&> {
+        return stdexec::get_env(base_->rcvr_);
+      }
+    };
+
+    template <class Receiver>
+    inline constexpr bool can_yield =
+      stdexec::__callable<stdexec::get_scheduler_t, stdexec::env_of_t<Receiver>>;
+
+    template <class Sender, class Receiver, bool CanYield = can_yield<Receiver>>
+    struct yield_state { };
+
+    template <class Sender, class Receiver>
+    struct yield_state<Sender, Receiver, true> {
+      using scheduler_t = stdexec::__decay_t<
+        stdexec::__call_result_t<stdexec::get_scheduler_t, stdexec::env_of_t<Receiver>>>;
+      using op_t = stdexec::connect_result_t<
+        stdexec::schedule_result_t<scheduler_t&>,
+        yield_receiver<Sender, Receiver>>;
+
+      std::optional<op_t> op_{};
+    };
+
     template <class Sender, class Receiver>
-    struct operation {
+    struct operation : trampoline_item {
       using receiver_t = repeat_::receiver<Sender, Receiver>;
       using subscribe_result_t = exec::subscribe_result_t<const Sender&, receiver_t >;
 
       Sender sndr_;
       Receiver rcvr_;
+      // Yields to the scheduler of the environment after this many iterations, if not zero.
+      // Without a scheduler in the environment it must be zero.
+      std::size_t yield_every_;
+      std::size_t since_yield_{0};
       std::optional<subscribe_result_t> op_{};
+      [[no_unique_address]] yield_state<Sender, Receiver> yield_{};
+
+      operation(Sender&& sndr, Receiver rcvr, std::size_t yield_every)
+        : trampoline_item{nullptr, &execute}
+        , sndr_(static_cast<Sender&&>(sndr))
+        , rcvr_(static_cast<Receiver&&>(rcvr))
+        , yield_every_{yield_every} {
+        SIO_ASSERT(can_yield<Receiver> || yield_every_ == 0);
+      }
 
+      static void execute(trampoline_item* item) noexcept {
+        static_cast<operation*>(item)->subscribe();
+      }
+
+      // Children that complete inline call this from within their completion. The trampoline
+      // keeps the stack from growing with each of these iterations.
       void repeat() noexcept {
+        trampoline::execute(this);
+      }
+
+      void subscribe() noexcept {
         stdexec::queryable auto env = stdexec::get_env(this->rcvr_);
         auto token = stdexec::get_stop_token(env);
         if (token.stop_requested()) {
           stdexec::set_value(static_cast<Receiver&&>(this->rcvr_));
           return;
         }
+        if constexpr (can_yield<Receiver>) {
+          if (yield_every_ != 0 && since_yield_ == yield_every_) {
+            since_yield_ = 0;
+            yield();
+            return;
+          }
+          ++since_yield_;
+        }
         try {
           auto& op = op_.emplace(stdexec::__emplace_from{[&] {
             return exec::subscribe((const Sender&) this->sndr_, receiver_t{this});
@@ -82,6 +210,19 @@ namespace sio {
         }
       }
 
+      void yield() noexcept {
+        try {
+          auto& op = yield_.op_.emplace(stdexec::__emplace_from{[&] {
+            auto scheduler = stdexec::get_scheduler(stdexec::get_env(this->rcvr_));
+            return stdexec::connect(
+              stdexec::schedule(scheduler), yield_receiver<Sender, Receiver>{this});
+          }});
+          stdexec::start(op);
+        } catch (...) {
+          stdexec::set_error(static_cast<Receiver&&>(this->rcvr_), std::current_exception());
+        }
+      }
+
       void start() noexcept {
         repeat();
       }
@@ -93,18 +234,23 @@ namespace sio {
 
       template <class Child>
         requires exec::sequence_sender_to<Child, receiver<Child, Receiver>>
-      auto operator()(stdexec::__ignore, stdexec::__ignore, Child&& child) const noexcept
+      auto operator()(stdexec::__ignore, std::size_t yield_every, Child&& child) const noexcept
         -> operation<Child, Receiver> {
-        return {static_cast<Child&&>(child), static_cast<Receiver&&>(rcvr)};
+        return {static_cast<Child&&>(child), static_cast<Receiver&&>(rcvr), yield_every};
       }
     };
 
     struct repeat_t {
+      // With a non-zero yield_every, the repetition is rescheduled on the scheduler of the
+      // environment after every yield_every iterations, so that it does not monopolize it.
+      // The environment of the receiver must then provide get_scheduler. Without one,
+      // yield_every has no effect and debug builds assert.
       template <stdexec::sender Sender>
-      auto operator()(Sender&& sndr) const noexcept -> stdexec::__well_formed_sender auto {
+      auto operator()(Sender&& sndr, std::size_t yield_every = 0) const noexcept
+        -> stdexec::__well_formed_sender auto {
         auto domain = stdexec::__get_early_domain(static_cast<Sender&&>(sndr));
         return stdexec::transform_sender(
-          domain, exec::make_sequence_expr<repeat_t>(stdexec::__{}, static_cast<Sender&&>(sndr)));
+          domain, exec::make_sequence_expr<repeat_t>(yield_every, static_cast<Sender&&>(sndr)));
       }
 
       template <stdexec::sender_expr_for<repeat_t> Self, class Env>
@@ -19,8 +19,11 @@
 #include "../concepts.hpp"
 #include "./sequence_concepts.hpp"
 
+#include <atomic>
 #include <functional>
+#include <mutex>
 #include <tuple>
+#include <type_traits>
 
 #include <exec/sequence_senders.hpp>
 #include <exec/__detail/__basic_sequence.hpp>
@@ -28,7 +31,32 @@
 #include <stdexec/functional.hpp>
 
 namespace sio {
+  // Functions for which scan may update a trivially copyable accumulator in a compare-and-swap
+  // loop instead of taking a lock. Such a function may be called more than once per item and
+  // must not have side effects. Specialize this for your own function objects.
+  template <class Fn>
+  inline constexpr bool enable_lock_free_scan = false;
+
+  template <class Tp>
+  inline constexpr bool enable_lock_free_scan<std::plus<Tp>> = true;
+
+  template <class Tp>
+  inline constexpr bool enable_lock_free_scan<std::multiplies<Tp>> = true;
+
+  template <class Tp>
+  inline constexpr bool enable_lock_free_scan<std::bit_and<Tp>> = true;
+
+  template <class Tp>
+  inline constexpr bool enable_lock_free_scan<std::bit_or<Tp>> = true;
+
+  template <class Tp>
+  inline constexpr bool enable_lock_free_scan<std::bit_xor<Tp>> = true;
+
   namespace scan_ {
+    template <class Tp, class Fn>
+    concept lock_free_scannable =
+      enable_lock_free_scan<Fn> && std::is_trivially_copyable_v<Tp>
+      && std::atomic<Tp>::is_always_lock_free;
 
     template <class Tp, class Fn, bool IsLockStep>
     struct scan_data {
@@ -45,6 +73,27 @@ namespace sio {
       }
     };
 
+    template <class Tp, class Fn>
+      requires lock_free_scannable<Tp, Fn>
+    struct scan_data<Tp, Fn, false> {
+      std::atomic<Tp> value_;
+      Fn fn_;
+
+      template <class... Args>
+        requires callable<Fn&, Tp&, Args&...>
+      auto emplace(Args&&... args) noexcept(nothrow_callable<Fn&, Tp&, Args&...>) -> Tp {
+        Tp expected = value_.load(std::memory_order_relaxed);
+        while (true) {
+          Tp current = expected;
+          Tp desired = fn_(current, args...);
+          if (value_.compare_exchange_weak(
+                expected, desired, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+            return desired;
+          }
+        }
+      }
+    };
+
     template <class Tp, class Fn>
     struct scan_data<Tp, Fn, true> {
       Tp value_;
@@ -18,7 +18,60 @@
 #include "../concepts.hpp"
 #include "./transform_each.hpp"
 
+#include <functional>
+#include <type_traits>
+
 namespace sio {
+  namespace then_each_ {
+    // Calls second with the result of first.
+    template <class First, class Second>
+    struct composed_fn {
+      First first_;
+      Second second_;
+
+      template <class... Args>
+      static constexpr bool nothrow_call() noexcept {
+        using first_result_t = std::invoke_result_t<First&, Args...>;
+        if constexpr (std::is_void_v<first_result_t>) {
+          return std::is_nothrow_invocable_v<First&, Args...>
+              && std::is_nothrow_invocable_v<Second&>;
+        } else {
+          return std::is_nothrow_invocable_v<First&, Args...>
+              && std::is_nothrow_invocable_v<Second&, first_result_t>;
+        }
+      }
+
+      // Noexcept if both calls are, such that the fused then does not add set_error for an
+      // exception_ptr.
+      template <class... Args>
+      auto operator()(Args&&... args) noexcept(nothrow_call<Args...>()) {
+        if constexpr (std::is_void_v<std::invoke_result_t<First&, Args...>>) {
+          std::invoke(first_, static_cast<Args&&>(args)...);
+          return std::invoke(second_);
+        } else {
+          return std::invoke(second_, std::invoke(first_, static_cast<Args&&>(args)...));
+        }
+      }
+    };
+
+    template <class Fn>
+    struct adaptor {
+      Fn fn_;
+
+      template <stdexec::sender Item>
+      auto operator()(Item&& item) const {
+        return stdexec::then(static_cast<Item&&>(item), fn_);
+      }
+    };
+
+    // Two adjacent then_each stages become a single then per item.
+    template <class First, class Second>
+    auto fuse(adaptor<First> first, adaptor<Second> second)
+      -> adaptor<composed_fn<First, Second>> {
+      return {{static_cast<First&&>(first.fn_), static_cast<Second&&>(second.fn_)}};
+    }
+  }
+
   struct then_each_t {
     template <class _Sender, class _Fn>
       requires stdexec::tag_invocable<then_each_t, _Sender, _Fn>
@@ -32,7 +85,8 @@ namespace sio {
       requires(!stdexec::tag_invocable<then_each_t, _Sender, _Fn>)
     auto operator()(_Sender&& __sender, _Fn&& __fn) const {
       return transform_each(
-        static_cast<_Sender&&>(__sender), stdexec::then(static_cast<_Fn&&>(__fn)));
+        static_cast<_Sender&&>(__sender),
+        then_each_::adaptor<decay_t<_Fn>>{static_cast<_Fn&&>(__fn)});
     }
 
     template <class _Fn>
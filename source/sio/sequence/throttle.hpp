@@ -0,0 +1,399 @@
+/*
+ * Copyright (c) 2024 Maikel Nadolski
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "./sequence_concepts.hpp"
+#include "../assert.hpp"
+#include "../concepts.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <optional>
+#include <tuple>
+#include <utility>
+
+#include <stdexec/execution.hpp>
+#include <stdexec/__detail/__transform_completion_signatures.hpp>
+#include <exec/__detail/__basic_sequence.hpp>
+#include <exec/sequence_senders.hpp>
+#include <exec/timed_scheduler.hpp>
+
+namespace sio {
+  // A token bucket that holds up to burst tokens and is refilled with rate tokens per second.
+  // It stores the time at which the bucket would be full again (GCRA) and takes tokens with a
+  // compare-and-swap loop.
+  class token_bucket {
+   public:
+    token_bucket(std::size_t rate, std::size_t burst) noexcept
+      : ns_per_token_{1'000'000'000.0 / static_cast<double>(rate)}
+      , tolerance_{duration_of(burst)} {
+      SIO_ASSERT(rate > 0);
+    }
+
+    // Takes cost tokens at time now, which may lead to a negative balance. Returns how long
+    // the caller has to wait until the balance is not negative anymore.
+    std::chrono::nanoseconds acquire(std::size_t cost, std::chrono::nanoseconds now) noexcept {
+      const std::int64_t interval = duration_of(cost);
+      std::int64_t full_at = full_at_.load(std::memory_order_relaxed);
+      std::int64_t next_full_at = 0;
+      do {
+        next_full_at = std::max(full_at, now.count()) + interval;
+      } while (!full_at_.compare_exchange_weak(full_at, next_full_at, std::memory_order_relaxed));
+      return std::chrono::nanoseconds{std::max<std::int64_t>(
+        next_full_at - tolerance_ - now.count(), 0)};
+    }
+
+   private:
+    std::int64_t duration_of(std::size_t tokens) const noexcept {
+      return static_cast<std::int64_t>(static_cast<double>(tokens) * ns_per_token_);
+    }
+
+    double ns_per_token_;
+    std::int64_t tolerance_;
+    std::atomic<std::int64_t> full_at_{0};
+  };
+
+  namespace throttle_ {
+    using namespace stdexec;
+
+    // Every item costs one token. The token is taken before the item is started.
+    struct item_cost {
+      static constexpr bool before_start = true;
+
+      std::size_t operator()() const noexcept {
+        return 1;
+      }
+    };
+
+    // An item costs as many tokens as the number of bytes that it has read or written. This is
+    // only known after the transfer, so the tokens are taken when the item has completed and
+    // delay its completion.
+    struct byte_cost {
+      static constexpr bool before_start = false;
+
+      std::size_t operator()(std::size_t n_bytes) const noexcept {
+        return n_bytes;
+      }
+    };
+
+    struct options {
+      std::size_t rate_;
+      std::size_t burst_;
+    };
+
+    template <class Env>
+    using scheduler_t = decay_t<__call_result_t<get_scheduler_t, Env>>;
+
+    template <class Scheduler>
+    using timer_sender_t = decltype(exec::schedule_after(
+      std::declval<Scheduler&>(), std::declval<exec::duration_of_t<Scheduler>>()));
+
+    template <class Item, class Env>
+    using values_t = __value_types_of_t<Item, Env, __q<__decayed_tuple>, __q<__msingle>>;
+
+    template <class... Args>
+    using decayed_value_signature = completion_signatures<set_value_t(decay_t<Args>...)>;
+
+    template <class ItemReceiver>
+    struct item_operation_base;
+
+    template <class ItemReceiver>
+    struct timer_receiver {
+      using receiver_concept = stdexec::receiver_t;
+
+      item_operation_base<ItemReceiver>* op_;
+
+      void set_value() && noexcept {
+        op_->resume_(op_);
+      }
+
+      template <class Error>
+      void set_error(Error&& error) && noexcept {
+        if constexpr (std::same_as<decay_t<Error>, std::exception_ptr>) {
+          stdexec::set_error(static_cast<ItemReceiver&&>(op_->rcvr_), static_cast<Error&&>(error));
+        } else {
+          stdexec::set_error(
+            static_cast<ItemReceiver&&>(op_->rcvr_),
+            std::make_exception_ptr(static_cast<Error&&>(error)));
+        }
+      }
+
+      void set_stopped() && noexcept {
+        stdexec::set_stopped(static_cast<ItemReceiver&&>(op_->rcvr_));
+      }
+
+      auto get_env() const noexcept -> env_of_t<ItemReceiver> {
+        return stdexec::get_env(op_->rcvr_);
+      }
+    };
+
+    template <class ItemReceiver>
+    struct item_operation_base {
+      using scheduler_t = throttle_::scheduler_t<env_of_t<ItemReceiver>>;
+      using timer_op_t =
+        connect_result_t<timer_sender_t<scheduler_t>, timer_receiver<ItemReceiver>>;
+
+      [[no_unique_address]] ItemReceiver rcvr_;
+      token_bucket* bucket_;
+      // Starts the item or forwards its values, depending on when the tokens are taken.
+      void (*resume_)(item_operation_base*) noexcept;
+      std::optional<timer_op_t> timer_op_{};
+
+      // Resumes once the bucket has enough tokens for cost.
+      void wait_for_tokens(std::size_t cost) {
+        scheduler_t scheduler = stdexec::get_scheduler(stdexec::get_env(rcvr_));
+        const std::chrono::nanoseconds delay = bucket_->acquire(
+          cost,
+          std::chrono::duration_cast<std::chrono::nanoseconds>(
+            exec::now(scheduler).time_since_epoch()));
+        if (delay == std::chrono::nanoseconds::zero()) {
+          resume_(this);
+          return;
+        }
+        auto& op = timer_op_.emplace(stdexec::__emplace_from{[&] {
+          return stdexec::connect(
+            exec::schedule_after(
+              scheduler, std::chrono::ceil<exec::duration_of_t<scheduler_t>>(delay)),
+            timer_receiver<ItemReceiver>{this});
+        }});
+        stdexec::start(op);
+      }
+    };
+
+    template <class Item, class ItemReceiver, class Cost>
+    struct item_operation;
+
+    template <class Item, class ItemReceiver, class Cost>
+    struct item_receiver {
+      using receiver_concept = stdexec::receiver_t;
+
+      item_operation<Item, ItemReceiver, Cost>* op_;
+
+      template <class... Args>
+      void set_value(Args&&... args) && noexcept {
+        if constexpr (Cost::before_start) {
+          stdexec::set_value(static_cast<ItemReceiver&&>(op_->rcvr_), static_cast<Args&&>(args)...);
+        } else {
+          try {
+            const std::size_t cost = Cost{}(std::as_const(args)...);
+            op_->values_.emplace(static_cast<Args&&>(args)...);
+            op_->wait_for_tokens(cost);
+          } catch (...) {
+            stdexec::set_error(static_cast<ItemReceiver&&>(op_->rcvr_), std::current_exception());
+          }
+        }
+      }
+
+      template <class Error>
+      void set_error(Error&& error) && noexcept {
+        stdexec::set_error(static_cast<ItemReceiver&&>(op_->rcvr_), static_cast<Error&&>(error));
+      }
+
+      void set_stopped() && noexcept {
+        stdexec::set_stopped(static_cast<ItemReceiver&&>(op_->rcvr_));
+      }
+
+      auto get_env() const noexcept -> env_of_t<ItemReceiver> {
+        return stdexec::get_env(op_->rcvr_);
+      }
+    };
+
+    template <class Item, class ItemReceiver, class Cost>
+    struct item_operation : item_operation_base<ItemReceiver> {
+      using base_t = item_operation_base<ItemReceiver>;
+      using item_receiver_t = item_receiver<Item, ItemReceiver, Cost>;
+
+      connect_result_t<Item, item_receiver_t> op_;
+      std::optional<values_t<Item, env_of_t<ItemReceiver>>> values_{};
+
+      item_operation(Item&& item, ItemReceiver rcvr, token_bucket* bucket)
+        : base_t{static_cast<ItemReceiver&&>(rcvr), bucket, &resume}
+        , op_{stdexec::connect(static_cast<Item&&>(item), item_receiver_t{this})} {
+      }
+
+      static void resume(base_t* base) noexcept {
+        auto* self = static_cast<item_operation*>(base);
+        if constexpr (Cost::before_start) {
+          stdexec::start(self->op_);
+        } else {
+          std::apply(
+            [self]<class... Args>(Args&&... args) noexcept {
+              stdexec::set_value(
+                static_cast<ItemReceiver&&>(self->rcvr_), static_cast<Args&&>(args)...);
+            },
+            std::move(*self->values_));
+        }
+      }
+
+      void start() noexcept {
+        if constexpr (Cost::before_start) {
+          try {
+            this->wait_for_tokens(Cost{}());
+          } catch (...) {
+            stdexec::set_error(static_cast<ItemReceiver&&>(this->rcvr_), std::current_exception());
+          }
+        } else {
+          stdexec::start(op_);
+        }
+      }
+    };
+
+    template <class Item, class Cost>
+    struct item_sender {
+      using sender_concept = stdexec::sender_t;
+
+      Item item_;
+      token_bucket* bucket_;
+
+      template <class ItemReceiver>
+      auto connect(ItemReceiver rcvr) -> item_operation<Item, ItemReceiver, Cost> {
+        return {static_cast<Item&&>(item_), static_cast<ItemReceiver&&>(rcvr), bucket_};
+      }
+
+      template <class Self, class Env>
+      static auto get_completion_signatures(Self&&, Env&&)
+        -> stdexec::transform_completion_signatures_of<
+          copy_cvref_t<Self, Item>,
+          Env,
+          stdexec::completion_signatures<set_error_t(std::exception_ptr), set_stopped_t()>,
+          decayed_value_signature>;
+    };
+
+    template <class Receiver>
+    struct operation_base {
+      [[no_unique_address]] Receiver rcvr_;
+      token_bucket bucket_;
+    };
+
+    template <class Receiver, class Cost>
+    struct receiver {
+      using receiver_concept = stdexec::receiver_t;
+
+      template <class Item>
+      using item_sender_t = item_sender<decay_t<Item>, Cost>;
+
+      operation_base<Receiver>* op_;
+
+      template <class Item>
+      friend auto tag_invoke(exec::set_next_t, receiver& self, Item&& item)
+        -> exec::next_sender_of_t<Receiver, item_sender_t<Item>> {
+        return exec::set_next(
+          self.op_->rcvr_,
+          receiver::item_sender_t<Item>{static_cast<Item&&>(item), &self.op_->bucket_});
+      }
+
+      void set_value() && noexcept {
+        stdexec::set_value(static_cast<Receiver&&>(op_->rcvr_));
+      }
+
+      template <class Error>
+      void set_error(Error&& error) && noexcept {
+        stdexec::set_error(static_cast<Receiver&&>(op_->rcvr_), static_cast<Error&&>(error));
+      }
+
+      void set_stopped() && noexcept {
+        stdexec::set_stopped(static_cast<Receiver&&>(op_->rcvr_));
+      }
+
+      auto get_env() const noexcept -> env_of_t<Receiver> {
+        return stdexec::get_env(op_->rcvr_);
+      }
+    };
+
+    template <class Sequence, class Receiver, class Cost>
+    struct operation : operation_base<Receiver> {
+      using receiver_t = throttle_::receiver<Receiver, Cost>;
+
+      exec::subscribe_result_t<Sequence, receiver_t> op_;
+
+      operation(Sequence&& sequence, Receiver rcvr, options opts)
+        : operation_base<Receiver>{
+            static_cast<Receiver&&>(rcvr),
+            token_bucket{opts.rate_, opts.burst_}}
+        , op_{exec::subscribe(static_cast<Sequence&&>(sequence), receiver_t{this})} {
+      }
+
+      void start() noexcept {
+        stdexec::start(op_);
+      }
+    };
+
+    template <class Receiver, class Cost>
+    struct subscribe_fn {
+      Receiver& rcvr_;
+
+      template <class Child>
+      auto operator()(stdexec::__ignore, options opts, Child&& child)
+        -> operation<Child, Receiver, Cost> {
+        return {static_cast<Child&&>(child), static_cast<Receiver&&>(rcvr_), opts};
+      }
+    };
+
+    template <class Cost>
+    struct basic_throttle_t {
+      template <stdexec::sender Sender>
+      auto operator()(Sender&& sndr, std::size_t rate, std::size_t burst) const
+        -> stdexec::__well_formed_sender auto {
+        auto domain = stdexec::__get_early_domain(sndr);
+        return stdexec::transform_sender(
+          domain,
+          exec::make_sequence_expr<basic_throttle_t>(
+            options{rate, burst}, static_cast<Sender&&>(sndr)));
+      }
+
+      auto operator()(std::size_t rate, std::size_t burst) const noexcept
+        -> binder_back<basic_throttle_t, std::size_t, std::size_t> {
+        return {{rate, burst}, {}, {}};
+      }
+
+      template <stdexec::sender_expr_for<basic_throttle_t> Self, class Receiver>
+      static auto subscribe(Self&& self, Receiver rcvr)
+        -> stdexec::__call_result_t<stdexec::__sexpr_apply_t, Self, subscribe_fn<Receiver, Cost>> {
+        return stdexec::__sexpr_apply(
+          static_cast<Self&&>(self), subscribe_fn<Receiver, Cost>{rcvr});
+      }
+
+      template <stdexec::sender_expr_for<basic_throttle_t> Self, class Env>
+      static auto get_completion_signatures(Self&&, Env&&) noexcept
+        -> exec::__sequence_completion_signatures_of_t<stdexec::__child_of<Self>, Env>;
+
+      template <class Self, class Env>
+      using item_types = exec::item_types<item_sender<
+        exec::item_sender_t<exec::item_types_of_t<stdexec::__child_of<Self>, Env>>,
+        Cost>>;
+
+      template <stdexec::sender_expr_for<basic_throttle_t> Self, class Env>
+      static auto get_item_types(Self&&, Env&&) noexcept -> item_types<Self, Env>;
+    };
+  } // namespace throttle_
+
+  // Delays the items of a sequence such that at most rate items per second are started, with
+  // bursts of up to burst items. An item waits for its token before it is started. The delays
+  // are scheduled on the timer of the scheduler in the environment. The state is a single
+  // token_bucket in the operation state.
+  using throttle_t = throttle_::basic_throttle_t<throttle_::item_cost>;
+  inline constexpr throttle_t throttle{};
+
+  // Like throttle, but meters the std::size_t result of each item, like the number of bytes
+  // that a read or write has transferred, in units per second. Since the cost is only known
+  // when the item has completed, items start right away and their completion is delayed.
+  using throttle_bytes_t = throttle_::basic_throttle_t<throttle_::byte_cost>;
+  inline constexpr throttle_bytes_t throttle_bytes{};
+}
@@ -15,9 +15,59 @@
  */
 #pragma once
 
+#include "../concepts.hpp"
+
 #include <exec/sequence/transform_each.hpp>
 
 namespace sio {
-  using exec::transform_each_t;
+  namespace transform_each_ {
+    // Applies the second adaptor to the item sender that the first adaptor returns.
+    template <class First, class Second>
+    struct composed_adaptor {
+      First first_;
+      Second second_;
+
+      template <class Item>
+      auto operator()(Item&& item) const
+        -> call_result_t<const Second&, call_result_t<const First&, Item>> {
+        return second_(first_(static_cast<Item&&>(item)));
+      }
+    };
+
+    // Adaptors can provide a better fuse overload, which is found by argument dependent lookup.
+    template <class First, class Second>
+    auto fuse(First first, Second second) -> composed_adaptor<First, Second> {
+      return {static_cast<First&&>(first), static_cast<Second&&>(second)};
+    }
+
+    struct transform_each_t {
+      // A transform_each of a transform_each is fused into a single stage, which saves one
+      // receiver and one operation layer per item.
+      template <stdexec::sender Sender, class Adaptor>
+      auto operator()(Sender&& sndr, Adaptor&& adaptor) const {
+        if constexpr (stdexec::sender_expr_for<decay_t<Sender>, exec::transform_each_t>) {
+          return stdexec::__sexpr_apply(
+            static_cast<Sender&&>(sndr),
+            [&]<class Data, class Child>(stdexec::__ignore, Data&& data, Child&& child) {
+              return exec::transform_each(
+                static_cast<Child&&>(child),
+                fuse(
+                  static_cast<decay_t<Data>>(static_cast<Data&&>(data)),
+                  static_cast<decay_t<Adaptor>>(static_cast<Adaptor&&>(adaptor))));
+            });
+        } else {
+          return exec::transform_each(
+            static_cast<Sender&&>(sndr), static_cast<Adaptor&&>(adaptor));
+        }
+      }
+
+      template <class Adaptor>
+      auto operator()(Adaptor&& adaptor) const -> binder_back<transform_each_t, decay_t<Adaptor>> {
+        return {{static_cast<Adaptor&&>(adaptor)}, {}, {}};
+      }
+    };
+  }
+
+  using transform_each_::transform_each_t;
   inline constexpr transform_each_t transform_each{};
 }
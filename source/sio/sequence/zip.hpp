@@ -19,7 +19,9 @@
 #include "./sequence_concepts.hpp"
 #include "../intrusive_queue.hpp"
 
+#include <atomic>
 #include <optional>
+#include <tuple>
 #include <utility>
 
 #include <stdexec/execution.hpp>
@@ -35,11 +37,50 @@ namespace sio {
       item_operation_result* next_;
       std::optional<ResultTuple> result_{};
       void (*complete_)(item_operation_result*) noexcept = nullptr;
+      // Starts the zipped operation of the given item operations in this operation.
+      void (*start_zipped_)(item_operation_result*, void* item_ops) noexcept = nullptr;
+    };
+
+    // A queue of item operations with many producers and a single consumer. Producers push
+    // onto an atomic stack and the consumer moves that stack into its private queue.
+    template <class ResultTuple>
+    struct item_queue {
+      using item_t = item_operation_result<ResultTuple>;
+
+      std::atomic<item_t*> pushed_{nullptr};
+      intrusive_queue<&item_t::next_> ready_{};
+
+      void push(item_t* item) noexcept {
+        item_t* head = pushed_.load(std::memory_order_relaxed);
+        do {
+          item->next_ = head;
+        } while (!pushed_.compare_exchange_weak(
+          head, item, std::memory_order_release, std::memory_order_relaxed));
+      }
+
+      // Returns the number of items that have been moved to the ready queue.
+      int take_pushed() noexcept {
+        if (pushed_.load(std::memory_order_relaxed) == nullptr) {
+          return 0;
+        }
+        item_t* list = pushed_.exchange(nullptr, std::memory_order_acquire);
+        int count = 0;
+        for (item_t* item = list; item != nullptr; item = item->next_) {
+          ++count;
+        }
+        ready_.append(intrusive_queue<&item_t::next_>::make_reversed(list));
+        return count;
+      }
     };
 
     template <class... Results>
-    using item_operation_queues =
-      std::tuple<intrusive_queue<&item_operation_result<Results>::next_>...>;
+    using item_queues = std::tuple<item_queue<Results>...>;
+
+    template <class Tp>
+    using to_item_result = item_operation_result<Tp>*;
+
+    template <class ResultTuple>
+    using item_ops_t = __mapply<__mtransform<__q<to_item_result>, __q<std::tuple>>, ResultTuple>;
 
     struct on_stop_requested {
       inplace_stop_source& stop_source_;
@@ -51,17 +92,19 @@ namespace sio {
 
     template <class Receiver, class ResultTuple, class ErrorsVariant>
     struct operation_base : __immovable {
-      using mutexes_t = __mapply<__mtransform<__mconst<std::mutex>, __q<std::tuple>>, ResultTuple>;
-      using queues_t = __mapply<__q<item_operation_queues>, ResultTuple>;
+      using queues_t = __mapply<__q<item_queues>, ResultTuple>;
+      using item_ops = item_ops_t<ResultTuple>;
       using on_stop =
         typename stop_token_of_t<env_of_t<Receiver>>::template callback_type<on_stop_requested>;
 
       [[no_unique_address]] Receiver receiver_;
       [[no_unique_address]] ErrorsVariant errors_{};
-      std::mutex stop_mutex_{};
-      mutexes_t mutexes_{};
+      std::atomic_flag has_error_{};
       queues_t item_queues_{};
-      std::atomic<int> n_ready_next_items_{};
+      // Counts the pushed items and stop notifications that the consumer has not seen yet.
+      // Whoever increments it from zero becomes the consumer until it drops back to zero.
+      std::atomic<int> n_notifications_{};
+      std::atomic<int> n_stop_notifications_{};
       inplace_stop_source stop_source_{};
       std::optional<on_stop> stop_callback_{};
       std::atomic<int> n_pending_operations_{std::tuple_size_v<ResultTuple>};
@@ -69,59 +112,125 @@ namespace sio {
       template <std::size_t Index>
       bool push_back_item_op(
         item_operation_result<std::tuple_element_t<Index, ResultTuple>>* op) noexcept {
-        if (!stop_source_.stop_requested()) {
-          std::scoped_lock lock(std::get<Index>(mutexes_));
-          std::get<Index>(item_queues_).push_back(op);
-          return true;
+        if (stop_source_.stop_requested()) {
+          return false;
+        }
+        if (n_notifications_.fetch_add(1, std::memory_order_acq_rel) == 0) {
+          std::get<Index>(item_queues_).ready_.push_back(op);
+          consume(1);
+        } else {
+          std::get<Index>(item_queues_).push(op);
         }
-        return false;
+        return true;
       }
 
-      void notify_stop() {
+      // A stop notification is added to n_stop_notifications_ only after it was counted in
+      // n_notifications_. Otherwise the consumer could release a notification that was not
+      // counted yet, and the notifier would become a second consumer.
+      void notify_stop() noexcept {
         stop_source_.request_stop();
-        auto local_queues = std::apply(
-          [this]<same_as<std::mutex>... Mutex>(Mutex&... mutexes) {
-            std::scoped_lock lock(mutexes...);
-            n_ready_next_items_.store(0, std::memory_order_relaxed);
-            return std::apply(
-              []<class... Queues>(Queues&... queues) {
-                return std::tuple{static_cast<Queues&&>(queues)...};
-              },
-              item_queues_);
-          },
-          mutexes_);
-        std::apply(
-          [](auto&... queues) {
-            auto clear_queue = []<class Queue>(Queue& queue) {
-              while (!queue.empty()) {
-                auto op = queue.pop_front();
-                op->complete_(op);
-              }
-            };
-            (clear_queue(queues), ...);
-          },
-          local_queues);
+        if (n_notifications_.fetch_add(1, std::memory_order_acq_rel) == 0) {
+          consume(1);
+        } else {
+          n_stop_notifications_.fetch_add(1, std::memory_order_relaxed);
+        }
       }
 
       template <class Error>
         requires emplaceable<ErrorsVariant, decay_t<Error>, Error>
-      void notify_error(Error&& error) {
-        {
-          std::scoped_lock lock(stop_mutex_);
-          if (errors_.index() == 0) {
-            errors_.template emplace<decay_t<Error>>(static_cast<Error&&>(error));
-          }
+      void notify_error(Error&& error) noexcept {
+        if (!has_error_.test_and_set(std::memory_order_relaxed)) {
+          errors_.template emplace<decay_t<Error>>(static_cast<Error&&>(error));
         }
         notify_stop();
       }
+
+     private:
+      // Gives up the consumer role unless there are notifications that have not been seen.
+      bool release(int seen) noexcept {
+        return n_notifications_.fetch_sub(seen, std::memory_order_acq_rel) == seen;
+      }
+
+      int take_pushed_items() noexcept {
+        return std::apply(
+          [](auto&... queues) { return (queues.take_pushed() + ...); }, item_queues_);
+      }
+
+      bool all_ready() noexcept {
+        return std::apply(
+          [](auto&... queues) { return (!queues.ready_.empty() && ...); }, item_queues_);
+      }
+
+      bool any_ready() noexcept {
+        return std::apply(
+          [](auto&... queues) { return (!queues.ready_.empty() || ...); }, item_queues_);
+      }
+
+      static void start(item_ops& ops) noexcept {
+        auto* host = std::get<0>(ops);
+        host->start_zipped_(host, &ops);
+      }
+
+      // Runs as the only consumer of the item queues. An item operation can only complete
+      // after we have given it to a zipped operation or have stopped it. Once the zipped
+      // operation is started or the items are completed, this operation might be destroyed.
+      // Hence, everything is done before that unless other ready items keep it alive.
+      void consume(int seen) noexcept {
+        std::optional<item_ops> pending{};
+        while (true) {
+          seen += take_pushed_items();
+          if (stop_source_.stop_requested()) {
+            seen += n_stop_notifications_.exchange(0, std::memory_order_relaxed);
+            std::optional<item_ops> stopped = std::exchange(pending, std::nullopt);
+            auto local_queues = std::apply(
+              [](auto&... queues) { return std::tuple{std::exchange(queues.ready_, {})...}; },
+              item_queues_);
+            const bool released = release(seen);
+            seen = 0;
+            if (stopped) {
+              std::apply([](auto*... ops) { (ops->complete_(ops), ...); }, *stopped);
+            }
+            std::apply(
+              [](auto&... queues) {
+                auto clear_queue = []<class Queue>(Queue& queue) {
+                  while (!queue.empty()) {
+                    auto op = queue.pop_front();
+                    op->complete_(op);
+                  }
+                };
+                (clear_queue(queues), ...);
+              },
+              local_queues);
+            if (released) {
+              return;
+            }
+            continue;
+          }
+          if (!pending && all_ready()) {
+            pending.emplace(std::apply(
+              [](auto&... queues) { return item_ops{queues.ready_.pop_front()...}; },
+              item_queues_));
+          }
+          if (pending && any_ready()) {
+            // The remaining ready items keep this operation alive.
+            item_ops ops = *std::exchange(pending, std::nullopt);
+            start(ops);
+            continue;
+          }
+          if (release(seen)) {
+            if (pending) {
+              start(*pending);
+            }
+            return;
+          }
+          seen = 0;
+        }
+      }
     };
 
     template <class Receiver, class ResultTuple, class ErrorsVariant>
     struct zipped_operation_base {
-      template <class Tp>
-      using to_item_result = item_operation_result<Tp>*;
-
-      using item_ops = __mapply<__mtransform<__q<to_item_result>, __q<std::tuple>>, ResultTuple>;
+      using item_ops = item_ops_t<ResultTuple>;
 
       operation_base<Receiver, ResultTuple, ErrorsVariant>* sequence_op_;
       std::optional<item_ops> item_ops_{};
@@ -183,6 +292,7 @@ namespace sio {
 
       using item_base_t = item_operation_result<std::tuple_element_t<Index, ResultTuple>>;
       using zipped_base_t = zipped_operation_base<Receiver, ResultTuple, ErrorsVariant>;
+      using item_ops = typename zipped_base_t::item_ops;
 
       [[no_unique_address]] ItemReceiver item_receiver_;
       std::optional<stdexec::connect_result_t<
@@ -199,101 +309,41 @@ namespace sio {
         }
       }
 
+      static void start_zipped(item_base_t* base, void* item_ops_ptr) noexcept {
+        auto* self = static_cast<item_operation_base*>(base);
+        self->item_ops_.emplace(static_cast<item_ops&&>(*static_cast<item_ops*>(item_ops_ptr)));
+        self->start_zipped_operation();
+      }
+
       item_operation_base(
         ItemReceiver rcvr,
         operation_base<Receiver, ResultTuple, ErrorsVariant>* sequence_op) noexcept
-        : item_base_t{{}, {}, &complete}
+        : item_base_t{{}, {}, &complete, &start_zipped}
         , zipped_base_t{sequence_op}
         , item_receiver_(static_cast<ItemReceiver&&>(rcvr)) {
       }
 
-      void notify_result_completion() noexcept {
-        // Check whether this is the the last item operation to complete such that we can start the zipped operation
-        constexpr int n_results = std::tuple_size_v<ResultTuple>;
+      void start_zipped_operation() noexcept {
         operation_base<Receiver, ResultTuple, ErrorsVariant>* sequence_op = this->sequence_op_;
-        std::unique_lock lock(std::get<Index>(sequence_op->mutexes_));
-        if (std::get<Index>(sequence_op->item_queues_).front() != this) {
-          return;
-        }
-        const int n_ready_next_items = sequence_op->n_ready_next_items_.fetch_add(
-          1, std::memory_order_relaxed);
-        lock.unlock();
-        if (n_ready_next_items == n_results - 1) {
-
-          // 1. Collect all results and assemble one big tuple
-          concat_result_types<ResultTuple> result = std::apply(
-            [&](auto&... mutexes) {
-              std::scoped_lock lock(mutexes...);
-              return std::apply(
-                [&](auto&... queues) {
-                  return std::tuple_cat(std::move(*queues.front()->result_)...);
-                },
-                sequence_op->item_queues_);
-            },
-            sequence_op->mutexes_);
-
-          // 2. pop front items from shared queues into a private storage of this op.
-          std::apply(
-            [&](auto&... mutexes) {
-              std::scoped_lock lock(mutexes...);
-              this->item_ops_.emplace(std::apply(
-                [](auto&... queues) { return std::tuple{queues.pop_front()...}; },
-                sequence_op->item_queues_));
-              sequence_op->n_ready_next_items_.store(-1, std::memory_order_relaxed);
-            },
-            sequence_op->mutexes_);
-
-          // 3. Check whether we need to stop
-          if (sequence_op->stop_source_.stop_requested()) {
-            this->complete_all_item_ops();
-            return;
-          }
-
-          // 4. count ready items in shared queues
-          // An inline completion of the zipped operation could destroy ALL the operations.
-          // So we need to check whether there is outstanding work before we start the zipped operation.
-          // Since there is no other candidate to complete the ready items, we can safely assume that
-          // we will be the one to start the next zipped operation, too.
-          bool is_next_completion = false;
-          std::apply(
-            [&](auto&... mutexes) {
-              std::scoped_lock lock(mutexes...);
-              const int count = std::apply(
-                [](auto&... queues) { return (!queues.empty() + ...); }, sequence_op->item_queues_);
-              if (count == n_results) {
-                sequence_op->n_ready_next_items_.store(count - 1, std::memory_order_relaxed);
-                is_next_completion = true;
-              } else {
-                sequence_op->n_ready_next_items_.store(count, std::memory_order_relaxed);
-              }
-            },
-            sequence_op->mutexes_);
-
-          // 5. Start the zipped operation.
-          try {
-            auto& op = zipped_op_.emplace(stdexec::__emplace_from{[&] {
-              return stdexec::connect(
-                exec::set_next(
-                  sequence_op->receiver_,
-                  std::apply(
-                    []<class... Args>(Args&&... args) {
-                      return stdexec::just(static_cast<Args&&>(args)...);
-                    },
-                    static_cast<concat_result_types<ResultTuple>&&>(result))),
-                zipped_receiver<Receiver, ResultTuple, ErrorsVariant>{this});
-            }});
-            stdexec::start(op);
-          } catch (...) {
-            sequence_op->notify_error(std::current_exception());
-            this->complete_all_item_ops();
-            return;
-          }
-
-          // 6. If all next items are ready, then start the next zipped operation
-          if (is_next_completion) {
-            static_cast<item_operation_base*>(std::get<Index>(sequence_op->item_queues_).front())
-              ->notify_result_completion();
-          }
+        try {
+          auto& op = zipped_op_.emplace(stdexec::__emplace_from{[&] {
+            concat_result_types<ResultTuple> result = std::apply(
+              [](auto*... item_ops) { return std::tuple_cat(std::move(*item_ops->result_)...); },
+              *this->item_ops_);
+            return stdexec::connect(
+              exec::set_next(
+                sequence_op->receiver_,
+                std::apply(
+                  []<class... Args>(Args&&... args) {
+                    return stdexec::just(static_cast<Args&&>(args)...);
+                  },
+                  static_cast<concat_result_types<ResultTuple>&&>(result))),
+              zipped_receiver<Receiver, ResultTuple, ErrorsVariant>{this});
+          }});
+          stdexec::start(op);
+        } catch (...) {
+          sequence_op->notify_error(std::current_exception());
+          this->complete_all_item_ops();
         }
       }
     };
@@ -316,11 +366,10 @@ namespace sio {
         } catch (...) {
           op_->sequence_op_->notify_error(std::current_exception());
           stdexec::set_stopped(static_cast<ItemReceiver&&>(op_->item_receiver_));
+          return;
         }
         if (!op_->sequence_op_->template push_back_item_op<Index>(op_)) {
           stdexec::set_stopped(static_cast<ItemReceiver&&>(op_->item_receiver_));
-        } else {
-          op_->notify_result_completion();
         }
       }
 
@@ -398,7 +447,7 @@ namespace sio {
       }
 
       void set_value() && noexcept {
-        int n_ops = op_->n_pending_operations_.fetch_sub(1, std::memory_order_relaxed);
+        int n_ops = op_->n_pending_operations_.fetch_sub(1, std::memory_order_acq_rel);
         if (n_ops > 1) {
           op_->notify_stop();
           return;
@@ -421,7 +470,7 @@ namespace sio {
       }
 
       void set_stopped() && noexcept {
-        int n_ops = op_->n_pending_operations_.fetch_sub(1, std::memory_order_relaxed);
+        int n_ops = op_->n_pending_operations_.fetch_sub(1, std::memory_order_acq_rel);
         if (n_ops > 1) {
           op_->notify_stop();
           return;
@@ -436,7 +485,7 @@ namespace sio {
 
       template <class Error>
       void set_error(Error&& error) && noexcept {
-        int n_ops = op_->n_pending_operations_.fetch_sub(1, std::memory_order_relaxed);
+        int n_ops = op_->n_pending_operations_.fetch_sub(1, std::memory_order_acq_rel);
         if (n_ops > 1) {
           op_->notify_error(static_cast<Error&&>(error));
           return;
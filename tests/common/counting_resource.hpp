@@ -0,0 +1,38 @@
+#pragma once
+
+#include "sio/memory_pool.hpp"
+
+#include <atomic>
+#include <climits>
+#include <cstddef>
+#include <new>
+
+// Takes memory from the global heap and counts the allocations that were made and that are
+// still live. Allocations fail while limit_ blocks are live.
+struct counting_resource : sio::memory_resource {
+  std::atomic<int> allocations_{0};
+  std::atomic<int> live_{0};
+  int limit_;
+
+  explicit counting_resource(int limit = INT_MAX)
+    : limit_{limit} {
+  }
+
+  void* do_allocate(std::size_t bytes, std::size_t alignment) noexcept override {
+    if (live_.fetch_add(1) >= limit_) {
+      live_.fetch_sub(1);
+      return nullptr;
+    }
+    allocations_.fetch_add(1);
+    return ::operator new(bytes, std::align_val_t(alignment), std::nothrow);
+  }
+
+  void do_deallocate(void* ptr, std::size_t, std::size_t alignment) noexcept override {
+    live_.fetch_sub(1);
+    ::operator delete(ptr, std::align_val_t(alignment));
+  }
+
+  bool do_is_equal(const sio::memory_resource& other) const noexcept override {
+    return &other == this;
+  }
+};
@@ -0,0 +1,182 @@
+/*
+ * Copyright (c) 2024 Maikel Nadolski
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "sio/async_resource.hpp"
+#include "sio/io_uring/connection_pool.hpp"
+#include "sio/with_env.hpp"
+
+#include <catch2/catch_all.hpp>
+
+#include <stdexec/execution.hpp>
+#include <exec/when_any.hpp>
+
+#include <atomic>
+#include <thread>
+
+namespace {
+  template <class Sender>
+  void run(exec::io_uring_context& context, Sender&& sender) {
+    stdexec::sync_wait(
+      exec::when_any(std::forward<Sender>(sender), context.run(exec::until::stopped)));
+  }
+
+  // Accepts connections on a loopback port and counts them.
+  struct test_server {
+    int fd_{-1};
+    sio::ip::endpoint endpoint_{sio::ip::address_v4::loopback(), 0};
+    std::atomic<int> accepted_{0};
+    std::atomic<sio::ip::port_type> stop_port_{0};
+    std::thread thread_{};
+
+    explicit test_server(bool close_accepted) {
+      fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+      REQUIRE(fd_ != -1);
+      REQUIRE(::bind(fd_, endpoint_.data(), endpoint_.size()) == 0);
+      ::socklen_t size = endpoint_.size();
+      REQUIRE(::getsockname(fd_, endpoint_.data(), &size) == 0);
+      REQUIRE(::listen(fd_, 16) == 0);
+      thread_ = std::thread{[this, close_accepted] {
+        std::vector<int> connections{};
+        while (true) {
+          sio::ip::endpoint peer{};
+          ::socklen_t peer_size = sizeof(::sockaddr_in6);
+          int conn = ::accept(fd_, peer.data(), &peer_size);
+          if (conn == -1) {
+            break;
+          }
+          if (stop_port_ != 0 && peer.port() == stop_port_) {
+            ::close(conn);
+            break;
+          }
+          accepted_ += 1;
+          if (close_accepted) {
+            ::close(conn);
+          } else {
+            connections.push_back(conn);
+          }
+        }
+        for (int c: connections) {
+          ::close(c);
+        }
+      }};
+    }
+
+    // Connections are accepted in order, so all connections made before the final one
+    // have been counted when the thread sees it.
+    int finish() {
+      if (thread_.joinable()) {
+        int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        sio::ip::endpoint local{sio::ip::address_v4::loopback(), 0};
+        ::socklen_t size = local.size();
+        ::bind(fd, local.data(), local.size());
+        ::getsockname(fd, local.data(), &size);
+        stop_port_ = local.port();
+        if (::connect(fd, endpoint_.data(), endpoint_.size()) == -1) {
+          ::shutdown(fd_, SHUT_RDWR);
+        }
+        thread_.join();
+        ::close(fd);
+        ::close(fd_);
+      }
+      return accepted_;
+    }
+
+    ~test_server() {
+      finish();
+    }
+  };
+
+  auto no_op = [](auto) {
+    return stdexec::just();
+  };
+}
+
+TEST_CASE("connection_pool - reuse an idle connection", "[connection_pool]") {
+  test_server server{false};
+  exec::io_uring_context context{};
+  sio::io_uring::connection_pool pool{context};
+  auto connection = pool.connection(server.endpoint_);
+  std::size_t idle = 0;
+  run(
+    context,
+    stdexec::let_value(sio::async::use_resources(no_op, connection), [&] {
+      idle = pool.idle_count();
+      return sio::async::use_resources(no_op, connection);
+    }));
+  CHECK(idle == 1);
+  CHECK(pool.idle_count() == 1);
+  CHECK(pool.total_count() == 1);
+  CHECK(server.finish() == 1);
+}
+
+TEST_CASE("connection_pool - connections closed by the peer are not reused", "[connection_pool]") {
+  test_server server{true};
+  exec::io_uring_context context{};
+  sio::io_uring::connection_pool pool{context};
+  auto connection = pool.connection(server.endpoint_);
+  using namespace std::chrono_literals;
+  run(
+    context,
+    stdexec::let_value(sio::async::use_resources(no_op, connection), [&] {
+      return stdexec::let_value(exec::schedule_after(context.get_scheduler(), 50ms), [&] {
+        return sio::async::use_resources(no_op, connection);
+      });
+    }));
+  CHECK(server.finish() == 2);
+  CHECK(pool.total_count() <= 1);
+}
+
+TEST_CASE("connection_pool - checkout waits for a free connection", "[connection_pool]") {
+  test_server server{false};
+  exec::io_uring_context context{};
+  sio::io_uring::connection_pool pool{
+    context, sio::io_uring::connection_pool_options{.max_total = 1}};
+  auto connection = pool.connection(server.endpoint_);
+  using namespace std::chrono_literals;
+  auto delayed = [&](auto) {
+    return exec::schedule_after(context.get_scheduler(), 10ms);
+  };
+  run(
+    context,
+    stdexec::when_all(
+      sio::async::use_resources(delayed, connection),
+      sio::async::use_resources(delayed, connection)));
+  CHECK(pool.total_count() == 1);
+  CHECK(server.finish() == 1);
+}
+
+TEST_CASE("connection_pool - a stopped checkout does not wait", "[connection_pool]") {
+  test_server server{false};
+  exec::io_uring_context context{};
+  sio::io_uring::connection_pool pool{
+    context, sio::io_uring::connection_pool_options{.max_total = 1}};
+  auto connection = pool.connection(server.endpoint_);
+  stdexec::inplace_stop_source stop_source{};
+  stop_source.request_stop();
+  bool opened = false;
+  bool stopped = false;
+  auto stopped_open =
+    sio::with_env(
+      exec::make_env(exec::with(stdexec::get_stop_token, stop_source.get_token())),
+      connection.open())
+    | stdexec::then([&](auto) { opened = true; }) //
+    | stdexec::upon_stopped([&] { stopped = true; });
+  // The only connection is checked out while the second checkout starts.
+  run(context, sio::async::use_resources([&](auto) { return stopped_open; }, connection));
+  CHECK_FALSE(opened);
+  CHECK(stopped);
+  CHECK(pool.total_count() == 1);
+  CHECK(server.finish() == 1);
+}
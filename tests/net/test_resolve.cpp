@@ -19,6 +19,12 @@
 #include "sio/ip/resolve.hpp"
 #include "sio/ip/tcp.hpp"
 #include "sio/sequence/first.hpp"
+#include "sio/sequence/ignore_all.hpp"
+#include "sio/sequence/then_each.hpp"
+
+#include <algorithm>
+#include <array>
+#include <memory>
 
 TEST_CASE("async::resolve - Resolve ipv4 localhost", "[net][resolve][first]") {
   auto sndr = sio::first(sio::async::resolve(sio::ip::tcp::v4(), "localhost", "http"));
@@ -39,3 +45,72 @@ TEST_CASE("async::resolve - Resolve ipv6 localhost", "[net][resolve][first]") {
   std::string str = response.endpoint().address().to_string();
   CHECK(str == "::1");
 }
+
+TEST_CASE("async::resolve - Numeric hosts complete inline", "[net][resolve][first]") {
+  auto completed = std::make_shared<bool>(false);
+  auto sndr = sio::first(sio::async::resolve(sio::ip::tcp::v6(), "::1", "8080"))
+            | stdexec::then([completed](sio::ip::resolver_result response) {
+                CHECK(response.endpoint().address().to_string() == "::1");
+                CHECK(response.endpoint().port() == 8080);
+                *completed = true;
+              });
+  stdexec::start_detached(std::move(sndr));
+  CHECK(*completed);
+}
+
+TEST_CASE("async::resolve - Numeric host with a named service", "[net][resolve][first]") {
+  auto sndr = sio::first(sio::async::resolve(sio::ip::tcp::v4(), "127.0.0.1", "http"));
+  auto result = stdexec::sync_wait(std::move(sndr));
+  REQUIRE(result);
+  auto [response] = result.value();
+  CHECK(response.endpoint().address().to_string() == "127.0.0.1");
+  CHECK(response.endpoint().port() == 80);
+}
+
+TEST_CASE("async::resolve - Numeric results take the names of the query", "[net][resolve][first]") {
+  // Long enough to not fit into the small string buffer.
+  sio::ip::resolver_query query{sio::ip::tcp::v6(), "2001:db8:85a3::8a2e:370:7334", "8080"};
+  const char* host_name = query.host_name().data();
+  auto sndr = sio::first(sio::async::resolve(std::move(query)));
+  auto result = stdexec::sync_wait(std::move(sndr));
+  REQUIRE(result);
+  // Bound by reference, since a copy of the result would copy the names again.
+  auto& [response] = *result;
+  CHECK(response.endpoint().port() == 8080);
+  CHECK(response.host_name() == "2001:db8:85a3::8a2e:370:7334");
+  CHECK(response.host_name().data() == host_name);
+}
+
+TEST_CASE("async::resolve_many - Resolve several queries at once", "[net][resolve][resolve_many]") {
+  std::array<sio::ip::resolver_query, 3> queries{
+    sio::ip::resolver_query{sio::ip::tcp::v4(), "localhost", "80"},
+    sio::ip::resolver_query{sio::ip::tcp::v6(), "localhost", "81"},
+    sio::ip::resolver_query{sio::ip::tcp::v4(), "127.0.0.2", "82"}};
+  std::vector<std::size_t> indices{};
+  auto sndr = sio::async::resolve_many(queries)
+            | sio::then_each([&](std::size_t index, sio::ip::resolver_result result) {
+                CHECK(result.endpoint().port() == 80 + index);
+                indices.push_back(index);
+              })
+            | sio::ignore_all();
+  CHECK(stdexec::sync_wait(std::move(sndr)));
+  REQUIRE(indices.size() >= 3);
+  CHECK(std::is_sorted(indices.begin(), indices.end()));
+  CHECK(indices.front() == 0);
+  CHECK(indices.back() == 2);
+}
+
+TEST_CASE("async::resolve_many - Report failed queries", "[net][resolve][resolve_many]") {
+  std::array<sio::ip::resolver_query, 2> queries{
+    sio::ip::resolver_query{sio::ip::tcp::v4(), "does-not-exist.invalid", "80"},
+    sio::ip::resolver_query{sio::ip::tcp::v4(), "localhost", "80"}};
+  int count = 0;
+  auto sndr = sio::async::resolve_many(queries)
+            | sio::then_each([&](std::size_t index, sio::ip::resolver_result) {
+                CHECK(index == 1);
+                ++count;
+              })
+            | sio::ignore_all();
+  CHECK_THROWS(stdexec::sync_wait(std::move(sndr)));
+  CHECK(count >= 1);
+}
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2024 Maikel Nadolski
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <catch2/catch_all.hpp>
+#include <exec/sequence_senders.hpp>
+
+#include "sio/ip/resolver_cache.hpp"
+#include "sio/ip/tcp.hpp"
+#include "sio/sequence/first.hpp"
+#include "sio/sequence/ignore_all.hpp"
+#include "sio/with_env.hpp"
+
+TEST_CASE("resolver_cache - second lookup is served from cache", "[net][resolve][resolver_cache]") {
+  sio::ip::resolver_cache cache{};
+  for (int i = 0; i < 2; ++i) {
+    auto sndr = sio::first(sio::async::resolve(cache, sio::ip::tcp::v4(), "localhost", "80"));
+    auto result = stdexec::sync_wait(std::move(sndr));
+    REQUIRE(result);
+    auto [response] = result.value();
+    CHECK(response.endpoint().address().to_string() == "127.0.0.1");
+  }
+  sio::ip::resolver_cache_statistics stats = cache.statistics();
+  CHECK(stats.misses == 1);
+  CHECK(stats.hits == 1);
+  CHECK(stats.entries == 1);
+}
+
+TEST_CASE("resolver_cache - expired entries are resolved again", "[net][resolve][resolver_cache]") {
+  sio::ip::resolver_cache cache{sio::ip::resolver_cache_options{.ttl = std::chrono::seconds(0)}};
+  for (int i = 0; i < 2; ++i) {
+    auto sndr = sio::first(sio::async::resolve(cache, sio::ip::tcp::v4(), "localhost", "80"));
+    CHECK(stdexec::sync_wait(std::move(sndr)));
+  }
+  sio::ip::resolver_cache_statistics stats = cache.statistics();
+  CHECK(stats.misses == 2);
+  CHECK(stats.hits == 0);
+}
+
+TEST_CASE("resolver_cache - concurrent lookups share a request", "[net][resolve][resolver_cache]") {
+  sio::ip::resolver_cache cache{};
+  auto lookup = [&] {
+    return sio::first(sio::async::resolve(cache, sio::ip::tcp::v4(), "localhost", "80"));
+  };
+  auto result = stdexec::sync_wait(stdexec::when_all(lookup(), lookup()));
+  REQUIRE(result);
+  auto [r1, r2] = result.value();
+  CHECK(r1.endpoint() == r2.endpoint());
+  sio::ip::resolver_cache_statistics stats = cache.statistics();
+  CHECK(stats.misses == 1);
+  CHECK(stats.hits + stats.coalesced == 1);
+}
+
+TEST_CASE("resolver_cache - a stopped lookup does not wait", "[net][resolve][resolver_cache]") {
+  sio::ip::resolver_cache cache{};
+  stdexec::inplace_stop_source stop_source{};
+  stop_source.request_stop();
+  bool stopped = false;
+  auto lookup = [&] {
+    return sio::first(sio::async::resolve(cache, sio::ip::tcp::v4(), "localhost", "80"));
+  };
+  auto stopped_lookup =
+    sio::with_env(
+      exec::make_env(exec::with(stdexec::get_stop_token, stop_source.get_token())),
+      sio::async::resolve(cache, sio::ip::tcp::v4(), "localhost", "80") | sio::ignore_all())
+    | stdexec::upon_stopped([&] { stopped = true; });
+  // The second lookup is stopped before it would join the first one.
+  auto result = stdexec::sync_wait(stdexec::when_all(lookup(), std::move(stopped_lookup)));
+  REQUIRE(result);
+  CHECK(stopped);
+  sio::ip::resolver_cache_statistics stats = cache.statistics();
+  CHECK(stats.misses == 1);
+  CHECK(stats.hits + stats.coalesced == 0);
+}
+
+TEST_CASE("resolver_cache - failed lookups are cached", "[net][resolve][resolver_cache]") {
+  sio::ip::resolver_cache cache{};
+  auto lookup = [&] {
+    return sio::async::resolve(cache, sio::ip::tcp::v4(), "does-not-exist.invalid", "80")
+         | sio::ignore_all();
+  };
+  CHECK_THROWS(stdexec::sync_wait(lookup()));
+  CHECK_THROWS(stdexec::sync_wait(lookup()));
+  sio::ip::resolver_cache_statistics stats = cache.statistics();
+  CHECK(stats.misses == 1);
+  CHECK(stats.hits == 1);
+}
@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2024 Maikel Nadolski
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "sio/io_uring/stub_resolver.hpp"
+#include "sio/ip/tcp.hpp"
+#include "sio/sequence/first.hpp"
+
+#include <catch2/catch_all.hpp>
+
+#include <stdexec/execution.hpp>
+#include <exec/when_any.hpp>
+
+#include <array>
+#include <cstring>
+#include <thread>
+
+namespace {
+  template <class Sender>
+  std::optional<sio::ip::resolver_result>
+    resolve_one(exec::io_uring_context& context, Sender&& sender) {
+    std::optional<sio::ip::resolver_result> result{};
+    stdexec::sync_wait(exec::when_any(
+      stdexec::then(
+        sio::first(std::forward<Sender>(sender)),
+        [&](sio::ip::resolver_result r) { result = std::move(r); }),
+      context.run(exec::until::stopped)));
+    return result;
+  }
+
+  // Answers a single query with an A record for 10.1.2.3.
+  void serve_one_query(int fd) {
+    std::array<std::byte, 512> message{};
+    ::sockaddr_storage peer{};
+    ::socklen_t peer_size = sizeof(peer);
+    ::ssize_t n = ::recvfrom(
+      fd, message.data(), message.size(), 0, reinterpret_cast<::sockaddr*>(&peer), &peer_size);
+    if (n < 12) {
+      return;
+    }
+    std::size_t size = static_cast<std::size_t>(n);
+    message[2] = std::byte{0x81};
+    message[3] = std::byte{0x80};
+    message[7] = std::byte{1};
+    const std::array<std::byte, 16> answer{
+      std::byte{0xc0}, std::byte{0x0c}, // pointer to the question name
+      std::byte{0},    std::byte{1},    // A
+      std::byte{0},    std::byte{1},    // IN
+      std::byte{0},    std::byte{0},    std::byte{0}, std::byte{60},
+      std::byte{0},    std::byte{4},    // rdlength
+      std::byte{10},   std::byte{1},    std::byte{2}, std::byte{3}};
+    std::memcpy(message.data() + size, answer.data(), answer.size());
+    size += answer.size();
+    ::sendto(fd, message.data(), size, 0, reinterpret_cast<::sockaddr*>(&peer), peer_size);
+  }
+}
+
+TEST_CASE("dns - parse resolv.conf", "[net][dns]") {
+  auto conf = sio::ip::dns::resolv_conf::parse(
+    "# comment\n"
+    "nameserver 192.0.2.1\n"
+    "nameserver 2001:db8::1 ; trailing comment\n"
+    "search example.com example.org\n"
+    "options ndots:2 timeout:1 attempts:3 rotate\n");
+  REQUIRE(conf.nameservers.size() == 2);
+  CHECK(conf.nameservers[0].address().to_string() == "192.0.2.1");
+  CHECK(conf.nameservers[0].port() == 53);
+  CHECK(conf.nameservers[1].address().is_v6());
+  CHECK(conf.search == std::vector<std::string>{"example.com", "example.org"});
+  CHECK(conf.ndots == 2);
+  CHECK(conf.timeout == std::chrono::seconds(1));
+  CHECK(conf.attempts == 3);
+  CHECK(
+    conf.candidate_names("www")
+    == std::vector<std::string>{"www.example.com", "www.example.org", "www"});
+  CHECK(
+    conf.candidate_names("www.a.b")
+    == std::vector<std::string>{"www.a.b", "www.a.b.example.com", "www.a.b.example.org"});
+  CHECK(conf.candidate_names("www.") == std::vector<std::string>{"www"});
+}
+
+TEST_CASE("dns - encode query and decode response", "[net][dns]") {
+  std::array<std::byte, sio::ip::dns::max_udp_message_size> buffer{};
+  std::size_t size =
+    sio::ip::dns::encode_query(buffer, 0x1234, "example.com", sio::ip::dns::record_type::a);
+  CHECK(size == 12 + 13 + 4);
+  CHECK(buffer[12] == std::byte{7});
+  CHECK(buffer[20] == std::byte{3});
+
+  std::vector<sio::ip::address> addresses{};
+  CHECK(
+    sio::ip::dns::decode_response(std::span{buffer.data(), size}, 0x1234, addresses)
+    == std::make_error_code(std::errc::bad_message));
+
+  buffer[2] = std::byte{0x81};
+  buffer[3] = std::byte{0x83};
+  CHECK(
+    sio::ip::dns::decode_response(std::span{buffer.data(), size}, 0x1234, addresses)
+    == sio::ip::gaierrc::unknown_name);
+  CHECK(addresses.empty());
+}
+
+TEST_CASE("stub_resolver - numeric hosts and hosts file", "[net][resolve][stub_resolver]") {
+  exec::io_uring_context context{};
+  sio::io_uring::stub_resolver resolver{
+    context,
+    sio::ip::dns::resolv_conf{},
+    sio::ip::dns::hosts_file::parse("10.0.0.7 myhost myhost.local\n")};
+
+  // Neither lookup needs any I/O and both complete inline.
+  auto numeric = stdexec::sync_wait(
+    sio::first(sio::async::resolve(resolver, sio::ip::tcp::v4(), "192.0.2.10", "80")));
+  REQUIRE(numeric);
+  auto [r1] = numeric.value();
+  CHECK(r1.endpoint().address().to_string() == "192.0.2.10");
+  CHECK(r1.endpoint().port() == 80);
+
+  auto hosts = stdexec::sync_wait(
+    sio::first(sio::async::resolve(resolver, sio::ip::tcp::v4(), "MyHost.local", "80")));
+  REQUIRE(hosts);
+  auto [r2] = hosts.value();
+  CHECK(r2.endpoint().address().to_string() == "10.0.0.7");
+  CHECK(r2.endpoint().port() == 80);
+}
+
+TEST_CASE("stub_resolver - query a name server", "[net][resolve][stub_resolver]") {
+  int fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+  REQUIRE(fd != -1);
+  sio::ip::endpoint server{sio::ip::address_v4::loopback(), 0};
+  REQUIRE(::bind(fd, server.data(), server.size()) == 0);
+  ::socklen_t size = server.size();
+  REQUIRE(::getsockname(fd, server.data(), &size) == 0);
+  ::timeval timeout{.tv_sec = 5, .tv_usec = 0};
+  REQUIRE(::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) == 0);
+  std::thread thread{[fd] { serve_one_query(fd); }};
+
+  exec::io_uring_context context{};
+  sio::ip::dns::resolv_conf conf{};
+  conf.nameservers.push_back(server);
+  conf.attempts = 1;
+  sio::io_uring::stub_resolver resolver{context, conf};
+  auto result = resolve_one(
+    context, sio::async::resolve(resolver, sio::ip::tcp::v4(), "service.test.", "443"));
+  thread.join();
+  ::close(fd);
+  REQUIRE(result);
+  CHECK(result->endpoint().address().to_string() == "10.1.2.3");
+  CHECK(result->endpoint().port() == 443);
+}
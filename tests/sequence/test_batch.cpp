@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2024 Maikel Nadolski
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "sio/sequence/batch.hpp"
+#include "sio/sequence/ignore_all.hpp"
+#include "sio/sequence/iterate.hpp"
+#include "sio/sequence/let_value_each.hpp"
+#include "sio/sequence/then_each.hpp"
+#include "sio/with_env.hpp"
+
+#include <catch2/catch_all.hpp>
+
+#include <exec/linux/io_uring_context.hpp>
+#include <exec/when_any.hpp>
+
+#include <array>
+#include <chrono>
+#include <ranges>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace {
+  template <stdexec::sender Sender>
+  void sync_wait(exec::io_uring_context& context, Sender&& sender) {
+    auto env = exec::make_env(exec::with(stdexec::get_scheduler, context.get_scheduler()));
+    stdexec::sync_wait(exec::when_any(
+      sio::with_env(env, std::forward<Sender>(sender)), context.run(exec::until::stopped)));
+  }
+}
+
+TEST_CASE("batch - emits full batches and the rest at the end", "[sequence][batch]") {
+  exec::io_uring_context context{};
+  std::array<int, 5> arr{1, 2, 3, 4, 5};
+  std::vector<std::vector<int>> batches{};
+  auto sndr = sio::iterate(std::views::all(arr)) //
+            | sio::batch(2, 10s)                 //
+            | sio::then_each([&](std::vector<int> batch) { batches.push_back(std::move(batch)); })
+            | sio::ignore_all();
+  ::sync_wait(context, std::move(sndr));
+  REQUIRE(batches.size() == 3);
+  CHECK(batches[0] == std::vector{1, 2});
+  CHECK(batches[1] == std::vector{3, 4});
+  CHECK(batches[2] == std::vector{5});
+}
+
+TEST_CASE("batch - emits a partial batch after max_delay", "[sequence][batch]") {
+  exec::io_uring_context context{};
+  auto scheduler = context.get_scheduler();
+  std::array<int, 2> arr{1, 2};
+  std::vector<std::vector<int>> batches{};
+  auto sndr = sio::iterate(std::views::all(arr)) //
+            | sio::let_value_each([scheduler](int value) {
+                auto delay = value == 2 ? 200ms : 0ms;
+                return exec::schedule_after(scheduler, delay)
+                     | stdexec::then([value] { return value; });
+              })                  //
+            | sio::batch(4, 10ms) //
+            | sio::then_each([&](std::vector<int> batch) { batches.push_back(std::move(batch)); })
+            | sio::ignore_all();
+  ::sync_wait(context, std::move(sndr));
+  REQUIRE(batches.size() == 2);
+  CHECK(batches[0] == std::vector{1});
+  CHECK(batches[1] == std::vector{2});
+}
+
+TEST_CASE("batch - a full batch does not shorten the delay of the next", "[sequence][batch]") {
+  exec::io_uring_context context{};
+  auto scheduler = context.get_scheduler();
+  std::array<int, 4> arr{1, 2, 3, 4};
+  using clock = std::chrono::steady_clock;
+  clock::time_point arrived{};
+  std::vector<std::vector<int>> batches{};
+  std::vector<clock::duration> waited{};
+  auto sndr = sio::iterate(std::views::all(arr)) //
+            | sio::let_value_each([scheduler, &arrived](int value) {
+                auto delay = value == 3 ? 30ms : value == 4 ? 200ms : 0ms;
+                return exec::schedule_after(scheduler, delay) //
+                     | stdexec::then([value, &arrived] {
+                         arrived = clock::now();
+                         return value;
+                       });
+              })                  //
+            | sio::batch(2, 50ms) //
+            | sio::then_each([&](std::vector<int> batch) {
+                waited.push_back(clock::now() - arrived);
+                batches.push_back(std::move(batch));
+              })
+            | sio::ignore_all();
+  ::sync_wait(context, std::move(sndr));
+  REQUIRE(batches.size() == 3);
+  CHECK(batches[0] == std::vector{1, 2});
+  CHECK(batches[1] == std::vector{3});
+  CHECK(batches[2] == std::vector{4});
+  CHECK(waited[1] >= 45ms);
+}
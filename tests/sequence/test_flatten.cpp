@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2024 Maikel Nadolski
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "sio/sequence/flatten.hpp"
+#include "sio/sequence/first.hpp"
+#include "sio/sequence/ignore_all.hpp"
+#include "sio/sequence/iterate.hpp"
+#include "sio/sequence/let_value_each.hpp"
+#include "sio/sequence/then_each.hpp"
+
+#include <catch2/catch_all.hpp>
+
+#include <exec/linux/io_uring_context.hpp>
+#include <exec/when_any.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <ranges>
+
+namespace {
+  auto inner_sequences(std::array<std::array<int, 2>, 3>& arrays) {
+    return sio::iterate(std::views::all(arrays)) //
+         | sio::then_each([](std::array<int, 2>& array) {
+             return sio::iterate(std::views::all(array));
+           });
+  }
+
+  // Every item of the inner sequences waits for a timer. Items of one inner sequence run one
+  // after the other, so the number of items in flight is the number of active inner sequences.
+  struct in_flight_counter {
+    int current_{0};
+    int max_{0};
+  };
+
+  template <class Scheduler>
+  auto delayed_inner_sequences(
+    std::array<std::array<int, 2>, 4>& arrays,
+    Scheduler scheduler,
+    in_flight_counter& counter) {
+    return sio::iterate(std::views::all(arrays)) //
+         | sio::then_each([scheduler, &counter](std::array<int, 2>& array) {
+             return sio::iterate(std::views::all(array))
+                  | sio::let_value_each([scheduler, &counter](int value) {
+                      counter.current_ += 1;
+                      counter.max_ = std::max(counter.max_, counter.current_);
+                      return exec::schedule_after(scheduler, std::chrono::milliseconds(10))
+                           | stdexec::then([value, &counter] {
+                               counter.current_ -= 1;
+                               return value;
+                             });
+                    });
+           });
+  }
+}
+
+TEST_CASE("flatten - iterate over iterates", "[sio][flatten][iterate]") {
+  std::array<std::array<int, 2>, 3> arrays{{{1, 2}, {3, 4}, {5, 6}}};
+  int count = 0;
+  int sum = 0;
+  auto sndr = inner_sequences(arrays) //
+            | sio::flatten(2)         //
+            | sio::then_each([&](int value) {
+                ++count;
+                sum += value;
+              })
+            | sio::ignore_all();
+  CHECK(stdexec::sync_wait(std::move(sndr)));
+  CHECK(count == 6);
+  CHECK(sum == 21);
+}
+
+TEST_CASE("flatten - first stops the inner and outer sequences", "[sio][flatten][first]") {
+  std::array<std::array<int, 2>, 3> arrays{{{1, 2}, {3, 4}, {5, 6}}};
+  auto sndr = inner_sequences(arrays) | sio::flatten() | sio::first();
+  auto [v] = stdexec::sync_wait(std::move(sndr)).value();
+  CHECK(v == 1);
+}
+
+TEST_CASE("flatten - inner sequences run concurrently", "[sio][flatten][iterate]") {
+  exec::io_uring_context context{};
+  std::array<std::array<int, 2>, 4> arrays{{{1, 2}, {3, 4}, {5, 6}, {7, 8}}};
+  in_flight_counter counter{};
+  int sum = 0;
+  auto sndr = delayed_inner_sequences(arrays, context.get_scheduler(), counter) //
+            | sio::flatten()                                                    //
+            | sio::then_each([&](int value) { sum += value; })
+            | sio::ignore_all();
+  stdexec::sync_wait(exec::when_any(std::move(sndr), context.run(exec::until::stopped)));
+  CHECK(sum == 36);
+  CHECK(counter.max_ == 4);
+}
+
+TEST_CASE("flatten - max_concurrency bounds the active inner sequences", "[sio][flatten]") {
+  exec::io_uring_context context{};
+  std::array<std::array<int, 2>, 4> arrays{{{1, 2}, {3, 4}, {5, 6}, {7, 8}}};
+  in_flight_counter counter{};
+  int sum = 0;
+  auto sndr = delayed_inner_sequences(arrays, context.get_scheduler(), counter) //
+            | sio::flatten(2)                                                   //
+            | sio::then_each([&](int value) { sum += value; })
+            | sio::ignore_all();
+  stdexec::sync_wait(exec::when_any(std::move(sndr), context.run(exec::until::stopped)));
+  CHECK(sum == 36);
+  CHECK(counter.max_ == 2);
+}
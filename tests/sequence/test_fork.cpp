@@ -1,3 +1,4 @@
+#include "sio/arena_resource.hpp"
 #include "sio/sequence/first.hpp"
 #include "sio/sequence/fork.hpp"
 #include "sio/sequence/any_sequence_of.hpp"
@@ -5,13 +6,19 @@
 #include "sio/sequence/iterate.hpp"
 #include "sio/sequence/last.hpp"
 #include "sio/sequence/let_value_each.hpp"
+#include "sio/sequence/scan.hpp"
 #include "sio/sequence/then_each.hpp"
+#include "sio/with_env.hpp"
+#include "common/counting_resource.hpp"
 
 #include <catch2/catch_all.hpp>
 
 #include <exec/sequence/ignore_all_values.hpp>
 #include <exec/sequence_senders.hpp>
 
+#include <array>
+#include <ranges>
+
 TEST_CASE("fork - with iterate", "[sio][fork]") {
   std::array<int, 3> arr{1, 2, 3};
   auto iterate = sio::iterate(arr);
@@ -39,6 +46,55 @@ TEST_CASE("fork - with then_each and ignore_all", "[sio][fork]") {
   stdexec::sync_wait(std::move(sndr));
 }
 
+TEST_CASE("fork - item operations are reused", "[sio][fork]") {
+  counting_resource resource{};
+  auto env = exec::make_env(
+    exec::with(sio::async::get_allocator, sio::resource_allocator<char>{&resource}));
+  int sum = 0;
+  std::array<int, 100> arr{};
+  arr.fill(1);
+  auto sndr = sio::iterate(std::views::all(arr))         //
+            | sio::fork()                                //
+            | sio::then_each([&](int i) { sum += i; }) //
+            | sio::ignore_all();
+  stdexec::sync_wait(sio::with_env(env, std::move(sndr)));
+  CHECK(sum == 100);
+  // Every item completes inline before the next one is forked.
+  CHECK(resource.allocations_ == 1);
+  CHECK(resource.live_ == 0);
+}
+
+TEST_CASE("fork - with an asynchronous allocator", "[sio][fork]") {
+  STATIC_REQUIRE(sio::async::sync_allocator<sio::async::new_delete_allocator<int>>);
+  STATIC_REQUIRE(sio::async::sync_allocator<sio::resource_allocator<int>>);
+  STATIC_REQUIRE(!sio::async::sync_allocator<sio::memory_pool_allocator<int>>);
+  sio::memory_pool pool{};
+  auto env = exec::make_env(
+    exec::with(sio::async::get_allocator, sio::memory_pool_allocator<char>{&pool}));
+  int sum = 0;
+  std::array<int, 10> arr{};
+  arr.fill(1);
+  auto sndr = sio::iterate(std::views::all(arr))         //
+            | sio::fork()                                //
+            | sio::then_each([&](int i) { sum += i; }) //
+            | sio::ignore_all();
+  stdexec::sync_wait(sio::with_env(env, std::move(sndr)));
+  CHECK(sum == 10);
+}
+
+TEST_CASE("fork - the allocator is forwarded by downstream adaptors", "[sio][fork]") {
+  counting_resource resource{};
+  auto env = exec::make_env(
+    exec::with(sio::async::get_allocator, sio::resource_allocator<char>{&resource}));
+  std::array<int, 3> arr{1, 2, 3};
+  auto sndr = sio::scan(sio::iterate(std::views::all(arr)) | sio::fork(), 0) //
+            | sio::last();
+  auto [sum] = stdexec::sync_wait(sio::with_env(env, std::move(sndr))).value();
+  CHECK(sum == 6);
+  CHECK(resource.allocations_ > 0);
+  CHECK(resource.live_ == 0);
+}
+
 // FIX: first and last can't stop fork.
 // TEST_CASE("fork - with iterate and first", "[sio][fork]") {
 //   std::array<int, 3> arr{1, 2, 3};
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2024 Maikel Nadolski
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "sio/sequence/fork_ordered.hpp"
+#include "sio/arena_resource.hpp"
+#include "sio/sequence/first.hpp"
+#include "sio/sequence/ignore_all.hpp"
+#include "sio/sequence/iterate.hpp"
+#include "sio/sequence/let_value_each.hpp"
+#include "sio/sequence/then_each.hpp"
+#include "sio/with_env.hpp"
+#include "common/counting_resource.hpp"
+
+#include <catch2/catch_all.hpp>
+
+#include <exec/linux/io_uring_context.hpp>
+#include <exec/when_any.hpp>
+
+#include <array>
+#include <chrono>
+#include <ranges>
+#include <vector>
+
+TEST_CASE("fork_ordered - emits items in input order", "[sequence][fork_ordered]") {
+  std::array<int, 5> arr{1, 2, 3, 4, 5};
+  std::vector<int> values{};
+  auto sndr = sio::iterate(std::views::all(arr)) //
+            | sio::fork_ordered(2)               //
+            | sio::then_each([&](int value) { values.push_back(value); })
+            | sio::ignore_all();
+  CHECK(stdexec::sync_wait(std::move(sndr)));
+  CHECK(values == std::vector{1, 2, 3, 4, 5});
+}
+
+TEST_CASE("fork_ordered - later items may finish first", "[sequence][fork_ordered]") {
+  exec::io_uring_context context{};
+  auto scheduler = context.get_scheduler();
+  std::array<int, 4> arr{40, 30, 20, 10};
+  std::vector<int> completed{};
+  std::vector<int> values{};
+  auto sndr = sio::iterate(std::views::all(arr)) //
+            | sio::let_value_each([scheduler, &completed](int value) {
+                return exec::schedule_after(scheduler, std::chrono::milliseconds(value))
+                     | stdexec::then([value, &completed] {
+                         completed.push_back(value);
+                         return value;
+                       });
+              })                   //
+            | sio::fork_ordered(4) //
+            | sio::then_each([&](int value) { values.push_back(value); })
+            | sio::ignore_all();
+  stdexec::sync_wait(exec::when_any(std::move(sndr), context.run(exec::until::stopped)));
+  // All delays ran concurrently, so the shortest finished first, but the items are emitted in
+  // input order.
+  CHECK(completed == std::vector{10, 20, 30, 40});
+  CHECK(values == std::vector{40, 30, 20, 10});
+}
+
+TEST_CASE("fork_ordered - first stops the sequence", "[sequence][fork_ordered][first]") {
+  std::array<int, 5> arr{1, 2, 3, 4, 5};
+  auto sndr = sio::iterate(std::views::all(arr)) | sio::fork_ordered(3) | sio::first();
+  auto [v] = stdexec::sync_wait(std::move(sndr)).value();
+  CHECK(v == 1);
+}
+
+TEST_CASE("fork_ordered - slots use the allocator of the env", "[sequence][fork_ordered]") {
+  counting_resource resource{};
+  auto env = exec::make_env(
+    exec::with(sio::async::get_allocator, sio::resource_allocator<char>{&resource}));
+  std::array<int, 5> arr{1, 2, 3, 4, 5};
+  std::vector<int> values{};
+  auto sndr = sio::iterate(std::views::all(arr)) //
+            | sio::fork_ordered(2)               //
+            | sio::then_each([&](int value) { values.push_back(value); })
+            | sio::ignore_all();
+  CHECK(stdexec::sync_wait(sio::with_env(env, std::move(sndr))));
+  CHECK(values == std::vector{1, 2, 3, 4, 5});
+  CHECK(resource.allocations_ == 1);
+  CHECK(resource.live_ == 0);
+}
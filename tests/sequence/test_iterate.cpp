@@ -13,13 +13,20 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
-
 #include "sio/sequence/iterate.hpp"
-
 #include "sio/sequence/first.hpp"
+#include "sio/sequence/fork.hpp"
+#include "sio/sequence/ignore_all.hpp"
+#include "sio/sequence/then_each.hpp"
 
 #include <catch2/catch_all.hpp>
 
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <span>
+#include <vector>
+
 TEST_CASE("iterate - with just sender", "[sequence][iterate][first]") {
   std::array<int, 1> arr{42};
   auto iterate = sio::first(sio::iterate(arr));
@@ -32,4 +39,37 @@ TEST_CASE("iterate - with just sender and back binder", "[sequence][iterate][fir
   auto iterate = sio::iterate(arr) | sio::first();
   auto [front] = stdexec::sync_wait(iterate).value();
   REQUIRE(front == 42);
-}
\ No newline at end of file
+}
+
+TEST_CASE("iterate_chunked - emits spans of up to chunk elements", "[sequence][iterate]") {
+  std::vector<int> values{1, 2, 3, 4, 5, 6, 7};
+  std::vector<std::vector<int>> chunks{};
+  auto sndr = sio::iterate_chunked(values, 3) //
+            | sio::then_each([&](std::span<int> chunk) {
+                chunks.emplace_back(chunk.begin(), chunk.end());
+              })
+            | sio::ignore_all();
+  CHECK(stdexec::sync_wait(std::move(sndr)));
+  REQUIRE(chunks.size() == 3);
+  CHECK(chunks[0] == std::vector{1, 2, 3});
+  CHECK(chunks[1] == std::vector{4, 5, 6});
+  CHECK(chunks[2] == std::vector{7});
+}
+
+TEST_CASE("iterate_chunked - fork processes a chunk per item", "[sequence][iterate][fork]") {
+  std::vector<int> values(1000, 1);
+  std::atomic<int> sum{0};
+  std::atomic<int> n_items{0};
+  auto sndr = sio::iterate_chunked(values, 100) //
+            | sio::fork()                       //
+            | sio::then_each([&](std::span<int> chunk) {
+                n_items.fetch_add(1);
+                for (int value: chunk) {
+                  sum.fetch_add(value);
+                }
+              })
+            | sio::ignore_all();
+  CHECK(stdexec::sync_wait(std::move(sndr)));
+  CHECK(n_items == 10);
+  CHECK(sum == 1000);
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2024 Maikel Nadolski
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "sio/sequence/prefetch.hpp"
+#include "sio/sequence/ignore_all.hpp"
+#include "sio/sequence/iterate.hpp"
+#include "sio/sequence/let_value_each.hpp"
+#include "sio/sequence/then_each.hpp"
+
+#include <catch2/catch_all.hpp>
+
+#include <exec/linux/io_uring_context.hpp>
+#include <exec/when_any.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <ranges>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+TEST_CASE("prefetch - the input runs ahead of the receiver", "[sequence][prefetch]") {
+  std::array<int, 6> arr{1, 2, 3, 4, 5, 6};
+  int produced = 0;
+  std::vector<int> values{};
+  std::vector<int> produced_before{};
+  auto sndr = sio::iterate(std::views::all(arr)) //
+            | sio::then_each([&](int value) {
+                ++produced;
+                return value;
+              })               //
+            | sio::prefetch(3) //
+            | sio::then_each([&](int value) {
+                values.push_back(value);
+                produced_before.push_back(produced);
+              })
+            | sio::ignore_all();
+  CHECK(stdexec::sync_wait(std::move(sndr)));
+  CHECK(values == std::vector{1, 2, 3, 4, 5, 6});
+  // The input is at most three items ahead of the item that is processed.
+  for (std::size_t i = 0; i < values.size(); ++i) {
+    CHECK(produced_before[i] >= values[i]);
+    CHECK(produced_before[i] <= values[i] + 2);
+  }
+}
+
+TEST_CASE("prefetch - with an asynchronous receiver", "[sequence][prefetch]") {
+  exec::io_uring_context context{};
+  auto scheduler = context.get_scheduler();
+  std::array<int, 6> arr{1, 2, 3, 4, 5, 6};
+  int produced = 0;
+  std::vector<int> values{};
+  std::vector<int> produced_before{};
+  auto sndr = sio::iterate(std::views::all(arr)) //
+            | sio::then_each([&](int value) {
+                ++produced;
+                return value;
+              })               //
+            | sio::prefetch(3) //
+            | sio::let_value_each([&, scheduler](int value) {
+                produced_before.push_back(produced);
+                return exec::schedule_after(scheduler, 5ms)
+                     | stdexec::then([&values, value] { values.push_back(value); });
+              })
+            | sio::ignore_all();
+  stdexec::sync_wait(exec::when_any(std::move(sndr), context.run(exec::until::stopped)));
+  CHECK(values == std::vector{1, 2, 3, 4, 5, 6});
+  REQUIRE(produced_before.size() == values.size());
+  int max_ahead = 0;
+  for (std::size_t i = 0; i < values.size(); ++i) {
+    CHECK(produced_before[i] >= values[i]);
+    CHECK(produced_before[i] <= values[i] + 2);
+    max_ahead = std::max(max_ahead, produced_before[i] - values[i]);
+  }
+  // The receiver is slower than the input, so the input fills all slots.
+  CHECK(max_ahead == 2);
+}
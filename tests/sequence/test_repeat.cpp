@@ -18,24 +18,104 @@
 #include "sio/sequence/ignore_all.hpp"
 #include "sio/sequence/iterate.hpp"
 #include "sio/sequence/repeat.hpp"
+#include "sio/sequence/then_each.hpp"
+#include "sio/with_env.hpp"
 
 #include <catch2/catch_all.hpp>
+#include <array>
 #include <ranges>
 
+#include <exec/env.hpp>
 #include <exec/sequence_senders.hpp>
 
+namespace {
+  // Completes inline and counts the calls to schedule.
+  struct counting_scheduler {
+    int* n_schedules_;
 
-// TODO: stack boom😂
-
-// TEST_CASE("repeat - with ignore_all", "[sio][repeat]") {
-//   auto repeat = sio::repeat(stdexec::just(42));
-//   auto ignore = sio::ignore_all(std::move(repeat));
-//   stdexec::sync_wait(std::move(ignore));
-// }
-//
-// TEST_CASE("repeat - with iterate", "[sio][repeat][iterate]") {
-//   std::array<int, 3> arr{1, 2, 3};
-//   auto repeat = sio::repeat(sio::iterate(std::views::all(arr)));
-//   auto ignore = sio::ignore_all(std::move(repeat));
-//   stdexec::sync_wait(std::move(ignore));
-// }
+    struct sender {
+      using sender_concept = stdexec::sender_t;
+      using completion_signatures = stdexec::completion_signatures<stdexec::set_value_t()>;
+
+      int* n_schedules_;
+
+      template <class Receiver>
+      auto connect(Receiver rcvr) const {
+        return stdexec::connect(stdexec::just(), static_cast<Receiver&&>(rcvr));
+      }
+
+      auto get_env() const noexcept {
+        return exec::make_env(exec::with(
+          stdexec::get_completion_scheduler<stdexec::set_value_t>,
+          counting_scheduler{n_schedules_}));
+      }
+    };
+
+    auto schedule() const noexcept -> sender {
+      ++*n_schedules_;
+      return {n_schedules_};
+    }
+
+    friend bool operator==(const counting_scheduler&, const counting_scheduler&) = default;
+  };
+
+  template <class Sender>
+  auto with_stop_token(stdexec::inplace_stop_source& stop_source, Sender&& sender) {
+    return sio::with_env(
+      exec::make_env(exec::with(stdexec::get_stop_token, stop_source.get_token())),
+      static_cast<Sender&&>(sender));
+  }
+}
+
+TEST_CASE("repeat - with ignore_all", "[sio][repeat]") {
+  stdexec::inplace_stop_source stop_source{};
+  int count = 0;
+  int mismatches = 0;
+  auto repeat = sio::repeat(stdexec::just(42)) //
+              | sio::then_each([&](int value) {
+                  mismatches += value != 42;
+                  if (++count == 1'000'000) {
+                    stop_source.request_stop();
+                  }
+                });
+  auto ignore = sio::ignore_all(std::move(repeat));
+  stdexec::sync_wait(with_stop_token(stop_source, std::move(ignore)));
+  CHECK(count == 1'000'000);
+  CHECK(mismatches == 0);
+}
+
+TEST_CASE("repeat - with iterate", "[sio][repeat][iterate]") {
+  std::array<int, 3> arr{1, 2, 3};
+  stdexec::inplace_stop_source stop_source{};
+  int sum = 0;
+  auto repeat = sio::repeat(sio::iterate(std::views::all(arr))) //
+              | sio::then_each([&](int value) {
+                  sum += value;
+                  if (sum == 600'000) {
+                    stop_source.request_stop();
+                  }
+                });
+  auto ignore = sio::ignore_all(std::move(repeat));
+  stdexec::sync_wait(with_stop_token(stop_source, std::move(ignore)));
+  CHECK(sum == 600'000);
+}
+
+TEST_CASE("repeat - yields to the scheduler", "[sio][repeat]") {
+  stdexec::inplace_stop_source stop_source{};
+  int count = 0;
+  int n_schedules = 0;
+  auto repeat = sio::repeat(stdexec::just(), 10) //
+              | sio::then_each([&] {
+                  if (++count == 1'000) {
+                    stop_source.request_stop();
+                  }
+                });
+  auto ignore = sio::ignore_all(std::move(repeat));
+  auto env = exec::make_env(
+    exec::with(stdexec::get_stop_token, stop_source.get_token()),
+    exec::with(stdexec::get_scheduler, counting_scheduler{&n_schedules}));
+  stdexec::sync_wait(sio::with_env(env, std::move(ignore)));
+  CHECK(count == 1'000);
+  // One yield before each run of ten iterations but the first.
+  CHECK(n_schedules == 99);
+}
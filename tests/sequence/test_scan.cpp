@@ -25,6 +25,19 @@
 #include <exec/sequence_senders.hpp>
 #include <stdexec/execution.hpp>
 
+namespace {
+  struct max_fn {
+    int operator()(int lhs, int rhs) const noexcept {
+      return lhs < rhs ? rhs : lhs;
+    }
+  };
+}
+
+namespace sio {
+  template <>
+  inline constexpr bool enable_lock_free_scan<max_fn> = true;
+}
+
 TEST_CASE("scan - with just sender and ignore_all back binder", "[sequence][scan][ignore_all]") {
   auto f = sio::scan(stdexec::just(41), 1) | sio::ignore_all();
   stdexec::sync_wait(f);
@@ -63,3 +76,19 @@ TEST_CASE("scan - with multiply function", "[sequence][scan][last][iterate]") {
   auto [x] = stdexec::sync_wait(sndr).value();
   REQUIRE(x == 6);
 }
+
+TEST_CASE("scan - lock-free accumulator after fork", "[sequence][scan][last][fork]") {
+  STATIC_REQUIRE(sio::scan_::lock_free_scannable<int, std::plus<int>>);
+  STATIC_REQUIRE(sio::scan_::lock_free_scannable<int, max_fn>);
+  STATIC_REQUIRE_FALSE(sio::scan_::lock_free_scannable<int, std::minus<int>>);
+  std::array<int, 3> arr{1, 3, 2};
+  auto items = [&] {
+    return sio::iterate(std::ranges::views::all(arr)) | sio::fork();
+  };
+  auto sum = sio::scan(items(), 0, std::plus<int>()) | sio::last();
+  auto [x] = stdexec::sync_wait(sum).value();
+  CHECK(x == 6);
+  auto max = sio::scan(items(), 0, max_fn()) | sio::last();
+  auto [y] = stdexec::sync_wait(max).value();
+  CHECK(y == 3);
+}
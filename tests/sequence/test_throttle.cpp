@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2024 Maikel Nadolski
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "sio/sequence/throttle.hpp"
+#include "sio/sequence/ignore_all.hpp"
+#include "sio/sequence/iterate.hpp"
+#include "sio/sequence/let_value_each.hpp"
+#include "sio/sequence/then_each.hpp"
+#include "sio/with_env.hpp"
+
+#include <catch2/catch_all.hpp>
+
+#include <exec/linux/io_uring_context.hpp>
+#include <exec/when_any.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <ranges>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace {
+  template <stdexec::sender Sender>
+  auto timed_sync_wait(exec::io_uring_context& context, Sender&& sender) {
+    auto env = exec::make_env(exec::with(stdexec::get_scheduler, context.get_scheduler()));
+    auto start = std::chrono::steady_clock::now();
+    stdexec::sync_wait(exec::when_any(
+      sio::with_env(env, std::forward<Sender>(sender)), context.run(exec::until::stopped)));
+    return std::chrono::steady_clock::now() - start;
+  }
+}
+
+TEST_CASE("throttle - paces items after a burst", "[sequence][throttle]") {
+  exec::io_uring_context context{};
+  std::array<int, 5> arr{1, 2, 3, 4, 5};
+  std::vector<int> values{};
+  auto sndr = sio::iterate(std::views::all(arr)) //
+            | sio::throttle(100, 2)              //
+            | sio::then_each([&](int value) { values.push_back(value); })
+            | sio::ignore_all();
+  auto elapsed = timed_sync_wait(context, std::move(sndr));
+  CHECK(values == std::vector{1, 2, 3, 4, 5});
+  // Two items pass right away and the other three wait 10ms each.
+  CHECK(elapsed >= 30ms);
+}
+
+TEST_CASE("throttle - items wait before they are started", "[sequence][throttle]") {
+  exec::io_uring_context context{};
+  std::array<int, 3> arr{1, 2, 3};
+  std::vector<std::chrono::steady_clock::time_point> started{};
+  auto sndr = sio::iterate(std::views::all(arr)) //
+            | sio::let_value_each([&](int value) {
+                started.push_back(std::chrono::steady_clock::now());
+                return stdexec::just(value);
+              })                   //
+            | sio::throttle(20, 1) //
+            | sio::ignore_all();
+  auto elapsed = timed_sync_wait(context, std::move(sndr));
+  REQUIRE(started.size() == 3);
+  // The delay of 50ms per item is spent before the item starts, so the starts are spaced
+  // by it. A small margin allows for the clock reads of the test and of throttle.
+  for (std::size_t i = 1; i < started.size(); ++i) {
+    CHECK(started[i] - started[i - 1] >= 45ms);
+  }
+  CHECK(elapsed >= 100ms);
+}
+
+TEST_CASE("throttle - a burst passes without delay", "[sequence][throttle]") {
+  exec::io_uring_context context{};
+  std::array<int, 3> arr{1, 2, 3};
+  int count = 0;
+  auto sndr = sio::iterate(std::views::all(arr)) //
+            | sio::throttle(1, 3)                //
+            | sio::then_each([&](int) { ++count; })
+            | sio::ignore_all();
+  auto elapsed = timed_sync_wait(context, std::move(sndr));
+  CHECK(count == 3);
+  // Without the burst, the last two items would wait a second each.
+  CHECK(elapsed < 2s);
+}
+
+TEST_CASE("throttle_bytes - meters the number of bytes", "[sequence][throttle]") {
+  exec::io_uring_context context{};
+  std::array<std::size_t, 3> sizes{100, 100, 100};
+  std::size_t total = 0;
+  auto sndr = sio::iterate(std::views::all(sizes)) //
+            | sio::throttle_bytes(10'000, 100)     //
+            | sio::then_each([&](std::size_t n) { total += n; })
+            | sio::ignore_all();
+  auto elapsed = timed_sync_wait(context, std::move(sndr));
+  CHECK(total == 300);
+  // 100 bytes take 10ms at 10'000 bytes per second.
+  CHECK(elapsed >= 20ms);
+}
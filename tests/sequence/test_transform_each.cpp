@@ -18,10 +18,15 @@
 #include "sio/sequence/transform_each.hpp"
 #include "sio/sequence/then_each.hpp"
 #include "sio/sequence/first.hpp"
+#include "sio/sequence/ignore_all.hpp"
 #include "sio/sequence/iterate.hpp"
 
 #include <catch2/catch_all.hpp>
 
+#include <array>
+#include <concepts>
+#include <type_traits>
+
 TEST_CASE("transform_each - with just sender", "[sequence][transform_each]") {
   auto successor = sio::first(
     sio::transform_each(stdexec::just(41), stdexec::then([](int x) { return x + 1; })));
@@ -63,3 +68,48 @@ TEST_CASE("let_value_each - with iterate and binder back", "[sequence][transform
   auto [x] = stdexec::sync_wait(successor).value();
   REQUIRE(x == 42);
 }
+
+TEST_CASE("then_each - adjacent stages are fused", "[sequence][transform_each][iterate]") {
+  std::array<int, 2> array{40, 40};
+  auto iterate = sio::iterate(array);
+  auto fused = iterate                                     //
+             | sio::then_each([](int x) { return x + 1; }) //
+             | sio::then_each([](int x) { return x + 1; });
+  STATIC_REQUIRE(std::same_as<stdexec::__child_of<decltype(fused)>, decltype(iterate)>);
+  auto [x] = stdexec::sync_wait(sio::first(std::move(fused))).value();
+  REQUIRE(x == 42);
+}
+
+TEST_CASE("then_each - fused stages are noexcept if both are", "[sequence][transform_each]") {
+  auto nothrow = [](int x) noexcept { return x + 1; };
+  auto may_throw = [](int x) { return x + 1; };
+  using nothrow_t = decltype(nothrow);
+  using may_throw_t = decltype(may_throw);
+  using sio::then_each_::composed_fn;
+  STATIC_REQUIRE(std::is_nothrow_invocable_v<composed_fn<nothrow_t, nothrow_t>&, int>);
+  STATIC_REQUIRE(!std::is_nothrow_invocable_v<composed_fn<nothrow_t, may_throw_t>&, int>);
+  STATIC_REQUIRE(!std::is_nothrow_invocable_v<composed_fn<may_throw_t, nothrow_t>&, int>);
+}
+
+TEST_CASE("then_each - fused stage after a void stage", "[sequence][transform_each][iterate]") {
+  std::array<int, 2> array{1, 2};
+  int sum = 0;
+  int count = 0;
+  auto sndr = sio::iterate(array)                      //
+            | sio::then_each([&](int x) { sum += x; }) //
+            | sio::then_each([&] { ++count; })         //
+            | sio::ignore_all();
+  stdexec::sync_wait(std::move(sndr));
+  CHECK(sum == 3);
+  CHECK(count == 2);
+}
+
+TEST_CASE("transform_each - fused with let_value_each", "[sequence][transform_each][iterate]") {
+  std::array<int, 2> array{40, 40};
+  auto successor = sio::iterate(array)                                             //
+                 | sio::then_each([](int x) { return x + 1; })                     //
+                 | sio::let_value_each([](int x) { return stdexec::just(x + 1); }) //
+                 | sio::first();
+  auto [x] = stdexec::sync_wait(successor).value();
+  REQUIRE(x == 42);
+}
@@ -20,13 +20,20 @@
 #include "sio/sequence/zip.hpp"
 #include "sio/sequence/iterate.hpp"
 #include "sio/sequence/ignore_all.hpp"
+#include "sio/sequence/let_value_each.hpp"
 #include "sio/sequence/then_each.hpp"
 
 #include <catch2/catch_all.hpp>
 
 #include <exec/sequence_senders.hpp>
+#include <exec/static_thread_pool.hpp>
 #include <stdexec/execution.hpp>
 
+#include <array>
+#include <atomic>
+#include <numeric>
+#include <ranges>
+
 TEST_CASE("zip - with just connects with first", "[zip][first]") {
   auto sequence = sio::zip(stdexec::just(42));
   auto first = sio::first(sequence);
@@ -71,6 +78,49 @@ TEST_CASE("zip - array with array", "[zip][iterate]") {
   CHECK(count == 3);
 }
 
+TEST_CASE("zip - stops with the shortest sequence", "[zip][iterate]") {
+  std::array<int, 3> short_array{1, 2, 3};
+  std::array<int, 5> long_array{1, 2, 3, 4, 5};
+  int count = 0;
+  auto sequence = sio::zip(
+                    sio::iterate(std::views::all(short_array)),
+                    sio::iterate(std::views::all(long_array))) //
+                | sio::then_each([&](int v, int w) {
+                    CHECK(v == w);
+                    ++count;
+                  }) //
+                | sio::ignore_all();
+  stdexec::sync_wait(std::move(sequence));
+  CHECK(count == 3);
+}
+
+TEST_CASE("zip - items and stops arrive on different threads", "[zip][iterate]") {
+  exec::static_thread_pool pool{2};
+  auto scheduler = pool.get_scheduler();
+  std::array<int, 50> short_array{};
+  std::array<int, 100> long_array{};
+  std::iota(short_array.begin(), short_array.end(), 0);
+  std::iota(long_array.begin(), long_array.end(), 0);
+  auto on_pool = [scheduler](int value) {
+    return stdexec::schedule(scheduler) | stdexec::then([value] { return value; });
+  };
+  for (int run = 0; run < 100; ++run) {
+    std::atomic<int> count = 0;
+    std::atomic<int> mismatches = 0;
+    auto sequence = sio::zip(
+                      sio::iterate(std::views::all(short_array)) | sio::let_value_each(on_pool),
+                      sio::iterate(std::views::all(long_array)) | sio::let_value_each(on_pool))
+                  | sio::then_each([&](int v, int w) {
+                      mismatches += v != w;
+                      count += 1;
+                    }) //
+                  | sio::ignore_all();
+    stdexec::sync_wait(std::move(sequence));
+    CHECK(count == 50);
+    CHECK(mismatches == 0);
+  }
+}
+
 // TEST_CASE("zip - a compilcated case", "[zip][iterate][fork]") {
 //   std::array<int, 2> array{42, 43};
 //   int count = 0;
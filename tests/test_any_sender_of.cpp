@@ -0,0 +1,167 @@
+#include "sio/any_sender_of.hpp"
+#include "sio/arena_resource.hpp"
+#include "sio/sequence/any_sequence_of.hpp"
+#include "sio/sequence/ignore_all.hpp"
+#include "sio/sequence/iterate.hpp"
+#include "sio/sequence/then_each.hpp"
+#include "sio/with_env.hpp"
+#include "common/counting_resource.hpp"
+
+#include <catch2/catch_all.hpp>
+
+#include <array>
+#include <exception>
+#include <memory>
+#include <ranges>
+
+namespace {
+  using int_sigs = stdexec::completion_signatures<
+    stdexec::set_value_t(int),
+    stdexec::set_error_t(std::exception_ptr),
+    stdexec::set_stopped_t()>;
+
+  using large_t = std::array<char, 256>;
+
+  // Sums the first byte of every item and records its completion.
+  struct sum_receiver {
+    using receiver_concept = stdexec::receiver_t;
+    counting_resource* resource_;
+    int* sum_;
+    bool* done_;
+
+    template <class Item>
+    friend auto tag_invoke(exec::set_next_t, sum_receiver& self, Item&& item) {
+      return static_cast<Item&&>(item)
+           | stdexec::then([sum = self.sum_](const large_t& value) noexcept { *sum += value[0]; });
+    }
+
+    void set_value() && noexcept {
+      *done_ = true;
+    }
+
+    auto get_env() const noexcept {
+      return exec::make_env(
+        exec::with(sio::async::get_allocator, sio::resource_allocator<char>{resource_}));
+    }
+  };
+}
+
+TEST_CASE("any_sender_of - erase just", "[any_sender_of]") {
+  sio::any_sender_of<int_sigs> sndr = stdexec::just(42);
+  auto [x] = stdexec::sync_wait(std::move(sndr)).value();
+  CHECK(x == 42);
+}
+
+TEST_CASE("any_sender_of - large operations use the allocator of the env", "[any_sender_of]") {
+  using large_t = std::array<char, 256>;
+  using sigs_t = stdexec::completion_signatures<
+    stdexec::set_value_t(large_t),
+    stdexec::set_error_t(std::exception_ptr),
+    stdexec::set_stopped_t()>;
+  counting_resource resource{};
+  large_t value{};
+  value[0] = 'a';
+  sio::any_sender_of<sigs_t> sndr = stdexec::just(value);
+  auto env = exec::make_env(
+    exec::with(sio::async::get_allocator, sio::resource_allocator<char>{&resource}));
+  auto [result] = stdexec::sync_wait(sio::with_env(env, std::move(sndr))).value();
+  CHECK(result[0] == 'a');
+  CHECK(resource.allocations_ == 1);
+  CHECK(resource.live_ == 0);
+}
+
+TEST_CASE("any_sender_of - small operations are stored inline", "[any_sender_of]") {
+  counting_resource resource{};
+  sio::any_sender_of<int_sigs> sndr = stdexec::just(7);
+  auto env = exec::make_env(
+    exec::with(sio::async::get_allocator, sio::resource_allocator<char>{&resource}));
+  auto [x] = stdexec::sync_wait(sio::with_env(env, std::move(sndr))).value();
+  CHECK(x == 7);
+  CHECK(resource.allocations_ == 0);
+}
+
+TEST_CASE("any_sender_of - erased senders see the allocator of the env", "[any_sender_of]") {
+  counting_resource resource{};
+  sio::any_sender_of<int_sigs> sndr =
+    sio::async::get_allocator() | stdexec::then([](sio::resource_allocator<char> alloc) {
+      sio::resource_allocator<int> ints{alloc};
+      int* ptr = ints.sync_new(42);
+      int value = *ptr;
+      ints.sync_delete(ptr);
+      return value;
+    });
+  auto env = exec::make_env(
+    exec::with(sio::async::get_allocator, sio::resource_allocator<char>{&resource}));
+  auto [x] = stdexec::sync_wait(sio::with_env(env, std::move(sndr))).value();
+  CHECK(x == 42);
+  CHECK(resource.allocations_ >= 1);
+  CHECK(resource.live_ == 0);
+}
+
+TEST_CASE("any_sequence_of - erase iterate", "[any_sender_of]") {
+  std::array arr{1, 2, 3};
+  sio::any_sequence_of<int_sigs> seq = sio::iterate(std::views::all(arr));
+  int sum = 0;
+  auto sndr = std::move(seq) | sio::then_each([&sum](int x) noexcept { sum += x; })
+            | sio::ignore_all();
+  stdexec::sync_wait(std::move(sndr));
+  CHECK(sum == 6);
+}
+
+TEST_CASE("any_sequence_of - large items use the allocator of the env", "[any_sender_of]") {
+  std::array arr{1, 2, 3};
+  std::array<char, 256> padding{};
+  // Every item carries a copy of the padding and does not fit inline.
+  sio::any_sequence_of<int_sigs> seq =
+    sio::iterate(std::views::all(arr))
+    | sio::then_each([padding](int x) noexcept { return x + padding[0]; });
+  counting_resource resource{};
+  auto env = exec::make_env(
+    exec::with(sio::async::get_allocator, sio::resource_allocator<char>{&resource}));
+  int sum = 0;
+  auto sndr = std::move(seq) | sio::then_each([&sum](int x) noexcept { sum += x; })
+            | sio::ignore_all();
+  stdexec::sync_wait(sio::with_env(env, std::move(sndr)));
+  CHECK(sum == 6);
+  CHECK(resource.allocations_ >= 3);
+  CHECK(resource.live_ == 0);
+}
+
+TEST_CASE("any_sender_of - senders use the allocator that is passed", "[any_sender_of]") {
+  using large_t = std::array<char, 256>;
+  using sigs_t = stdexec::completion_signatures<
+    stdexec::set_value_t(large_t),
+    stdexec::set_error_t(std::exception_ptr),
+    stdexec::set_stopped_t()>;
+  counting_resource resource{};
+  {
+    sio::any_sender_of<sigs_t> sndr{
+      std::allocator_arg, sio::resource_allocator<char>{&resource}, stdexec::just(large_t{})};
+    CHECK(resource.allocations_ == 1);
+    CHECK(resource.live_ == 1);
+  }
+  CHECK(resource.live_ == 0);
+}
+
+TEST_CASE(
+  "any_sequence_receiver_ref - items use the allocator of the receiver",
+  "[any_sender_of]") {
+  using sigs_t =
+    stdexec::completion_signatures<stdexec::set_value_t(large_t), stdexec::set_stopped_t()>;
+  counting_resource resource{};
+  int sum = 0;
+  bool done = false;
+  sum_receiver rcvr{&resource, &sum, &done};
+  {
+    sio::any_sequence_receiver_ref<sigs_t> ref{rcvr};
+    large_t value{};
+    value[0] = 1;
+    auto next = exec::set_next(ref, stdexec::just(value));
+    CHECK(resource.allocations_ >= 1);
+    CHECK(stdexec::sync_wait(std::move(next)));
+    stdexec::set_value(std::move(ref));
+  }
+  CHECK(sum == 1);
+  CHECK(done);
+  CHECK(resource.live_ == 0);
+}
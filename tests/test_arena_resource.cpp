@@ -0,0 +1,50 @@
+#include "sio/arena_resource.hpp"
+#include "common/counting_resource.hpp"
+
+#include <catch2/catch_all.hpp>
+
+#include <array>
+#include <cstdint>
+
+TEST_CASE("monotonic_buffer_resource - initial buffer and chunks", "[arena_resource]") {
+  counting_resource upstream{};
+  alignas(64) std::array<std::byte, 64> buffer{};
+  sio::monotonic_buffer_resource arena{buffer.data(), buffer.size(), &upstream};
+  void* first = arena.allocate(32, 8);
+  CHECK(first == buffer.data());
+  void* aligned = arena.allocate(8, 32);
+  CHECK(aligned == buffer.data() + 32);
+  CHECK(upstream.live_ == 0);
+
+  void* large = arena.allocate(4000, 64);
+  REQUIRE(large);
+  CHECK(reinterpret_cast<std::uintptr_t>(large) % 64 == 0);
+  CHECK(upstream.live_ == 1);
+
+  // After a reset the initial buffer and the chunk are used again.
+  arena.reset();
+  CHECK(arena.allocate(32, 8) == first);
+  CHECK(arena.allocate(4000, 64) == large);
+  CHECK(upstream.live_ == 1);
+
+  arena.release();
+  CHECK(upstream.live_ == 0);
+}
+
+TEST_CASE("monotonic_buffer_resource - a null upstream bounds the memory", "[arena_resource]") {
+  alignas(64) std::array<std::byte, 64> buffer{};
+  sio::monotonic_buffer_resource arena{
+    buffer.data(), buffer.size(), sio::null_memory_resource()};
+  CHECK(arena.allocate(48, 8) == buffer.data());
+  CHECK(arena.allocate(32, 8) == nullptr);
+}
+
+TEST_CASE("with_arena - allocate from the environment", "[arena_resource]") {
+  auto sender = sio::with_arena(
+    stdexec::let_value(sio::async::get_allocator(), [](sio::resource_allocator<char> alloc) {
+      sio::resource_allocator<int> ints{alloc};
+      return stdexec::then(sio::async::async_new(ints, 42), [](int* ptr) { return *ptr; });
+    }));
+  auto [value] = stdexec::sync_wait(std::move(sender)).value();
+  CHECK(value == 42);
+}
@@ -13,8 +13,12 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include <sio/arena_resource.hpp>
 #include <sio/async_channel.hpp>
 #include <sio/sequence/first.hpp>
+#include <sio/with_env.hpp>
+#include "common/counting_resource.hpp"
+
 #include <catch2/catch_all.hpp>
 
 TEST_CASE("async_channel - just", "[async_channel]") {
@@ -34,4 +38,29 @@ TEST_CASE("async_channel - just", "[async_channel]") {
   stdexec::sync_wait(use);
 
   CHECK(is_read);
-}
\ No newline at end of file
+}
+
+TEST_CASE("async_channel - notify_all allocates from the env", "[async_channel]") {
+  using Sigs = stdexec::completion_signatures<stdexec::set_value_t()>;
+  counting_resource resource{};
+  auto env = exec::make_env(
+    exec::with(sio::async::get_allocator, sio::resource_allocator<char>{&resource}));
+  sio::async_channel<Sigs> channel{};
+  int n_reads = 0;
+  auto use = sio::async::use_resources([&](sio::async_channel_handle<Sigs> handle) {
+    auto read = [&] {
+      return handle.subscribe() //
+           | sio::first()       //
+           | stdexec::then([&]() noexcept { ++n_reads; });
+    };
+    auto write = sio::with_env(env, handle.notify_all(stdexec::just()));
+    return stdexec::when_all(read(), read(), write);
+  }, channel);
+
+  stdexec::sync_wait(use);
+
+  CHECK(n_reads == 2);
+  // One spawned operation per observer, each released when it completes.
+  CHECK(resource.allocations_ == 2);
+  CHECK(resource.live_ == 0);
+}
@@ -1,8 +1,19 @@
 #include "sio/memory_pool.hpp"
 #include "sio/with_env.hpp"
+#include "common/counting_resource.hpp"
 
 #include <catch2/catch_all.hpp>
 
+#include <exec/linux/io_uring_context.hpp>
+#include <exec/when_any.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <tuple>
+#include <vector>
+
 TEST_CASE("memory_pool - empty and allocate", "[memory_pool]") {
   sio::memory_pool pool{};
   auto alloc = pool.allocate(1, 1) | stdexec::let_value([&pool](void* ptr) noexcept {
@@ -64,3 +75,180 @@ TEST_CASE("memory_pool_allocator - new and delete", "[memory_pool]") {
 //   });
 //   stdexec::sync_wait(sio::with_env(env, alloc));
 // }
+
+TEST_CASE("memory_pool - concurrent allocate and deallocate", "[memory_pool]") {
+  counting_resource upstream{};
+  // Catch2 assertions are not thread-safe, so the workers only count their failures.
+  std::atomic<int> failures{0};
+  {
+    sio::memory_pool pool{&upstream};
+    std::vector<std::thread> threads{};
+    for (int t = 0; t < 4; ++t) {
+      threads.emplace_back([&pool, &failures] {
+        for (int i = 0; i < 1000; ++i) {
+          auto result = stdexec::sync_wait(pool.allocate(32, 8));
+          void* ptr = result ? std::get<0>(*result) : nullptr;
+          if (!ptr) {
+            failures.fetch_add(1, std::memory_order_relaxed);
+            continue;
+          }
+          stdexec::sync_wait(pool.deallocate(ptr));
+        }
+      });
+    }
+    for (std::thread& thread: threads) {
+      thread.join();
+    }
+  }
+  CHECK(failures.load() == 0);
+  CHECK(upstream.live_ == 0);
+}
+
+TEST_CASE("memory_pool - pending allocation is completed by a deallocation", "[memory_pool]") {
+  counting_resource upstream{1};
+  sio::memory_pool pool{&upstream};
+  auto [first] = stdexec::sync_wait(pool.allocate(32, 8)).value();
+  REQUIRE(first);
+  void* second = nullptr;
+  std::thread waiter{[&] {
+    auto [ptr] = stdexec::sync_wait(pool.allocate(32, 8)).value();
+    second = ptr;
+  }};
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  std::thread{[&] { stdexec::sync_wait(pool.deallocate(first)); }}.join();
+  waiter.join();
+  CHECK(second == first);
+  stdexec::sync_wait(pool.deallocate(second));
+}
+
+TEST_CASE("memory_pool - size classes", "[memory_pool]") {
+  CHECK(sio::memory_pool::capacity(0) == 16);
+  CHECK(sio::memory_pool::capacity(1) == 20);
+  CHECK(sio::memory_pool::capacity(4) == 32);
+  CHECK(sio::memory_pool::capacity(sio::memory_pool::n_size_classes - 1) == std::size_t{1} << 32);
+
+  sio::memory_pool pool{};
+  auto [ptr] = stdexec::sync_wait(pool.allocate(1024, 8)).value();
+  stdexec::sync_wait(pool.deallocate(ptr));
+  // 1000 bytes fall into the same class as 1024 bytes, 1100 bytes into the next one.
+  auto [same] = stdexec::sync_wait(pool.allocate(1000, 8)).value();
+  auto [next] = stdexec::sync_wait(pool.allocate(1100, 8)).value();
+  CHECK(same == ptr);
+  CHECK(next != ptr);
+  stdexec::sync_wait(pool.deallocate(same));
+  stdexec::sync_wait(pool.deallocate(next));
+}
+
+TEST_CASE("memory_pool - aligned allocations", "[memory_pool]") {
+  sio::memory_pool pool{};
+  for (std::size_t alignment: {std::size_t{32}, std::size_t{64}, std::size_t{4096}}) {
+    auto [ptr] = stdexec::sync_wait(pool.allocate(4096, alignment)).value();
+    REQUIRE(ptr);
+    CHECK(reinterpret_cast<std::uintptr_t>(ptr) % alignment == 0);
+    stdexec::sync_wait(pool.deallocate(ptr));
+    auto [again] = stdexec::sync_wait(pool.allocate(4096, alignment)).value();
+    CHECK(again == ptr);
+    stdexec::sync_wait(pool.deallocate(again));
+  }
+  CHECK_THROWS_AS(pool.allocate(16, 8192), std::invalid_argument);
+}
+
+TEST_CASE("memory_pool - statistics", "[memory_pool]") {
+  sio::memory_pool pool{};
+  auto [a] = stdexec::sync_wait(pool.allocate(100, 8)).value();
+  auto [b] = stdexec::sync_wait(pool.allocate(100, 8)).value();
+  sio::memory_pool_statistics stats = pool.statistics();
+  REQUIRE(stats.size_classes.size() == 1);
+  const sio::memory_pool_size_class_statistics& entry = stats.size_classes[0];
+  CHECK(entry.size == 112);
+  CHECK(entry.live_blocks == 2);
+  CHECK(entry.cached_blocks == 0);
+  CHECK(entry.upstream_allocations == 2);
+  CHECK(entry.high_water_mark == 2);
+  CHECK(stats.live_bytes == 224);
+
+  stdexec::sync_wait(pool.deallocate(a));
+  stats = pool.statistics();
+  CHECK(stats.size_classes[0].live_blocks == 1);
+  CHECK(stats.size_classes[0].cached_blocks == 1);
+  stdexec::sync_wait(pool.deallocate(b));
+}
+
+TEST_CASE("memory_pool - report statistics periodically", "[memory_pool]") {
+  sio::memory_pool pool{};
+  auto [ptr] = stdexec::sync_wait(pool.allocate(64, 8)).value();
+  exec::io_uring_context context{};
+  using namespace std::chrono_literals;
+  int reports = 0;
+  std::size_t live_bytes = 0;
+  stdexec::sync_wait(exec::when_any(
+    sio::report_statistics(
+      pool,
+      context.get_scheduler(),
+      1ms,
+      [&](sio::memory_pool_statistics stats) {
+        reports += 1;
+        live_bytes = stats.live_bytes;
+      }),
+    exec::schedule_after(context.get_scheduler(), 50ms),
+    context.run(exec::until::stopped)));
+  CHECK(reports > 0);
+  CHECK(live_bytes == 64);
+  stdexec::sync_wait(pool.deallocate(ptr));
+}
+
+TEST_CASE("memory_pool - trim returns cached blocks upstream", "[memory_pool]") {
+  counting_resource resource{};
+  sio::memory_pool pool{&resource};
+  std::vector<void*> blocks{};
+  for (int i = 0; i < 4; ++i) {
+    auto [ptr] = stdexec::sync_wait(pool.allocate(100, 8)).value();
+    blocks.push_back(ptr);
+  }
+  for (void* ptr: blocks) {
+    stdexec::sync_wait(pool.deallocate(ptr));
+  }
+  CHECK(resource.live_ == 4);
+  CHECK(pool.trim(1) > 0);
+  CHECK(resource.live_ == 1);
+  CHECK(pool.statistics().size_classes[0].cached_blocks == 1);
+
+  // The first call only records the number of upstream allocations.
+  auto [ptr] = stdexec::sync_wait(pool.allocate(100, 8)).value();
+  stdexec::sync_wait(pool.deallocate(ptr));
+  CHECK(pool.trim_if_idle(0) == 0);
+  CHECK(resource.live_ == 1);
+  CHECK(pool.trim_if_idle(0) > 0);
+  CHECK(resource.live_ == 0);
+}
+
+TEST_CASE("memory_pool - trim_if_idle trims each free list on its own", "[memory_pool]") {
+  counting_resource resource{};
+  sio::memory_pool pool{&resource};
+  auto [small] = stdexec::sync_wait(pool.allocate(100, 8)).value();
+  stdexec::sync_wait(pool.deallocate(small));
+  CHECK(pool.trim_if_idle(0) == 0);
+  CHECK(resource.live_ == 1);
+
+  // A larger size class allocates from upstream, which does not keep the small block cached.
+  auto [large] = stdexec::sync_wait(pool.allocate(4000, 8)).value();
+  CHECK(resource.live_ == 2);
+  CHECK(pool.trim_if_idle(0) > 0);
+  CHECK(resource.live_ == 1);
+  stdexec::sync_wait(pool.deallocate(large));
+}
+
+TEST_CASE("memory_pool - trim_if_idle keeps free lists in use", "[memory_pool]") {
+  counting_resource resource{};
+  sio::memory_pool pool{&resource};
+  auto [first] = stdexec::sync_wait(pool.allocate(100, 8)).value();
+  stdexec::sync_wait(pool.deallocate(first));
+  for (int period = 0; period < 3; ++period) {
+    // Every period reuses the cached block without allocating from upstream.
+    auto [ptr] = stdexec::sync_wait(pool.allocate(100, 8)).value();
+    stdexec::sync_wait(pool.deallocate(ptr));
+    CHECK(pool.trim_if_idle(0) == 0);
+  }
+  CHECK(resource.allocations_ == 1);
+  CHECK(resource.live_ == 1);
+}
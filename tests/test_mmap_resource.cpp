@@ -0,0 +1,60 @@
+#include "sio/mmap_resource.hpp"
+
+#include <catch2/catch_all.hpp>
+
+#include <stdexec/execution.hpp>
+
+#include <cstdint>
+#include <cstring>
+
+TEST_CASE("mmap_arena_resource - allocate from chunks", "[memory_pool][mmap_resource]") {
+  sio::mmap_arena_resource resource{sio::mmap_resource_options{.chunk_size = 1 << 16}};
+  CHECK(resource.mapped_bytes() == 0);
+  void* a = resource.allocate(100, 8);
+  void* b = resource.allocate(100, 64);
+  REQUIRE(a);
+  REQUIRE(b);
+  CHECK(reinterpret_cast<std::uintptr_t>(b) % 64 == 0);
+  CHECK(resource.mapped_bytes() == 1 << 16);
+  std::memset(a, 0xff, 100);
+  std::memset(b, 0xff, 100);
+  resource.deallocate(a, 100, 8);
+  resource.deallocate(b, 100, 64);
+  CHECK(resource.mapped_bytes() == 1 << 16);
+
+  void* large = resource.allocate(1 << 17, 4096);
+  REQUIRE(large);
+  CHECK(resource.mapped_bytes() == (1 << 16) + (1 << 17));
+  resource.deallocate(large, 1 << 17, 4096);
+  CHECK(resource.mapped_bytes() == 1 << 16);
+  CHECK(resource.allocate(16, 1 << 20) == nullptr);
+}
+
+TEST_CASE("mmap_arena_resource - upstream of a memory_pool", "[memory_pool][mmap_resource]") {
+  sio::mmap_arena_resource resource{sio::mmap_resource_options{
+    .pages = sio::huge_pages::transparent,
+    .populate = true}};
+  sio::memory_pool pool{&resource};
+  auto [ptr] = stdexec::sync_wait(pool.allocate(4096, 4096)).value();
+  REQUIRE(ptr);
+  CHECK(reinterpret_cast<std::uintptr_t>(ptr) % 4096 == 0);
+  std::memset(ptr, 0, 4096);
+  stdexec::sync_wait(pool.deallocate(ptr));
+  CHECK(resource.mapped_bytes() == std::size_t{2} << 20);
+}
+
+TEST_CASE("mmap_arena_resource - huge page chunks are aligned", "[memory_pool][mmap_resource]") {
+  constexpr std::size_t huge_page_size = std::size_t{2} << 20;
+  for (sio::huge_pages pages: {sio::huge_pages::transparent, sio::huge_pages::explicit_}) {
+    sio::mmap_arena_resource resource{sio::mmap_resource_options{.pages = pages}};
+    void* small = resource.allocate(64, 8);
+    REQUIRE(small);
+    CHECK(reinterpret_cast<std::uintptr_t>(small) % huge_page_size == 0);
+    void* large = resource.allocate(huge_page_size, 4096);
+    REQUIRE(large);
+    CHECK(reinterpret_cast<std::uintptr_t>(large) % huge_page_size == 0);
+    CHECK(resource.mapped_bytes() == 2 * huge_page_size);
+    resource.deallocate(large, huge_page_size, 4096);
+    resource.deallocate(small, 64, 8);
+  }
+}
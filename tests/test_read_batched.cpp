@@ -45,3 +45,29 @@ TEST_CASE("read_batched - Read from a file", "[read_batched]") {
   CHECK(values[1] == 4242);
   CHECK(values[2] == 424242);
 }
+
+TEST_CASE("read_batched - Read chunks of buffers from a file", "[read_batched]") {
+  exec::safe_file_descriptor fd{::memfd_create("test", 0)};
+  REQUIRE(::ftruncate(fd, 4096) == 0);
+  for (int i = 0; i < 5; ++i) {
+    const int value = 42 + i;
+    REQUIRE(::pwrite(fd, &value, sizeof(value), i * 512) == sizeof(value));
+  }
+  exec::io_uring_context context{};
+  sio::io_uring::native_fd_handle fdh{context, std::move(fd)};
+  sio::io_uring::seekable_byte_stream stream{std::move(fdh)};
+  using offset_type = sio::async::offset_type_of_t<decltype(stream)>;
+  offset_type offsets[5] = {0, 512, 1024, 1536, 2048};
+  int values[5] = {};
+  sio::mutable_buffer bytes[5] = {
+    sio::mutable_buffer(&values[0], sizeof(int)),
+    sio::mutable_buffer(&values[1], sizeof(int)),
+    sio::mutable_buffer(&values[2], sizeof(int)),
+    sio::mutable_buffer(&values[3], sizeof(int)),
+    sio::mutable_buffer(&values[4], sizeof(int))};
+  auto sndr = sio::async::read_batched(stream, bytes, offsets, 2);
+  stdexec::sync_wait(exec::when_any(std::move(sndr), context.run()));
+  for (int i = 0; i < 5; ++i) {
+    CHECK(values[i] == 42 + i);
+  }
+}